@@ -0,0 +1,104 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using Godot;
+
+/// <summary>
+///   Access to the world-level collision event stream of the latest physics update (see
+///   <see cref="PhysicalWorld.SetCollisionEventStreamCapacity"/>). The data is in native memory and is only valid until
+///   the next physics update starts. Must match the byte layout of CollisionEventStreamData in CStructures.h.
+/// </summary>
+/// <remarks>
+///   <para>
+///     The data is stored as a separate array for each field. Bodies are identified by their IDs, see
+///     <see cref="NativePhysicsBody.BodyId"/>.
+///   </para>
+/// </remarks>
+[StructLayout(LayoutKind.Sequential)]
+public readonly struct CollisionEventStreamData
+{
+    /// <summary>
+    ///   Set in the flags when the collision started on the latest physics update
+    /// </summary>
+    public const byte FLAG_JUST_STARTED = 1;
+
+    /// <summary>
+    ///   Set in the flags when the contact ended on the latest physics update. Ended records only have the bodies and
+    ///   the raw (unresolved) sub-shape data set.
+    /// </summary>
+    public const byte FLAG_ENDED = 2;
+
+    public readonly IntPtr FirstBodies;
+    public readonly IntPtr SecondBodies;
+    public readonly IntPtr FirstSubShapes;
+    public readonly IntPtr SecondSubShapes;
+    public readonly IntPtr Penetrations;
+    public readonly IntPtr Normals;
+    public readonly IntPtr RelativeNormalVelocities;
+    public readonly IntPtr Flags;
+
+    /// <summary>
+    ///   Number of collisions in the stream
+    /// </summary>
+    public readonly int Count;
+
+    /// <summary>
+    ///   Number of collisions that didn't fit in the stream. If this is not 0 the stream capacity should be increased.
+    /// </summary>
+    public readonly int DroppedCount;
+
+    public uint GetFirstBody(int index)
+    {
+        return (uint)Marshal.ReadInt32(FirstBodies, index * sizeof(uint));
+    }
+
+    public uint GetSecondBody(int index)
+    {
+        return (uint)Marshal.ReadInt32(SecondBodies, index * sizeof(uint));
+    }
+
+    public uint GetFirstSubShape(int index)
+    {
+        return (uint)Marshal.ReadInt32(FirstSubShapes, index * sizeof(uint));
+    }
+
+    public uint GetSecondSubShape(int index)
+    {
+        return (uint)Marshal.ReadInt32(SecondSubShapes, index * sizeof(uint));
+    }
+
+    public float GetPenetration(int index)
+    {
+        return BitConverter.Int32BitsToSingle(Marshal.ReadInt32(Penetrations, index * sizeof(float)));
+    }
+
+    /// <summary>
+    ///   Contact normal pointing from the first body towards the second body
+    /// </summary>
+    public Vector3 GetNormal(int index)
+    {
+        var offset = index * sizeof(float) * 3;
+
+        return new Vector3(BitConverter.Int32BitsToSingle(Marshal.ReadInt32(Normals, offset)),
+            BitConverter.Int32BitsToSingle(Marshal.ReadInt32(Normals, offset + sizeof(float))),
+            BitConverter.Int32BitsToSingle(Marshal.ReadInt32(Normals, offset + sizeof(float) * 2)));
+    }
+
+    /// <summary>
+    ///   How fast the bodies were approaching each other along the contact normal. On just started collisions this is
+    ///   the impact speed which tells how hard the collision was.
+    /// </summary>
+    public float GetRelativeNormalVelocity(int index)
+    {
+        return BitConverter.Int32BitsToSingle(Marshal.ReadInt32(RelativeNormalVelocities, index * sizeof(float)));
+    }
+
+    public bool IsJustStarted(int index)
+    {
+        return (Marshal.ReadByte(Flags, index) & FLAG_JUST_STARTED) != 0;
+    }
+
+    public bool IsEnded(int index)
+    {
+        return (Marshal.ReadByte(Flags, index) & FLAG_ENDED) != 0;
+    }
+}
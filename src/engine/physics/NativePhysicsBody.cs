@@ -71,6 +71,12 @@ public class NativePhysicsBody : IDisposable, IEquatable<NativePhysicsBody>
     public bool IsDisposed => disposed;
     public bool IsDetached => NativeMethods.PhysicsBodyIsDetached(AccessBodyInternal());
 
+    /// <summary>
+    ///   ID of this body in the native physics engine, used to identify bodies in
+    ///   <see cref="CollisionEventStreamData"/>
+    /// </summary>
+    public uint BodyId => NativeMethods.PhysicsBodyGetId(AccessBodyInternal());
+
     public static bool operator ==(NativePhysicsBody? left, NativePhysicsBody? right)
     {
         return Equals(left, right);
@@ -213,6 +219,9 @@ internal static partial class NativeMethods
     [return: MarshalAs(UnmanagedType.U1)]
     internal static extern bool PhysicsBodyIsDetached(IntPtr body);
 
+    [DllImport("thrive_native")]
+    internal static extern uint PhysicsBodyGetId(IntPtr body);
+
     [DllImport("thrive_native")]
     internal static extern void PhysicsBodySetUserData(IntPtr body, in Entity userData, int userDataSize);
 
@@ -11,6 +11,12 @@ using Godot;
 /// </summary>
 public class PhysicalWorld : IDisposable
 {
+    /// <summary>
+    ///   Returned by the native side snapshot saving when saving is not possible. Must match SNAPSHOT_ERROR in
+    ///   PhysicalWorld.hpp.
+    /// </summary>
+    private const int SNAPSHOT_ERROR = int.MinValue;
+
     private bool disposed;
     private bool stackAllocWarned;
     private IntPtr nativeInstance;
@@ -46,6 +52,12 @@ public class PhysicalWorld : IDisposable
     /// </summary>
     public delegate bool OnCollisionFilterCallback(ref PhysicsCollision collision);
 
+    /// <summary>
+    ///   Combined hash of the world state after each physics step since step state hashing was enabled, see
+    ///   <see cref="SetStepStateHashing"/>
+    /// </summary>
+    public ulong StepStateHashChain => NativeMethods.PhysicalWorldGetStepStateHashChain(AccessWorldInternal());
+
     public float LatestPhysicsDuration => NativeMethods.PhysicalWorldGetPhysicsLatestTime(AccessWorldInternal());
 
     /// <summary>
@@ -64,6 +76,16 @@ public class PhysicalWorld : IDisposable
         return new PhysicalWorld(NativeMethods.CreatePhysicalWorld());
     }
 
+    /// <summary>
+    ///   Creates a world with specific capacities. Small worlds should use this to not reserve memory for a full
+    ///   game world.
+    /// </summary>
+    public static PhysicalWorld Create(uint maxBodies, uint maxBodyPairs, uint maxContactConstraints)
+    {
+        return new PhysicalWorld(
+            NativeMethods.CreatePhysicalWorldWithCapacity(maxBodies, maxBodyPairs, maxContactConstraints));
+    }
+
     /// <summary>
     ///   Steps the physics simulation forward if enough time has passed
     /// </summary>
@@ -220,6 +242,94 @@ public class PhysicalWorld : IDisposable
             body.Dispose();
     }
 
+    /// <summary>
+    ///   Creates many bodies with a single call. This is a lot faster than creating the bodies one by one as the
+    ///   creation is multithreaded and the bodies are added to the world as a single batch.
+    /// </summary>
+    /// <param name="infos">The bodies to create, only the first count are used</param>
+    /// <param name="count">How many bodies to create</param>
+    /// <param name="bodies">
+    ///   Receives the created bodies at the same indexes as infos. Bodies that failed to be created are set to null.
+    /// </param>
+    /// <param name="addToWorld">When true the bodies are added to the world</param>
+    /// <returns>The number of successfully created bodies</returns>
+    public int CreateBodiesBulk(PhysicsBodyCreationInfo[] infos, int count, NativePhysicsBody?[] bodies,
+        bool addToWorld = true)
+    {
+        if (count <= 0)
+            return 0;
+
+        if (infos.Length < count || bodies.Length < count)
+            throw new ArgumentException("Bulk body create arrays are shorter than count");
+
+        var bodyPointers = ArrayPool<IntPtr>.Shared.Rent(count);
+
+        try
+        {
+            var created = NativeMethods.PhysicalWorldCreateBodiesBulk(AccessWorldInternal(), ref infos[0], count,
+                ref bodyPointers[0], addToWorld);
+
+            for (int i = 0; i < count; ++i)
+            {
+                bodies[i] = bodyPointers[i].ToInt64() != 0 ? new NativePhysicsBody(bodyPointers[i]) : null;
+            }
+
+            return created;
+        }
+        finally
+        {
+            ArrayPool<IntPtr>.Shared.Return(bodyPointers);
+        }
+    }
+
+    /// <summary>
+    ///   Adds multiple bodies back to the world at once, see <see cref="AddBody"/>
+    /// </summary>
+    public void AddBodiesBulk(NativePhysicsBody[] bodies, int count, bool activate = true)
+    {
+        if (count <= 0)
+            return;
+
+        var bodyPointers = GatherBodyPointers(bodies, count);
+
+        try
+        {
+            NativeMethods.PhysicalWorldAddBodiesBulk(AccessWorldInternal(), ref bodyPointers[0], count, activate);
+        }
+        finally
+        {
+            ArrayPool<IntPtr>.Shared.Return(bodyPointers);
+        }
+    }
+
+    /// <summary>
+    ///   Destroys multiple bodies at once, see <see cref="DestroyBody"/>
+    /// </summary>
+    public void DestroyBodiesBulk(NativePhysicsBody[] bodies, int count, bool dispose = true)
+    {
+        if (count <= 0)
+            return;
+
+        var bodyPointers = GatherBodyPointers(bodies, count);
+
+        try
+        {
+            NativeMethods.DestroyPhysicalWorldBodiesBulk(AccessWorldInternal(), ref bodyPointers[0], count);
+        }
+        finally
+        {
+            ArrayPool<IntPtr>.Shared.Return(bodyPointers);
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            bodies[i].NotifyCollisionRecordingStopped();
+
+            if (dispose)
+                bodies[i].Dispose();
+        }
+    }
+
     public void SetDamping(NativePhysicsBody body, float linearDamping, float? angularDamping = null)
     {
         if (angularDamping != null)
@@ -258,6 +368,82 @@ public class PhysicalWorld : IDisposable
         return (velocity, angularVelocity);
     }
 
+    /// <summary>
+    ///   Reads positions and rotations (and velocities if the arrays for them are given) of multiple bodies with a
+    ///   single native call. This is much faster than reading each body separately.
+    /// </summary>
+    /// <param name="bodies">The bodies to read, only the first count items are used</param>
+    /// <param name="count">How many bodies to read</param>
+    /// <param name="positions">Receives the body positions</param>
+    /// <param name="rotations">Receives the body rotations</param>
+    /// <param name="velocities">If not null receives the body velocities</param>
+    /// <param name="angularVelocities">Needs to be given if velocities is given</param>
+    /// <exception cref="ArgumentException">If some array is too short</exception>
+    public void ReadBodiesBulk(NativePhysicsBody[] bodies, int count, JVec3[] positions, JQuat[] rotations,
+        JVecF3[]? velocities = null, JVecF3[]? angularVelocities = null)
+    {
+        if (count <= 0)
+            return;
+
+        if (bodies.Length < count || positions.Length < count || rotations.Length < count)
+            throw new ArgumentException("Bulk read arrays are shorter than count");
+
+        if ((velocities != null || angularVelocities != null) &&
+            (velocities == null || angularVelocities == null || velocities.Length < count ||
+                angularVelocities.Length < count))
+        {
+            throw new ArgumentException("Both velocity arrays need to be given and long enough");
+        }
+
+        var bodyPointers = GatherBodyPointers(bodies, count);
+
+        try
+        {
+            if (velocities != null)
+            {
+                NativeMethods.PhysicalWorldReadBodiesBulk(AccessWorldInternal(), ref bodyPointers[0], count,
+                    ref positions[0], ref rotations[0], ref velocities[0], ref angularVelocities![0]);
+            }
+            else
+            {
+                NativeMethods.PhysicalWorldReadBodiesBulk(AccessWorldInternal(), ref bodyPointers[0], count,
+                    ref positions[0], ref rotations[0], IntPtr.Zero, IntPtr.Zero);
+            }
+        }
+        finally
+        {
+            ArrayPool<IntPtr>.Shared.Return(bodyPointers);
+        }
+    }
+
+    /// <summary>
+    ///   Enables keeping a copy of body positions and velocities from the end of each physics update. This copy can
+    ///   be read with <see cref="TryReadBodySnapshot"/> while the next physics update is running in the background.
+    ///   Must not be called while background physics is running.
+    /// </summary>
+    public void SetBodySnapshotsEnabled(bool enabled)
+    {
+        NativeMethods.PhysicalWorldSetBodySnapshotsEnabled(AccessWorldInternal(), enabled);
+    }
+
+    /// <summary>
+    ///   Reads the body state as it was after the latest completed physics update. This doesn't need to wait for
+    ///   background physics to complete.
+    /// </summary>
+    /// <returns>False if snapshots are not enabled or the body was not in the world at that point</returns>
+    public bool TryReadBodySnapshot(NativePhysicsBody body, out Vector3 position, out Quaternion rotation,
+        out Vector3 velocity, out Vector3 angularVelocity)
+    {
+        var result = NativeMethods.ReadPhysicsBodySnapshot(AccessWorldInternal(), body.AccessBodyInternal(),
+            out var nativePosition, out var nativeRotation, out var nativeVelocity, out var nativeAngularVelocity);
+
+        position = nativePosition;
+        rotation = nativeRotation;
+        velocity = nativeVelocity;
+        angularVelocity = nativeAngularVelocity;
+        return result;
+    }
+
     /// <summary>
     ///   Give an impulse to a physics body. Note that this implies activation if the impulse is non-zero.
     /// </summary>
@@ -408,6 +594,23 @@ public class PhysicalWorld : IDisposable
         return NativeMethods.FixBodyYCoordinateToZero(AccessWorldInternal(), body.AccessBodyInternal());
     }
 
+    /// <summary>
+    ///   Applies many body modifications with a single native call. Commands for the same body should be next to
+    ///   each other as then they can be applied with a single body lock.
+    /// </summary>
+    /// <param name="commands">The commands to apply, only the first count are used</param>
+    /// <param name="count">Number of commands to apply</param>
+    public void ApplyBodyCommands(PhysicsBodyCommand[] commands, int count)
+    {
+        if (count <= 0)
+            return;
+
+        if (commands.Length < count)
+            throw new ArgumentException("Command array is shorter than count");
+
+        NativeMethods.PhysicalWorldApplyBodyCommands(AccessWorldInternal(), ref commands[0], count);
+    }
+
     public void ChangeBodyShape(NativePhysicsBody body, PhysicsShape shape, bool activate = true)
     {
         NativeMethods.ChangeBodyShape(AccessWorldInternal(), body.AccessBodyInternal(),
@@ -440,6 +643,26 @@ public class PhysicalWorld : IDisposable
             collisionsEnabled);
     }
 
+    /// <summary>
+    ///   Sets native collision group filtering for a body. This is much faster than collision ignore lists or filter
+    ///   callbacks as the check never leaves the native code.
+    /// </summary>
+    /// <param name="body">The body to set the values for</param>
+    /// <param name="group">
+    ///   Bodies with the same non-zero group never collide with each other, for example members of the same colony
+    /// </param>
+    /// <param name="category">Category bits of this body</param>
+    /// <param name="mask">
+    ///   The categories this body can collide with. Two bodies only collide if both have the other's category in their
+    ///   mask.
+    /// </param>
+    public void BodySetCollisionGroup(NativePhysicsBody body, uint group, uint category = 1,
+        uint mask = uint.MaxValue)
+    {
+        NativeMethods.PhysicsBodySetCollisionGroup(AccessWorldInternal(), body.AccessBodyInternal(), group, category,
+            mask);
+    }
+
     public void BodyIgnoreCollisionsWithBody(NativePhysicsBody body, NativePhysicsBody otherBody)
     {
         NativeMethods.PhysicsBodyAddCollisionIgnore(AccessWorldInternal(), body.AccessBodyInternal(),
@@ -511,8 +734,18 @@ public class PhysicalWorld : IDisposable
             singleIgnoredBody.AccessBodyInternal());
     }
 
+    /// <summary>
+    ///   Starts recording the collisions of a body into the returned array
+    /// </summary>
+    /// <param name="body">The body to record</param>
+    /// <param name="maxRecordedCollisions">Max collisions that are recorded per update</param>
+    /// <param name="receiverOfAddressOfCollisionCount">Receives the address of the recorded collision count</param>
+    /// <param name="recordEndedCollisions">
+    ///   When true contacts ending are also recorded (with <see cref="PhysicsCollision.Ended"/> set)
+    /// </param>
+    /// <returns>The array collisions are recorded into</returns>
     public PhysicsCollision[] BodyStartCollisionRecording(NativePhysicsBody body, int maxRecordedCollisions,
-        out IntPtr receiverOfAddressOfCollisionCount)
+        out IntPtr receiverOfAddressOfCollisionCount, bool recordEndedCollisions = false)
     {
         if (maxRecordedCollisions < 1)
             throw new ArgumentException("Need to record at least one collision", nameof(maxRecordedCollisions));
@@ -520,7 +753,7 @@ public class PhysicalWorld : IDisposable
         var (collisionsArray, arrayAddress) = body.SetupCollisionRecording(maxRecordedCollisions);
 
         receiverOfAddressOfCollisionCount = NativeMethods.PhysicsBodyEnableCollisionRecording(AccessWorldInternal(),
-            body.AccessBodyInternal(), arrayAddress, maxRecordedCollisions);
+            body.AccessBodyInternal(), arrayAddress, maxRecordedCollisions, recordEndedCollisions);
 
         if (receiverOfAddressOfCollisionCount == IntPtr.Zero)
         {
@@ -537,6 +770,26 @@ public class PhysicalWorld : IDisposable
         body.NotifyCollisionRecordingStopped();
     }
 
+    /// <summary>
+    ///   Enables recording all contacts in this world into a single compact event stream, which is cheaper than
+    ///   recording collisions separately for a lot of bodies. Read with <see cref="GetCollisionEvents"/>.
+    /// </summary>
+    /// <param name="capacity">Max collisions to store per physics update, 0 disables the stream</param>
+    public void SetCollisionEventStreamCapacity(uint capacity)
+    {
+        NativeMethods.PhysicalWorldSetCollisionEventStreamCapacity(AccessWorldInternal(), capacity);
+    }
+
+    /// <summary>
+    ///   Gets the collision events of the latest physics update. Must not be called while physics is running in the
+    ///   background.
+    /// </summary>
+    /// <returns>False if the event stream is not enabled</returns>
+    public bool GetCollisionEvents(out CollisionEventStreamData events)
+    {
+        return NativeMethods.PhysicalWorldGetCollisionEvents(AccessWorldInternal(), out events);
+    }
+
     /// <summary>
     ///   Add a collision filter callback for a body
     /// </summary>
@@ -572,11 +825,26 @@ public class PhysicalWorld : IDisposable
     /// <param name="start">Start world point</param>
     /// <param name="directionAndLength">Vector to add to start to get to the end point</param>
     /// <param name="results">Will be filled with the hit objects. Needs to have a size greater than 0</param>
+    /// <param name="layers">Which kinds of bodies the ray can hit</param>
+    /// <param name="ignoredBodies">
+    ///   Optional bodies that can't be hit. These are skipped before testing their shapes so this is much faster than
+    ///   ignoring the hits afterwards.
+    /// </param>
     /// <returns>The number of hits in results, all other array indexes are left untouched</returns>
-    public int CastRayGetAllHits(Vector3 start, Vector3 directionAndLength, PhysicsRayWithUserData[] results)
+    public int CastRayGetAllHits(Vector3 start, Vector3 directionAndLength, PhysicsRayWithUserData[] results,
+        PhysicsLayerMask layers = PhysicsLayerMask.All, IReadOnlyList<NativePhysicsBody>? ignoredBodies = null)
     {
-        return NativeMethods.PhysicalWorldCastRayGetAll(AccessWorldInternal(), new JVec3(start),
-            new JVecF3(directionAndLength), ref results[0], results.Length);
+        var ignoredPointers = GatherIgnoredBodyPointers(ignoredBodies, out var ignoreCount);
+
+        try
+        {
+            return NativeMethods.PhysicalWorldCastRayGetAll(AccessWorldInternal(), new JVec3(start),
+                new JVecF3(directionAndLength), ref results[0], results.Length, layers, ignoredPointers, ignoreCount);
+        }
+        finally
+        {
+            ReturnIgnoredBodyPointers(ignoredPointers);
+        }
     }
 
     /// <summary>
@@ -591,6 +859,223 @@ public class PhysicalWorld : IDisposable
         return CastRayGetAllHits(start, directionAndLength, results);
     }
 
+    /// <summary>
+    ///   Casts many rays at once. The rays are processed in parallel on the native side so this is much faster than
+    ///   casting the rays one by one.
+    /// </summary>
+    /// <param name="rays">The rays to cast, only the first count are used</param>
+    /// <param name="count">Number of rays</param>
+    /// <param name="results">
+    ///   Receives the hits. Needs space for count * maxHitsPerRay hits, the hits of ray i start at
+    ///   i * maxHitsPerRay.
+    /// </param>
+    /// <param name="hitCounts">Receives the number of hits for each ray</param>
+    /// <param name="maxHitsPerRay">Max hits to record per ray</param>
+    /// <param name="layers">Which kinds of bodies the rays can hit</param>
+    /// <param name="ignoredBodies">Optional bodies that none of the rays can hit</param>
+    /// <returns>The total number of hits</returns>
+    public int CastRaysBatch(PhysicsRayCast[] rays, int count, PhysicsRayWithUserData[] results, int[] hitCounts,
+        int maxHitsPerRay, PhysicsLayerMask layers = PhysicsLayerMask.All,
+        IReadOnlyList<NativePhysicsBody>? ignoredBodies = null)
+    {
+        if (count <= 0)
+            return 0;
+
+        if (maxHitsPerRay < 1 || rays.Length < count || hitCounts.Length < count ||
+            results.Length < count * maxHitsPerRay)
+        {
+            throw new ArgumentException("Batch ray cast arrays are too short");
+        }
+
+        var ignoredPointers = GatherIgnoredBodyPointers(ignoredBodies, out var ignoreCount);
+
+        try
+        {
+            return NativeMethods.PhysicalWorldCastRaysBatch(AccessWorldInternal(), ref rays[0], count,
+                ref results[0], ref hitCounts[0], maxHitsPerRay, layers, ignoredPointers, ignoreCount);
+        }
+        finally
+        {
+            ReturnIgnoredBodyPointers(ignoredPointers);
+        }
+    }
+
+    /// <summary>
+    ///   Finds bodies whose bounding boxes overlap a sphere. This is a fast broadphase only check so bodies that are
+    ///   just near the sphere can also be found.
+    /// </summary>
+    /// <param name="center">Center of the sphere</param>
+    /// <param name="radius">Radius of the sphere</param>
+    /// <param name="results">
+    ///   Receives the found bodies. <see cref="PhysicsRayWithUserData.HitFraction"/> is the distance from center to
+    ///   the found body's position.
+    /// </param>
+    /// <param name="layers">Which kinds of bodies to find</param>
+    /// <returns>The number of found bodies in results</returns>
+    public int OverlapSphere(Vector3 center, float radius, PhysicsRayWithUserData[] results,
+        PhysicsLayerMask layers = PhysicsLayerMask.All)
+    {
+        if (results.Length < 1)
+            throw new ArgumentException("Query results array can't be empty", nameof(results));
+
+        return NativeMethods.PhysicalWorldOverlapSphere(AccessWorldInternal(), new JVec3(center), radius,
+            ref results[0], results.Length, layers);
+    }
+
+    /// <summary>
+    ///   Variant of <see cref="OverlapSphere"/> for an axis aligned box. Distances are from the center of the box.
+    /// </summary>
+    public int OverlapAABB(Vector3 min, Vector3 max, PhysicsRayWithUserData[] results,
+        PhysicsLayerMask layers = PhysicsLayerMask.All)
+    {
+        if (results.Length < 1)
+            throw new ArgumentException("Query results array can't be empty", nameof(results));
+
+        return NativeMethods.PhysicalWorldOverlapAABB(AccessWorldInternal(), new JVec3(min), new JVec3(max),
+            ref results[0], results.Length, layers);
+    }
+
+    /// <summary>
+    ///   Finds the closest bodies (by position) to a point within a max distance. Results are sorted by distance
+    ///   which is stored in <see cref="PhysicsRayWithUserData.HitFraction"/>.
+    /// </summary>
+    /// <param name="center">Point to find the bodies close to</param>
+    /// <param name="maxDistance">Max distance of the found body positions from the center</param>
+    /// <param name="results">Receives the found bodies, the length of this is how many bodies are found</param>
+    /// <param name="layers">Which kinds of bodies to find</param>
+    /// <returns>The number of found bodies</returns>
+    public int FindNearestK(Vector3 center, float maxDistance, PhysicsRayWithUserData[] results,
+        PhysicsLayerMask layers = PhysicsLayerMask.All)
+    {
+        if (results.Length < 1)
+            throw new ArgumentException("Query results array can't be empty", nameof(results));
+
+        return NativeMethods.PhysicalWorldFindNearestK(AccessWorldInternal(), new JVec3(center), maxDistance,
+            ref results[0], results.Length, layers);
+    }
+
+    /// <summary>
+    ///   Finds the bodies a shape placed at a position overlaps with. Unlike <see cref="OverlapSphere"/> this is an
+    ///   exact shape vs. shape test. Only the deepest hit for each body is reported.
+    /// </summary>
+    /// <param name="shape">Shape to test with</param>
+    /// <param name="position">Where the shape is placed</param>
+    /// <param name="rotation">Rotation of the shape</param>
+    /// <param name="results">Receives the hits, the length of this is the max number of hits</param>
+    /// <param name="layers">Which kinds of bodies to hit</param>
+    /// <param name="ignoredBodies">
+    ///   Optional bodies that can't be hit. These are skipped before testing their shapes so this is much faster than
+    ///   ignoring the hits afterwards.
+    /// </param>
+    /// <returns>The number of hits in results</returns>
+    public int CollideShape(PhysicsShape shape, Vector3 position, Quaternion rotation,
+        PhysicsShapeHitWithUserData[] results, PhysicsLayerMask layers = PhysicsLayerMask.All,
+        IReadOnlyList<NativePhysicsBody>? ignoredBodies = null)
+    {
+        if (results.Length < 1)
+            throw new ArgumentException("Query results array can't be empty", nameof(results));
+
+        var ignoredPointers = GatherIgnoredBodyPointers(ignoredBodies, out var ignoreCount);
+
+        try
+        {
+            return NativeMethods.PhysicalWorldCollideShape(AccessWorldInternal(), shape.AccessShapeInternal(),
+                new JVec3(position), new JQuat(rotation), ref results[0], results.Length, layers, ignoredPointers,
+                ignoreCount);
+        }
+        finally
+        {
+            ReturnIgnoredBodyPointers(ignoredPointers);
+        }
+    }
+
+    /// <summary>
+    ///   Sweeps a shape from position to position + directionAndLength and finds the bodies it hits. Only the
+    ///   earliest hit for each body is reported.
+    /// </summary>
+    /// <returns>The number of hits in results</returns>
+    public int CastShape(PhysicsShape shape, Vector3 position, Quaternion rotation, Vector3 directionAndLength,
+        PhysicsShapeHitWithUserData[] results, PhysicsLayerMask layers = PhysicsLayerMask.All,
+        IReadOnlyList<NativePhysicsBody>? ignoredBodies = null)
+    {
+        if (results.Length < 1)
+            throw new ArgumentException("Query results array can't be empty", nameof(results));
+
+        var ignoredPointers = GatherIgnoredBodyPointers(ignoredBodies, out var ignoreCount);
+
+        try
+        {
+            return NativeMethods.PhysicalWorldCastShape(AccessWorldInternal(), shape.AccessShapeInternal(),
+                new JVec3(position), new JQuat(rotation), new JVecF3(directionAndLength), ref results[0],
+                results.Length, layers, ignoredPointers, ignoreCount);
+        }
+        finally
+        {
+            ReturnIgnoredBodyPointers(ignoredPointers);
+        }
+    }
+
+    /// <summary>
+    ///   Runs many <see cref="CollideShape"/> queries at once spread over multiple threads
+    /// </summary>
+    /// <param name="queries">The queries to run, the direction of the queries is not used</param>
+    /// <param name="count">How many queries from the start of queries to run</param>
+    /// <param name="results">
+    ///   Receives the hits. Needs to have space for count * maxHitsPerQuery hits. Hits of query i start at index
+    ///   i * maxHitsPerQuery.
+    /// </param>
+    /// <param name="hitCounts">Receives the number of hits of each query</param>
+    /// <param name="maxHitsPerQuery">Max hits to record for a single query</param>
+    /// <param name="layers">Which kinds of bodies the queries can hit</param>
+    /// <param name="ignoredBodies">Optional bodies that none of the queries can hit</param>
+    /// <returns>Total number of hits</returns>
+    public int CollideShapesBatch(PhysicsShapeQuery[] queries, int count, PhysicsShapeHitWithUserData[] results,
+        int[] hitCounts, int maxHitsPerQuery, PhysicsLayerMask layers = PhysicsLayerMask.All,
+        IReadOnlyList<NativePhysicsBody>? ignoredBodies = null)
+    {
+        if (count <= 0)
+            return 0;
+
+        CheckShapeQueryBatchArrays(queries, count, results, hitCounts, maxHitsPerQuery);
+
+        var ignoredPointers = GatherIgnoredBodyPointers(ignoredBodies, out var ignoreCount);
+
+        try
+        {
+            return NativeMethods.PhysicalWorldCollideShapesBatch(AccessWorldInternal(), ref queries[0], count,
+                ref results[0], ref hitCounts[0], maxHitsPerQuery, layers, ignoredPointers, ignoreCount);
+        }
+        finally
+        {
+            ReturnIgnoredBodyPointers(ignoredPointers);
+        }
+    }
+
+    /// <summary>
+    ///   Batch variant of <see cref="CastShape"/>, works like <see cref="CollideShapesBatch"/>
+    /// </summary>
+    public int CastShapesBatch(PhysicsShapeQuery[] queries, int count, PhysicsShapeHitWithUserData[] results,
+        int[] hitCounts, int maxHitsPerQuery, PhysicsLayerMask layers = PhysicsLayerMask.All,
+        IReadOnlyList<NativePhysicsBody>? ignoredBodies = null)
+    {
+        if (count <= 0)
+            return 0;
+
+        CheckShapeQueryBatchArrays(queries, count, results, hitCounts, maxHitsPerQuery);
+
+        var ignoredPointers = GatherIgnoredBodyPointers(ignoredBodies, out var ignoreCount);
+
+        try
+        {
+            return NativeMethods.PhysicalWorldCastShapesBatch(AccessWorldInternal(), ref queries[0], count,
+                ref results[0], ref hitCounts[0], maxHitsPerQuery, layers, ignoredPointers, ignoreCount);
+        }
+        finally
+        {
+            ReturnIgnoredBodyPointers(ignoredPointers);
+        }
+    }
+
     /// <summary>
     ///   Return a buffer from raycasting
     /// </summary>
@@ -604,6 +1089,137 @@ public class PhysicalWorld : IDisposable
         return NativeMethods.PhysicalWorldDumpPhysicsState(AccessWorldInternal(), path);
     }
 
+    /// <summary>
+    ///   Limits how many physics steps are ran per process call to keep lag spikes from getting worse. By default
+    ///   the limit is 6 steps.
+    /// </summary>
+    /// <param name="maxSteps">Max steps per call, 0 for unlimited</param>
+    /// <param name="maxCatchUpMultiplier">
+    ///   How many pending steps can be merged into one longer step when over the step limit. 1 disables this and any
+    ///   pending time over the limit is discarded.
+    /// </param>
+    public void SetMaxStepsPerUpdate(int maxSteps, int maxCatchUpMultiplier = 1)
+    {
+        NativeMethods.PhysicalWorldSetMaxStepsPerUpdate(AccessWorldInternal(), maxSteps, maxCatchUpMultiplier);
+    }
+
+    /// <summary>
+    ///   Saves a snapshot of the physics simulation state so that it can be restored later with
+    ///   <see cref="RestoreSimulationSnapshot"/>
+    /// </summary>
+    /// <remarks>
+    ///   <para>
+    ///     This is only for rolling back or replaying the simulation of the existing bodies, this is not a way to
+    ///     save and load a world. Which bodies and constraints exist or their shapes is not saved, and restoring
+    ///     requires the world to have exactly the same bodies as when saving.
+    ///   </para>
+    /// </remarks>
+    /// <param name="buffer">Buffer to save to, replaced with a bigger one if the snapshot doesn't fit</param>
+    /// <param name="delta">
+    ///   If true only changes since the previously saved or restored snapshot are stored. Restoring such a snapshot
+    ///   requires the world to have the same previous snapshot as a base.
+    /// </param>
+    /// <returns>The number of bytes of buffer that were written</returns>
+    /// <exception cref="InvalidOperationException">If the snapshot can't be saved (physics is running)</exception>
+    public int SaveSimulationSnapshot(ref byte[] buffer, bool delta = false)
+    {
+        var result =
+            NativeMethods.PhysicalWorldSaveSimulationSnapshot(AccessWorldInternal(), buffer, buffer.Length, delta);
+
+        if (result >= 0)
+            return result;
+
+        if (result == SNAPSHOT_ERROR)
+        {
+            throw new InvalidOperationException(
+                "Physics snapshot can't be saved while background simulation is running");
+        }
+
+        // Nothing was written when the buffer is too small so the snapshot needs to be saved again
+        buffer = new byte[-result];
+
+        result = NativeMethods.PhysicalWorldSaveSimulationSnapshot(AccessWorldInternal(), buffer, buffer.Length,
+            delta);
+
+        if (result == SNAPSHOT_ERROR)
+        {
+            throw new InvalidOperationException(
+                "Physics snapshot can't be saved while background simulation is running");
+        }
+
+        if (result < 0)
+            throw new InvalidOperationException("Physics snapshot size changed between save attempts");
+
+        return result;
+    }
+
+    /// <summary>
+    ///   Restores a snapshot saved with <see cref="SaveSimulationSnapshot"/>. The world must contain exactly the
+    ///   same bodies as when saving.
+    /// </summary>
+    /// <returns>True on success, false if the data is invalid or the world doesn't have the same bodies</returns>
+    public bool RestoreSimulationSnapshot(byte[] data, int length)
+    {
+        if (length > data.Length)
+            throw new ArgumentException("Length is longer than the data");
+
+        return NativeMethods.PhysicalWorldRestoreSimulationSnapshot(AccessWorldInternal(), data, length);
+    }
+
+    /// <summary>
+    ///   Enables deterministic simulation where the same operations with the same process deltas give exactly the
+    ///   same results regardless of thread count. Jolt itself is always deterministic, this makes the multithreaded
+    ///   parts of the world wrapper run in a fixed order.
+    /// </summary>
+    public void SetDeterministicMode(bool enabled)
+    {
+        NativeMethods.PhysicalWorldSetDeterministicMode(AccessWorldInternal(), enabled);
+    }
+
+    /// <summary>
+    ///   Enables hashing the world state after every physics step into <see cref="StepStateHashChain"/>. This is
+    ///   costly with many bodies so this is meant for checking determinism. Also resets the chain.
+    /// </summary>
+    public void SetStepStateHashing(bool enabled)
+    {
+        NativeMethods.PhysicalWorldSetStepStateHashing(AccessWorldInternal(), enabled);
+    }
+
+    /// <summary>
+    ///   Calculates a hash of all body transforms and velocities. May not be called while physics is running.
+    /// </summary>
+    public ulong ComputeStateHash()
+    {
+        return NativeMethods.PhysicalWorldComputeStateHash(AccessWorldInternal());
+    }
+
+    /// <summary>
+    ///   Rebuilds the native physics system with new capacities. Bodies and constraints are kept. May not be called
+    ///   while physics is running.
+    /// </summary>
+    /// <remarks>
+    ///   <para>
+    ///     Contact caches are lost so touching contacts are reported as just started again on the next update and
+    ///     there may be a small jitter. Forces added since the last update and body sleep timers are also lost.
+    ///   </para>
+    /// </remarks>
+    /// <returns>False if the capacity couldn't be changed (body capacity is too small for existing bodies)</returns>
+    public bool ResizeCapacity(uint maxBodies, uint maxBodyPairs, uint maxContactConstraints)
+    {
+        return NativeMethods.PhysicalWorldResizeCapacity(AccessWorldInternal(), maxBodies, maxBodyPairs,
+            maxContactConstraints);
+    }
+
+    /// <summary>
+    ///   When enabled the world capacities are automatically grown when they are about to run out. Growing happens
+    ///   at the start of the next physics update (see <see cref="ResizeCapacity"/> for what state is lost), so
+    ///   creating a lot of bodies at once between updates can still run out.
+    /// </summary>
+    public void SetAutoCapacityGrowth(bool enabled)
+    {
+        NativeMethods.PhysicalWorldSetAutoCapacityGrowth(AccessWorldInternal(), enabled);
+    }
+
     public void Dispose()
     {
         Dispose(true);
@@ -647,6 +1263,63 @@ public class PhysicalWorld : IDisposable
         }
     }
 
+    /// <summary>
+    ///   Gets the native pointers of an optional query ignore list. The result must be given to
+    ///   <see cref="ReturnIgnoredBodyPointers"/> after use.
+    /// </summary>
+    private static IntPtr[]? GatherIgnoredBodyPointers(IReadOnlyList<NativePhysicsBody>? ignoredBodies,
+        out int count)
+    {
+        count = ignoredBodies?.Count ?? 0;
+
+        if (count < 1)
+            return null;
+
+        var bodyPointers = ArrayPool<IntPtr>.Shared.Rent(count);
+
+        for (int i = 0; i < count; ++i)
+        {
+            bodyPointers[i] = ignoredBodies![i].AccessBodyInternal();
+        }
+
+        return bodyPointers;
+    }
+
+    private static void ReturnIgnoredBodyPointers(IntPtr[]? bodyPointers)
+    {
+        if (bodyPointers != null)
+            ArrayPool<IntPtr>.Shared.Return(bodyPointers);
+    }
+
+    private static void CheckShapeQueryBatchArrays(PhysicsShapeQuery[] queries, int count,
+        PhysicsShapeHitWithUserData[] results, int[] hitCounts, int maxHitsPerQuery)
+    {
+        if (maxHitsPerQuery < 1 || queries.Length < count || hitCounts.Length < count ||
+            results.Length < count * maxHitsPerQuery)
+        {
+            throw new ArgumentException("Batch shape query arrays are too short");
+        }
+    }
+
+    /// <summary>
+    ///   Gets the native pointers of bodies for bulk operations. The returned array must be returned to the shared
+    ///   array pool.
+    /// </summary>
+    private static IntPtr[] GatherBodyPointers(NativePhysicsBody[] bodies, int count)
+    {
+        if (bodies.Length < count)
+            throw new ArgumentException("Body array is shorter than count");
+
+        var bodyPointers = ArrayPool<IntPtr>.Shared.Rent(count);
+
+        for (int i = 0; i < count; ++i)
+        {
+            bodyPointers[i] = bodies[i].AccessBodyInternal();
+        }
+
+        return bodyPointers;
+    }
+
     private void UpdateDebugCameraInfo(Vector3 position)
     {
         if (nativeInstance.ToInt64() != 0)
@@ -664,6 +1337,10 @@ internal static partial class NativeMethods
     [DllImport("thrive_native")]
     internal static extern IntPtr CreatePhysicalWorld();
 
+    [DllImport("thrive_native")]
+    internal static extern IntPtr CreatePhysicalWorldWithCapacity(uint maxBodies, uint maxBodyPairs,
+        uint maxContactConstraints);
+
     [DllImport("thrive_native")]
     internal static extern void DestroyPhysicalWorld(IntPtr physicalWorld);
 
@@ -704,6 +1381,17 @@ internal static partial class NativeMethods
     [DllImport("thrive_native")]
     internal static extern void DestroyPhysicalWorldBody(IntPtr physicalWorld, IntPtr body);
 
+    [DllImport("thrive_native")]
+    internal static extern int PhysicalWorldCreateBodiesBulk(IntPtr physicalWorld, ref PhysicsBodyCreationInfo infos,
+        int count, ref IntPtr bodiesReceiver, bool addToWorld);
+
+    [DllImport("thrive_native")]
+    internal static extern void PhysicalWorldAddBodiesBulk(IntPtr physicalWorld, ref IntPtr bodies, int count,
+        bool activate);
+
+    [DllImport("thrive_native")]
+    internal static extern void DestroyPhysicalWorldBodiesBulk(IntPtr physicalWorld, ref IntPtr bodies, int count);
+
     [DllImport("thrive_native")]
     internal static extern void SetPhysicsBodyLinearDamping(IntPtr physicalWorld, IntPtr body, float damping);
 
@@ -719,6 +1407,22 @@ internal static partial class NativeMethods
     internal static extern void ReadPhysicsBodyVelocity(IntPtr world, IntPtr body, [Out] out JVecF3 velocity,
         [Out] out JVecF3 angularVelocity);
 
+    [DllImport("thrive_native")]
+    internal static extern void PhysicalWorldReadBodiesBulk(IntPtr world, ref IntPtr bodies, int count,
+        ref JVec3 positions, ref JQuat rotations, ref JVecF3 velocities, ref JVecF3 angularVelocities);
+
+    [DllImport("thrive_native")]
+    internal static extern void PhysicalWorldReadBodiesBulk(IntPtr world, ref IntPtr bodies, int count,
+        ref JVec3 positions, ref JQuat rotations, IntPtr velocities, IntPtr angularVelocities);
+
+    [DllImport("thrive_native")]
+    internal static extern void PhysicalWorldSetBodySnapshotsEnabled(IntPtr physicalWorld, bool enabled);
+
+    [DllImport("thrive_native")]
+    [return: MarshalAs(UnmanagedType.U1)]
+    internal static extern bool ReadPhysicsBodySnapshot(IntPtr world, IntPtr body, [Out] out JVec3 position,
+        [Out] out JQuat orientation, [Out] out JVecF3 velocity, [Out] out JVecF3 angularVelocity);
+
     [DllImport("thrive_native")]
     internal static extern void GiveImpulse(IntPtr world, IntPtr body, JVecF3 impulse);
 
@@ -756,6 +1460,10 @@ internal static partial class NativeMethods
     [return: MarshalAs(UnmanagedType.U1)]
     internal static extern bool FixBodyYCoordinateToZero(IntPtr world, IntPtr body);
 
+    [DllImport("thrive_native")]
+    internal static extern void PhysicalWorldApplyBodyCommands(IntPtr physicalWorld,
+        ref PhysicsBodyCommand commands, int count);
+
     [DllImport("thrive_native")]
     internal static extern void ChangeBodyShape(IntPtr world, IntPtr body, IntPtr shape, bool activate);
 
@@ -767,6 +1475,10 @@ internal static partial class NativeMethods
     internal static extern void PhysicsBodySetCollisionEnabledState(IntPtr physicalWorld,
         IntPtr body, bool collisionsEnabled);
 
+    [DllImport("thrive_native")]
+    internal static extern void PhysicsBodySetCollisionGroup(IntPtr physicalWorld, IntPtr body, uint group,
+        uint category, uint mask);
+
     [DllImport("thrive_native")]
     internal static extern void PhysicsBodyAddCollisionIgnore(IntPtr physicalWorld, IntPtr body,
         IntPtr addIgnore);
@@ -788,11 +1500,19 @@ internal static partial class NativeMethods
 
     [DllImport("thrive_native")]
     internal static extern IntPtr PhysicsBodyEnableCollisionRecording(IntPtr physicalWorld, IntPtr body,
-        IntPtr collisionRecordingTarget, int maxRecordedCollisions);
+        IntPtr collisionRecordingTarget, int maxRecordedCollisions, bool recordEndedCollisions);
 
     [DllImport("thrive_native")]
     internal static extern void PhysicsBodyDisableCollisionRecording(IntPtr physicalWorld, IntPtr body);
 
+    [DllImport("thrive_native")]
+    internal static extern void PhysicalWorldSetCollisionEventStreamCapacity(IntPtr physicalWorld, uint capacity);
+
+    [DllImport("thrive_native")]
+    [return: MarshalAs(UnmanagedType.U1)]
+    internal static extern bool PhysicalWorldGetCollisionEvents(IntPtr physicalWorld,
+        out CollisionEventStreamData receiver);
+
     [DllImport("thrive_native")]
     internal static extern void PhysicsBodyAddCollisionFilter(IntPtr physicalWorld, IntPtr body,
         PhysicalWorld.OnCollisionFilterCallback callback);
@@ -808,7 +1528,45 @@ internal static partial class NativeMethods
 
     [DllImport("thrive_native")]
     internal static extern int PhysicalWorldCastRayGetAll(IntPtr physicalWorld, JVec3 start,
-        JVecF3 endOffset, ref PhysicsRayWithUserData dataReceiver, int maxHits);
+        JVecF3 endOffset, ref PhysicsRayWithUserData dataReceiver, int maxHits, PhysicsLayerMask layerMask,
+        IntPtr[]? ignoredBodies, int ignoreCount);
+
+    [DllImport("thrive_native")]
+    internal static extern int PhysicalWorldCastRaysBatch(IntPtr physicalWorld, ref PhysicsRayCast rays, int count,
+        ref PhysicsRayWithUserData results, ref int hitCountsReceiver, int maxHitsPerRay, PhysicsLayerMask layerMask,
+        IntPtr[]? ignoredBodies, int ignoreCount);
+
+    [DllImport("thrive_native")]
+    internal static extern int PhysicalWorldOverlapSphere(IntPtr physicalWorld, JVec3 center, float radius,
+        ref PhysicsRayWithUserData dataReceiver, int maxResults, PhysicsLayerMask layerMask);
+
+    [DllImport("thrive_native")]
+    internal static extern int PhysicalWorldOverlapAABB(IntPtr physicalWorld, JVec3 min, JVec3 max,
+        ref PhysicsRayWithUserData dataReceiver, int maxResults, PhysicsLayerMask layerMask);
+
+    [DllImport("thrive_native")]
+    internal static extern int PhysicalWorldFindNearestK(IntPtr physicalWorld, JVec3 center, float maxDistance,
+        ref PhysicsRayWithUserData dataReceiver, int count, PhysicsLayerMask layerMask);
+
+    [DllImport("thrive_native")]
+    internal static extern int PhysicalWorldCollideShape(IntPtr physicalWorld, IntPtr shape, JVec3 position,
+        JQuat rotation, ref PhysicsShapeHitWithUserData dataReceiver, int maxHits, PhysicsLayerMask layerMask,
+        IntPtr[]? ignoredBodies, int ignoreCount);
+
+    [DllImport("thrive_native")]
+    internal static extern int PhysicalWorldCastShape(IntPtr physicalWorld, IntPtr shape, JVec3 position,
+        JQuat rotation, JVecF3 direction, ref PhysicsShapeHitWithUserData dataReceiver, int maxHits,
+        PhysicsLayerMask layerMask, IntPtr[]? ignoredBodies, int ignoreCount);
+
+    [DllImport("thrive_native")]
+    internal static extern int PhysicalWorldCollideShapesBatch(IntPtr physicalWorld, ref PhysicsShapeQuery queries,
+        int count, ref PhysicsShapeHitWithUserData results, ref int hitCountsReceiver, int maxHitsPerQuery,
+        PhysicsLayerMask layerMask, IntPtr[]? ignoredBodies, int ignoreCount);
+
+    [DllImport("thrive_native")]
+    internal static extern int PhysicalWorldCastShapesBatch(IntPtr physicalWorld, ref PhysicsShapeQuery queries,
+        int count, ref PhysicsShapeHitWithUserData results, ref int hitCountsReceiver, int maxHitsPerQuery,
+        PhysicsLayerMask layerMask, IntPtr[]? ignoredBodies, int ignoreCount);
 
     [DllImport("thrive_native")]
     internal static extern float PhysicalWorldGetPhysicsLatestTime(IntPtr physicalWorld);
@@ -820,6 +1578,38 @@ internal static partial class NativeMethods
     [return: MarshalAs(UnmanagedType.U1)]
     internal static extern bool PhysicalWorldDumpPhysicsState(IntPtr physicalWorld, string path);
 
+    [DllImport("thrive_native")]
+    internal static extern void PhysicalWorldSetMaxStepsPerUpdate(IntPtr physicalWorld, int maxSteps,
+        int maxCatchUpMultiplier);
+
+    [DllImport("thrive_native")]
+    internal static extern int PhysicalWorldSaveSimulationSnapshot(IntPtr physicalWorld, byte[] buffer,
+        int bufferLength, bool delta);
+
+    [DllImport("thrive_native")]
+    [return: MarshalAs(UnmanagedType.U1)]
+    internal static extern bool PhysicalWorldRestoreSimulationSnapshot(IntPtr physicalWorld, byte[] data, int length);
+
+    [DllImport("thrive_native")]
+    internal static extern void PhysicalWorldSetDeterministicMode(IntPtr physicalWorld, bool enabled);
+
+    [DllImport("thrive_native")]
+    internal static extern void PhysicalWorldSetStepStateHashing(IntPtr physicalWorld, bool enabled);
+
+    [DllImport("thrive_native")]
+    internal static extern ulong PhysicalWorldComputeStateHash(IntPtr physicalWorld);
+
+    [DllImport("thrive_native")]
+    internal static extern ulong PhysicalWorldGetStepStateHashChain(IntPtr physicalWorld);
+
+    [DllImport("thrive_native")]
+    [return: MarshalAs(UnmanagedType.U1)]
+    internal static extern bool PhysicalWorldResizeCapacity(IntPtr physicalWorld, uint maxBodies, uint maxBodyPairs,
+        uint maxContactConstraints);
+
+    [DllImport("thrive_native")]
+    internal static extern void PhysicalWorldSetAutoCapacityGrowth(IntPtr physicalWorld, bool enabled);
+
     [DllImport("thrive_native")]
     internal static extern void PhysicalWorldSetDebugDrawLevel(IntPtr physicalWorld, int level);
 
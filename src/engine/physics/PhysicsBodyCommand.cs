@@ -0,0 +1,135 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using Godot;
+
+/// <summary>
+///   Type of <see cref="PhysicsBodyCommand"/>. Must match PHYSICS_BODY_COMMAND_TYPE in CStructures.h (except the
+///   naming convention)
+/// </summary>
+public enum PhysicsBodyCommandType
+{
+    GiveImpulse = 0,
+    GiveAngularImpulse = 1,
+    SetVelocity = 2,
+    SetAngularVelocity = 3,
+    SetVelocityAndAngularVelocity = 4,
+    SetPosition = 5,
+    SetPositionAndRotation = 6,
+    SetDamping = 7,
+    SetDampingAndAngularDamping = 8,
+}
+
+/// <summary>
+///   A single body modification to apply in bulk with <see cref="PhysicalWorld.ApplyBodyCommands"/>. Must match the
+///   byte layout of PhysicsBodyCommand in CStructures.h.
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct PhysicsBodyCommand
+{
+    /// <summary>
+    ///   Raw native body pointer, not wrapped in a <see cref="NativePhysicsBody"/> for performance reasons
+    /// </summary>
+    public IntPtr Body;
+
+    public JVec3 Position;
+    public JQuat Rotation;
+    public JVecF3 Vector;
+    public JVecF3 AngularVector;
+    public float Damping;
+    public float AngularDamping;
+    public PhysicsBodyCommandType Type;
+
+    /// <summary>
+    ///   Non-zero to activate the body when changing its position
+    /// </summary>
+    public int Activate;
+
+    public static PhysicsBodyCommand GiveImpulse(NativePhysicsBody body, Vector3 impulse)
+    {
+        return new PhysicsBodyCommand
+        {
+            Body = body.AccessBodyInternal(),
+            Type = PhysicsBodyCommandType.GiveImpulse,
+            Vector = new JVecF3(impulse),
+        };
+    }
+
+    public static PhysicsBodyCommand GiveAngularImpulse(NativePhysicsBody body, Vector3 angularImpulse)
+    {
+        return new PhysicsBodyCommand
+        {
+            Body = body.AccessBodyInternal(),
+            Type = PhysicsBodyCommandType.GiveAngularImpulse,
+            AngularVector = new JVecF3(angularImpulse),
+        };
+    }
+
+    public static PhysicsBodyCommand SetVelocity(NativePhysicsBody body, Vector3 velocity)
+    {
+        return new PhysicsBodyCommand
+        {
+            Body = body.AccessBodyInternal(),
+            Type = PhysicsBodyCommandType.SetVelocity,
+            Vector = new JVecF3(velocity),
+        };
+    }
+
+    public static PhysicsBodyCommand SetAngularVelocity(NativePhysicsBody body, Vector3 angularVelocity)
+    {
+        return new PhysicsBodyCommand
+        {
+            Body = body.AccessBodyInternal(),
+            Type = PhysicsBodyCommandType.SetAngularVelocity,
+            AngularVector = new JVecF3(angularVelocity),
+        };
+    }
+
+    public static PhysicsBodyCommand SetVelocityAndAngularVelocity(NativePhysicsBody body, Vector3 velocity,
+        Vector3 angularVelocity)
+    {
+        return new PhysicsBodyCommand
+        {
+            Body = body.AccessBodyInternal(),
+            Type = PhysicsBodyCommandType.SetVelocityAndAngularVelocity,
+            Vector = new JVecF3(velocity),
+            AngularVector = new JVecF3(angularVelocity),
+        };
+    }
+
+    public static PhysicsBodyCommand SetPosition(NativePhysicsBody body, Vector3 position, bool activate = true)
+    {
+        return new PhysicsBodyCommand
+        {
+            Body = body.AccessBodyInternal(),
+            Type = PhysicsBodyCommandType.SetPosition,
+            Position = new JVec3(position),
+            Activate = activate ? 1 : 0,
+        };
+    }
+
+    public static PhysicsBodyCommand SetPositionAndRotation(NativePhysicsBody body, Vector3 position,
+        Quaternion rotation, bool activate = true)
+    {
+        return new PhysicsBodyCommand
+        {
+            Body = body.AccessBodyInternal(),
+            Type = PhysicsBodyCommandType.SetPositionAndRotation,
+            Position = new JVec3(position),
+            Rotation = new JQuat(rotation),
+            Activate = activate ? 1 : 0,
+        };
+    }
+
+    public static PhysicsBodyCommand SetDamping(NativePhysicsBody body, float damping, float? angularDamping = null)
+    {
+        return new PhysicsBodyCommand
+        {
+            Body = body.AccessBodyInternal(),
+            Type = angularDamping != null ?
+                PhysicsBodyCommandType.SetDampingAndAngularDamping :
+                PhysicsBodyCommandType.SetDamping,
+            Damping = damping,
+            AngularDamping = angularDamping ?? 0,
+        };
+    }
+}
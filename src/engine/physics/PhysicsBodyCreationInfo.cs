@@ -0,0 +1,45 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using Godot;
+
+/// <summary>
+///   Parameters for a body to create with <see cref="PhysicalWorld.CreateBodiesBulk"/>. Must match the byte layout of
+///   PhysicsBodyCreationInfo in CStructures.h.
+/// </summary>
+/// <remarks>
+///   <para>
+///     Only the basic body properties are supported. Sensors, axis locked bodies and bodies with limited degrees of
+///     freedom need to be created one by one. Axis locked bodies can still be created without adding them to the
+///     world and then be added as a batch with <see cref="PhysicalWorld.AddBodiesBulk"/>.
+///   </para>
+/// </remarks>
+[StructLayout(LayoutKind.Sequential)]
+public struct PhysicsBodyCreationInfo
+{
+    public IntPtr Shape;
+    public JVec3 Position;
+    public JQuat Rotation;
+
+    /// <summary>
+    ///   Non-zero to create a static body instead of a moving one
+    /// </summary>
+    public int Static;
+
+    /// <summary>
+    ///   Non-zero to activate the body when it is added to the world
+    /// </summary>
+    public int Activate;
+
+    public PhysicsBodyCreationInfo(PhysicsShape shape, Vector3 position, Quaternion rotation, bool isStatic = false,
+        bool activate = true)
+    {
+        if (!position.IsFinite() || !rotation.IsFinite())
+            throw new ArgumentException("Position and rotation must be finite");
+
+        Shape = shape.AccessShapeInternal();
+        Position = new JVec3(position);
+        Rotation = new JQuat(rotation);
+        Static = isStatic ? 1 : 0;
+        Activate = activate ? 1 : 0;
+    }
+}
@@ -52,11 +52,29 @@ public readonly struct PhysicsCollision
     /// </summary>
     public readonly float PenetrationAmount;
 
+    /// <summary>
+    ///   How fast the bodies were moving towards each other along the contact normal (positive when approaching). When
+    ///   <see cref="JustStarted"/> is set, this is the impact speed. Not calculated in the collision filter.
+    /// </summary>
+    public readonly float RelativeNormalVelocity;
+
+    /// <summary>
+    ///   World space contact normal pointing from the first body towards the second body. Zero in the collision
+    ///   filter.
+    /// </summary>
+    public readonly JVecF3 ContactNormal;
+
     /// <summary>
     ///   True, on the first physics update this collision appeared (always true in the collision filter).
     ///   Bool is not a blittable type, so this uses a byte instead.
     /// </summary>
     public readonly byte JustStarted;
 
+    /// <summary>
+    ///   True when this is about a contact that ended in the latest physics update. Only recorded when requested
+    ///   when starting collision recording.
+    /// </summary>
+    public readonly byte Ended;
+
     // ReSharper restore UnassignedReadonlyField
 }
@@ -0,0 +1,17 @@
+﻿using System;
+
+/// <summary>
+///   Which physics object layers a query finds. Must match the layers defined in Layers.hpp on the native side
+///   (each layer is the bit 1 &lt;&lt; layer).
+/// </summary>
+[Flags]
+public enum PhysicsLayerMask : uint
+{
+    None = 0,
+    NonMoving = 1 << 0,
+    Moving = 1 << 1,
+    Debris = 1 << 2,
+    Sensor = 1 << 3,
+    Projectile = 1 << 4,
+    All = uint.MaxValue,
+}
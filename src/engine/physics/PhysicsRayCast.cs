@@ -0,0 +1,26 @@
+﻿using System.Runtime.InteropServices;
+using Godot;
+
+/// <summary>
+///   A single ray for <see cref="PhysicalWorld.CastRaysBatch"/>. Must match the byte layout of PhysicsRayCast in
+///   CStructures.h.
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct PhysicsRayCast
+{
+    public JVec3 Start;
+
+    /// <summary>
+    ///   Vector to add to start to get to the end point
+    /// </summary>
+    public JVecF3 EndOffset;
+
+    private int padding;
+
+    public PhysicsRayCast(Vector3 start, Vector3 directionAndLength)
+    {
+        Start = new JVec3(start);
+        EndOffset = new JVecF3(directionAndLength);
+        padding = 0;
+    }
+}
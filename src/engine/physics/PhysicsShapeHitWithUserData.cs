@@ -0,0 +1,42 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using Arch.Core;
+
+/// <summary>
+///   Info regarding a shape cast or collide shape hit. Must match the PhysicsShapeHitWithUserData class byte layout
+///   defined on the native side.
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct PhysicsShapeHitWithUserData
+{
+    /// <summary>
+    ///   The hit entity. May be 0 bytes if hits a physics object not created through the ECS simulation.
+    /// </summary>
+    public readonly Entity BodyEntity;
+
+    /// <summary>
+    ///   Sub-shape hit data in the unresolved form, see <see cref="PhysicsRayWithUserData.SubShapeData"/>
+    /// </summary>
+    public readonly uint SubShapeData;
+
+    /// <summary>
+    ///   How far along the shape cast this hit was (as a fraction of the total cast length). Always 0 for collide
+    ///   shape queries.
+    /// </summary>
+    public readonly float HitFraction;
+
+    /// <summary>
+    ///   How deep the query shape is inside the hit body
+    /// </summary>
+    public readonly float PenetrationDepth;
+
+    /// <summary>
+    ///   Normalized direction the query shape would need to move to get out of the hit body
+    /// </summary>
+    public readonly JVecF3 PenetrationAxis;
+
+    /// <summary>
+    ///   Raw pointer that is not wrapped in a <see cref="NativePhysicsBody"/> for performance reasons
+    /// </summary>
+    public readonly IntPtr Body;
+}
@@ -0,0 +1,32 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using Godot;
+
+/// <summary>
+///   A single shape query for <see cref="PhysicalWorld.CollideShapesBatch"/> and
+///   <see cref="PhysicalWorld.CastShapesBatch"/>. Must match the byte layout of PhysicsShapeQuery in CStructures.h.
+///   The shape must be kept alive by the caller until the query has run.
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct PhysicsShapeQuery
+{
+    public IntPtr Shape;
+    public JVec3 Position;
+    public JQuat Rotation;
+
+    /// <summary>
+    ///   Direction and length of the cast for shape casts, ignored by collide shape queries
+    /// </summary>
+    public JVecF3 Direction;
+
+    private int padding;
+
+    public PhysicsShapeQuery(PhysicsShape shape, Vector3 position, Quaternion rotation, Vector3 direction = default)
+    {
+        Shape = shape.AccessShapeInternal();
+        Position = new JVec3(position);
+        Rotation = new JQuat(rotation);
+        Direction = new JVecF3(direction);
+        padding = 0;
+    }
+}
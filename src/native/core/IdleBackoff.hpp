@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "Include.h"
+
+namespace Thrive
+{
+
+/// \brief Spin -> yield -> park waiting strategy for threads waiting for work or for some other thread to finish
+///
+/// The amount of spinning adapts to how useful it has been: if the waited thing happens while still spinning the
+/// spin limit grows, if the thread had to park (sleep) anyway the limit shrinks to waste less CPU time.
+class IdleBackoff
+{
+public:
+    static constexpr int DEFAULT_MIN_SPIN_COUNT = 16;
+    static constexpr int DEFAULT_MAX_SPIN_COUNT = 4096;
+    static constexpr int DEFAULT_YIELD_COUNT = 16;
+
+public:
+    IdleBackoff() :
+        IdleBackoff(GetMinSpinCount() * 4)
+    {
+    }
+
+    explicit IdleBackoff(int initialSpinCount) :
+        spinLimit(std::clamp(initialSpinCount, GetMinSpinCount(), GetMaxSpinCount()))
+    {
+    }
+
+    /// \brief Configures the idle policy of all waiting threads. The spin limit adapts between the min and max spin
+    /// counts, after spinning the thread yields yieldCount times before parking. A max spin count of 0 disables
+    /// spinning, which saves CPU time (and power) at the cost of slower wake ups.
+    static void SetLimits(int minSpinCount, int maxSpinCount, int yieldCount) noexcept
+    {
+        minSpinCount = std::max(minSpinCount, 0);
+
+        MinSpinCount.store(minSpinCount, std::memory_order_relaxed);
+        MaxSpinCount.store(std::max(maxSpinCount, minSpinCount), std::memory_order_relaxed);
+        YieldCount.store(std::max(yieldCount, 0), std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static int GetMinSpinCount() noexcept
+    {
+        return MinSpinCount.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static int GetMaxSpinCount() noexcept
+    {
+        return MaxSpinCount.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static int GetYieldCount() noexcept
+    {
+        return YieldCount.load(std::memory_order_relaxed);
+    }
+
+    /// \brief Performs one wait step. Call this each time the waited condition is not true yet.
+    /// \returns True when spinning and yielding have been exhausted and the caller should park the thread
+    FORCE_INLINE bool Wait() noexcept
+    {
+        // The limits may have been lowered since the spin limit was last adjusted
+        const auto currentSpinLimit = std::min(spinLimit, GetMaxSpinCount());
+
+        if (iteration < currentSpinLimit)
+        {
+            ++iteration;
+            HYPER_THREAD_YIELD;
+            return false;
+        }
+
+        if (iteration < currentSpinLimit + GetYieldCount())
+        {
+            ++iteration;
+            std::this_thread::yield();
+            return false;
+        }
+
+        return true;
+    }
+
+    /// \brief Call when the waited condition became true (or work was found)
+    FORCE_INLINE void OnSuccess() noexcept
+    {
+        if (iteration == 0)
+            return;
+
+        // Spinning was enough so it is likely worth it to spin a bit longer in the future
+        if (iteration <= spinLimit)
+            spinLimit = std::clamp(spinLimit * 2, GetMinSpinCount(), GetMaxSpinCount());
+
+        iteration = 0;
+    }
+
+    /// \brief Call after the caller has parked the thread (so spinning was wasted time)
+    FORCE_INLINE void OnParked() noexcept
+    {
+        spinLimit = std::clamp(spinLimit / 2, GetMinSpinCount(), GetMaxSpinCount());
+        iteration = 0;
+    }
+
+    [[nodiscard]] int GetSpinLimit() const noexcept
+    {
+        return spinLimit;
+    }
+
+private:
+    static inline std::atomic<int> MinSpinCount{DEFAULT_MIN_SPIN_COUNT};
+    static inline std::atomic<int> MaxSpinCount{DEFAULT_MAX_SPIN_COUNT};
+    static inline std::atomic<int> YieldCount{DEFAULT_YIELD_COUNT};
+
+    int spinLimit;
+    int iteration = 0;
+};
+
+} // namespace Thrive
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Include.h"
+
+namespace Thrive
+{
+
+/// \brief Move-only callable that stores the callable object inline without ever allocating memory
+///
+/// Used instead of std::function for queued tasks so that queueing a lambda doesn't cause heap allocations. Callables
+/// that don't fit in Capacity bytes cause a compile error, those need to capture less data (for example a pointer to
+/// a struct holding the data).
+template<std::size_t Capacity>
+class InlineCallable final
+{
+    static_assert(Capacity >= sizeof(void*), "Inline callable capacity is too small");
+
+    enum class Operation : uint8_t
+    {
+        Invoke,
+        MoveTo,
+        Destroy,
+    };
+
+    /// Single function pointer handling all operations for the stored type to keep the size of this small
+    using Handler = void (*)(Operation operation, void* storage, void* target);
+
+    /// Pointer alignment is used (instead of max_align_t) to not add padding, captures needing a stricter alignment
+    /// are not supported
+    static constexpr std::size_t STORAGE_ALIGNMENT = alignof(void*);
+
+public:
+    InlineCallable() noexcept = default;
+
+    template<typename Callable>
+        requires(!std::is_same_v<std::decay_t<Callable>, InlineCallable> &&
+            std::is_invocable_r_v<void, std::decay_t<Callable>&>)
+    explicit InlineCallable(Callable&& callable) noexcept(
+        std::is_nothrow_constructible_v<std::decay_t<Callable>, Callable&&>)
+    {
+        using Stored = std::decay_t<Callable>;
+
+        static_assert(sizeof(Stored) <= Capacity,
+            "Callable is too large to be stored inline, reduce the amount of captured data (or capture a pointer)");
+        static_assert(alignof(Stored) <= STORAGE_ALIGNMENT, "Callable has too strict alignment requirement");
+        static_assert(std::is_nothrow_move_constructible_v<Stored>, "Callable must be nothrow move constructible");
+
+        new (storage) Stored(std::forward<Callable>(callable));
+
+        if constexpr (std::is_trivially_copyable_v<Stored> && std::is_trivially_destructible_v<Stored>)
+        {
+            handler = &HandleTrivial<Stored>;
+        }
+        else
+        {
+            handler = &Handle<Stored>;
+        }
+    }
+
+    InlineCallable(InlineCallable&& other) noexcept
+    {
+        MoveFrom(other);
+    }
+
+    InlineCallable(const InlineCallable& other) = delete;
+
+    ~InlineCallable()
+    {
+        Reset();
+    }
+
+    InlineCallable& operator=(InlineCallable&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            MoveFrom(other);
+        }
+
+        return *this;
+    }
+
+    InlineCallable& operator=(const InlineCallable& other) = delete;
+
+    FORCE_INLINE void operator()()
+    {
+        handler(Operation::Invoke, storage, nullptr);
+    }
+
+    [[nodiscard]] explicit operator bool() const noexcept
+    {
+        return handler != nullptr;
+    }
+
+    void Reset() noexcept
+    {
+        if (handler != nullptr)
+        {
+            handler(Operation::Destroy, storage, nullptr);
+            handler = nullptr;
+        }
+    }
+
+private:
+    void MoveFrom(InlineCallable& other) noexcept
+    {
+        if (other.handler == nullptr)
+            return;
+
+        other.handler(Operation::MoveTo, other.storage, storage);
+        handler = other.handler;
+        other.handler = nullptr;
+    }
+
+    template<typename Stored>
+    static void Handle(Operation operation, void* storage, void* target)
+    {
+        auto* callable = std::launder(reinterpret_cast<Stored*>(storage));
+
+        switch (operation)
+        {
+            case Operation::Invoke:
+                (*callable)();
+                break;
+            case Operation::MoveTo:
+                new (target) Stored(std::move(*callable));
+                callable->~Stored();
+                break;
+            case Operation::Destroy:
+                callable->~Stored();
+                break;
+        }
+    }
+
+    /// \brief Variant for trivial types (lambdas capturing just pointers and numbers) that can be moved by just
+    /// copying the bytes
+    template<typename Stored>
+    static void HandleTrivial(Operation operation, void* storage, void* target)
+    {
+        switch (operation)
+        {
+            case Operation::Invoke:
+                (*std::launder(reinterpret_cast<Stored*>(storage)))();
+                break;
+            case Operation::MoveTo:
+                std::memcpy(target, storage, sizeof(Stored));
+                break;
+            case Operation::Destroy:
+                break;
+        }
+    }
+
+private:
+    alignas(STORAGE_ALIGNMENT) unsigned char storage[Capacity];
+
+    Handler handler = nullptr;
+};
+
+} // namespace Thrive
@@ -0,0 +1,114 @@
+// ------------------------------------ //
+#include "TaskGroup.hpp"
+
+#include "IdleBackoff.hpp"
+#include "Logger.hpp"
+#include "Time.hpp"
+
+// ------------------------------------ //
+namespace Thrive
+{
+
+TaskGroup::TaskGroup() :
+    state(new SharedState())
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    if (state->PendingTasks.load(std::memory_order_acquire) != 0)
+    {
+        LOG_ERROR("TaskGroup destroyed while it has pending tasks, waiting for them to finish");
+        Wait();
+    }
+
+    // Tasks queued in the task system may still be holding references to the shared state
+    state->Release();
+}
+
+// ------------------------------------ //
+void TaskGroup::Wait()
+{
+    IdleBackoff backoff;
+
+    while (state->PendingTasks.load(std::memory_order_acquire) > 0)
+    {
+        // Help with the work of this group. Only our own tasks are ran as running any task (for example a physics
+        // update) here could block this wait for a very long time.
+        if (state->TryRunOne())
+        {
+            backoff.OnSuccess();
+            continue;
+        }
+
+        if (!backoff.Wait())
+            continue;
+
+        // All tasks are started, the remaining tasks are being ran by other threads
+        std::unique_lock<std::mutex> lock(state->WaitMutex);
+
+        state->WaiterSleeping.store(true, std::memory_order_seq_cst);
+
+        // The timeout is just to start helping again in case a running task adds more tasks to this group
+        state->WaitNotify.wait_for(lock, MillisecondDuration(1),
+            [this]() { return state->PendingTasks.load(std::memory_order_seq_cst) == 0; });
+
+        state->WaiterSleeping.store(false, std::memory_order_relaxed);
+
+        backoff.OnParked();
+    }
+}
+
+// ------------------------------------ //
+void TaskGroup::SharedState::Release() noexcept
+{
+    if (References.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+}
+
+bool TaskGroup::SharedState::TryRunOne()
+{
+    TaskSystem::TaskCallable task;
+
+    Lock.Lock();
+
+    if (UnstartedTasks.empty())
+    {
+        Lock.Unlock();
+        return false;
+    }
+
+    task = std::move(UnstartedTasks.back());
+    UnstartedTasks.pop_back();
+
+    Lock.Unlock();
+
+    // The task counts as done even if it throws, otherwise waiting for the group would never end
+    struct DoneGuard
+    {
+        SharedState* State;
+
+        ~DoneGuard()
+        {
+            State->OnTaskDone();
+        }
+    } guard{this};
+
+    task();
+    return true;
+}
+
+void TaskGroup::SharedState::OnTaskDone()
+{
+    if (PendingTasks.fetch_sub(1, std::memory_order_seq_cst) == 1)
+    {
+        // Last task done, wake the waiter if it has gone to sleep
+        if (WaiterSleeping.load(std::memory_order_seq_cst))
+        {
+            std::lock_guard<std::mutex> lock(WaitMutex);
+            WaitNotify.notify_all();
+        }
+    }
+}
+
+} // namespace Thrive
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "Include.h"
+
+#include "NonCopyable.hpp"
+#include "Spinlock.hpp"
+#include "TaskSystem.hpp"
+
+namespace Thrive
+{
+
+/// \brief A set of tasks that can be waited for together
+///
+/// Tasks can be added from any thread (including from tasks in this same group). Waiting helps by running the not yet
+/// started tasks of this group (and only them, so that waiting can't get stuck running some unrelated long task), so
+/// it is safe to wait on a group from within a task. The group must not be destroyed before Wait returns.
+class TaskGroup : public NonCopyable
+{
+    /// \brief State shared with the tasks queued in the task system. Reference counted as the queued tasks may run
+    /// after this group is already destroyed (when the waiting thread ran the actual work).
+    struct SharedState
+    {
+    public:
+        void Release() noexcept;
+
+        /// \brief Runs one not yet started task of the group
+        /// \returns False if there were no tasks left to start
+        bool TryRunOne();
+
+        void OnTaskDone();
+
+    public:
+        std::atomic<int32_t> References{1};
+
+        std::atomic<int64_t> PendingTasks{0};
+
+        /// Protects UnstartedTasks
+        Spinlock Lock;
+        std::vector<TaskSystem::TaskCallable> UnstartedTasks;
+
+        std::atomic<bool> WaiterSleeping{false};
+
+        std::mutex WaitMutex;
+        std::condition_variable WaitNotify;
+    };
+
+public:
+    TaskGroup();
+
+    ~TaskGroup();
+
+    /// \brief Queues a task as part of this group
+    template<typename Callable>
+        requires std::is_invocable_r_v<void, std::decay_t<Callable>&>
+    void Run(Callable&& callable, TaskSystem::TaskPriority priority = TaskSystem::TaskPriority::Normal)
+    {
+        state->PendingTasks.fetch_add(1, std::memory_order_relaxed);
+
+        state->Lock.Lock();
+        state->UnstartedTasks.emplace_back(std::forward<Callable>(callable));
+        state->Lock.Unlock();
+
+        // The queued task runs whichever task of this group hasn't been started yet (if any are left when it runs)
+        state->References.fetch_add(1, std::memory_order_relaxed);
+
+        TaskSystem::Get().QueueTask(
+            [sharedState = state]()
+            {
+                struct ReleaseGuard
+                {
+                    SharedState* State;
+
+                    ~ReleaseGuard()
+                    {
+                        State->Release();
+                    }
+                } guard{sharedState};
+
+                sharedState->TryRunOne();
+            },
+            priority);
+    }
+
+    /// \brief Queues tasks for running rangeFunction(chunkStart, chunkEnd) on all grainSize sized chunks in
+    /// [begin, end). Doesn't wait for the tasks to complete.
+    template<typename RangeFunction>
+        requires std::is_invocable_r_v<void, RangeFunction&, int64_t, int64_t>
+    void RunRange(int64_t begin, int64_t end, int64_t grainSize, const RangeFunction& rangeFunction)
+    {
+        if (grainSize < 1)
+            grainSize = 1;
+
+        for (auto chunkStart = begin; chunkStart < end; chunkStart += grainSize)
+        {
+            const auto chunkEnd = std::min(end, chunkStart + grainSize);
+
+            Run([rangeFunction, chunkStart, chunkEnd]() mutable { rangeFunction(chunkStart, chunkEnd); });
+        }
+    }
+
+    /// \brief Blocks until all tasks in this group are complete. The calling thread runs the not yet started tasks of
+    /// this group while waiting.
+    void Wait();
+
+    [[nodiscard]] bool IsDone() const noexcept
+    {
+        return state->PendingTasks.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    SharedState* state;
+};
+
+/// \brief Runs rangeFunction(chunkStart, chunkEnd) for [begin, end) split into chunks of at least grainSize in
+/// parallel with the task threads. Returns once all chunks are done.
+///
+/// Chunks are handed out dynamically so that threads finishing early take more of the work. The calling thread also
+/// processes chunks.
+template<typename RangeFunction>
+    requires std::is_invocable_r_v<void, const RangeFunction&, int64_t, int64_t>
+void ParallelFor(int64_t begin, int64_t end, int64_t grainSize, const RangeFunction& rangeFunction)
+{
+    if (end <= begin)
+        return;
+
+    if (grainSize < 1)
+        grainSize = 1;
+
+    const auto chunks = (end - begin + grainSize - 1) / grainSize;
+
+    // Not worth it to go through the task system
+    if (chunks < 2)
+    {
+        rangeFunction(begin, end);
+        return;
+    }
+
+    struct SharedState
+    {
+        std::atomic<int64_t> NextStart;
+        int64_t End;
+        int64_t GrainSize;
+        const RangeFunction* Function;
+
+        void ProcessChunks()
+        {
+            while (true)
+            {
+                const auto chunkStart = NextStart.fetch_add(GrainSize, std::memory_order_relaxed);
+
+                if (chunkStart >= End)
+                    break;
+
+                (*Function)(chunkStart, std::min(End, chunkStart + GrainSize));
+            }
+        }
+    };
+
+    SharedState state{{begin}, end, grainSize, &rangeFunction};
+
+    // The calling thread is one of the threads doing the work
+    const auto helpers = std::min<int64_t>(chunks - 1, TaskSystem::Get().GetThreads());
+
+    TaskGroup group;
+
+    for (int64_t i = 0; i < helpers; ++i)
+    {
+        // Normal priority as the high priority is reserved for Jolt jobs. Helpers that only start after the calling
+        // thread has processed all the chunks are ran (and find nothing to do) by the wait below.
+        group.Run([statePtr = &state]() { statePtr->ProcessChunks(); });
+    }
+
+    state.ProcessChunks();
+
+    group.Wait();
+}
+
+} // namespace Thrive
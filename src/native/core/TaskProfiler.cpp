@@ -0,0 +1,165 @@
+// ------------------------------------ //
+#include "TaskProfiler.hpp"
+
+#include <fstream>
+#include <iomanip>
+
+#include "Logger.hpp"
+#include "TaskSystem.hpp"
+
+// ------------------------------------ //
+namespace Thrive
+{
+static thread_local std::string CurrentThreadProfileName;
+
+static thread_local void* CurrentThreadProfileBuffer = nullptr;
+
+static void WriteEscapedJSONString(std::ofstream& stream, std::string_view text)
+{
+    stream << '"';
+
+    for (const auto character : text)
+    {
+        switch (character)
+        {
+            case '"':
+                stream << "\\\"";
+                break;
+            case '\\':
+                stream << "\\\\";
+                break;
+            case '\n':
+                stream << "\\n";
+                break;
+            default:
+                if (static_cast<unsigned char>(character) < 0x20)
+                {
+                    stream << ' ';
+                }
+                else
+                {
+                    stream << character;
+                }
+
+                break;
+        }
+    }
+
+    stream << '"';
+}
+
+TaskProfiler::TaskProfiler() : origin(SteadyClock::now())
+{
+}
+
+// ------------------------------------ //
+void TaskProfiler::SetEnabled(bool enable)
+{
+    if (enable && !enabled.load())
+        Clear();
+
+    enabled.store(enable);
+}
+
+void TaskProfiler::SetCurrentThreadName(std::string name)
+{
+    CurrentThreadProfileName = std::move(name);
+}
+
+void TaskProfiler::Record(const char* name, SteadyClock::time_point start, SteadyClock::time_point end)
+{
+    auto& buffer = GetCurrentThreadBuffer();
+
+    const Event event{name, std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin).count(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - origin).count()};
+
+    buffer.Lock.Lock();
+    buffer.Events.push_back(event);
+    buffer.Lock.Unlock();
+}
+
+void TaskProfiler::Clear()
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    for (auto& buffer : threadBuffers)
+    {
+        buffer->Lock.Lock();
+        buffer->Events.clear();
+        buffer->Lock.Unlock();
+    }
+}
+
+// ------------------------------------ //
+bool TaskProfiler::WriteChromeTrace(std::string_view path)
+{
+    std::ofstream stream(path.data(), std::ofstream::out | std::ofstream::trunc);
+
+    if (!stream.is_open()) [[unlikely]]
+    {
+        LOG_ERROR(std::string("Can't write task profile to non-writable file at: ") + path.data());
+        return false;
+    }
+
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    for (auto& buffer : threadBuffers)
+    {
+        if (!first)
+            stream << ",\n";
+
+        first = false;
+
+        stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->ThreadId
+               << ",\"args\":{\"name\":";
+        WriteEscapedJSONString(stream, buffer->Name);
+        stream << "}}";
+
+        // Events are written while holding the lock, this makes the recording thread wait, but this is only used
+        // while debugging so that is fine
+        buffer->Lock.Lock();
+
+        for (const auto& event : buffer->Events)
+        {
+            stream << ",\n{\"name\":";
+            WriteEscapedJSONString(stream, event.Name != nullptr ? event.Name : "Unknown");
+            stream << ",\"cat\":\"task\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->ThreadId
+                   << ",\"ts\":" << static_cast<double>(event.Start) / 1000.0
+                   << ",\"dur\":" << static_cast<double>(event.End - event.Start) / 1000.0 << "}";
+        }
+
+        buffer->Lock.Unlock();
+    }
+
+    stream << "]}\n";
+
+    return stream.good();
+}
+
+// ------------------------------------ //
+TaskProfiler::ThreadBuffer& TaskProfiler::GetCurrentThreadBuffer()
+{
+    if (CurrentThreadProfileBuffer != nullptr) [[likely]]
+        return *static_cast<ThreadBuffer*>(CurrentThreadProfileBuffer);
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    const auto threadId = static_cast<uint32_t>(threadBuffers.size()) + 1;
+
+    auto name = CurrentThreadProfileName;
+
+    if (name.empty())
+        name = TaskSystem::IsOnMainThread() ? "Main" : "Thread " + std::to_string(threadId);
+
+    threadBuffers.emplace_back(std::make_unique<ThreadBuffer>(threadId, std::move(name)));
+
+    CurrentThreadProfileBuffer = threadBuffers.back().get();
+    return *threadBuffers.back();
+}
+
+} // namespace Thrive
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "boost/circular_buffer.hpp"
+
+#include "Include.h"
+
+#include "NonCopyable.hpp"
+#include "Spinlock.hpp"
+#include "Time.hpp"
+
+namespace Thrive
+{
+
+/// \brief Records when tasks (and Jolt jobs, by name) are ran on which thread. The data can be exported in the
+/// Chrome trace format (viewable with chrome://tracing or https://ui.perfetto.dev).
+///
+/// Each thread records to its own ring buffer so only the latest events are kept.
+class TaskProfiler : public NonCopyable
+{
+public:
+    struct Event
+    {
+    public:
+        /// Must have static lifetime (Jolt job names are string literals)
+        const char* Name;
+
+        /// Nanoseconds since the profiler origin time
+        int64_t Start;
+        int64_t End;
+    };
+
+    static constexpr size_t EVENTS_PER_THREAD = 16384;
+
+private:
+    struct ThreadBuffer
+    {
+    public:
+        explicit ThreadBuffer(uint32_t threadId, std::string name) :
+            ThreadId(threadId), Name(std::move(name)), Events(EVENTS_PER_THREAD)
+        {
+        }
+
+        /// Only contested while the data is being exported
+        Spinlock Lock;
+
+        const uint32_t ThreadId;
+        const std::string Name;
+
+        boost::circular_buffer<Event> Events;
+    };
+
+    TaskProfiler();
+
+public:
+    static TaskProfiler& Get()
+    {
+        static TaskProfiler profiler;
+
+        return profiler;
+    }
+
+    /// \brief Enables or disables recording. Old data is cleared when enabling.
+    void SetEnabled(bool enable);
+
+    [[nodiscard]] FORCE_INLINE bool IsEnabled() const noexcept
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /// \brief Sets the name the current thread is shown with in the exported data. Needs to be called before the
+    /// thread records anything to take effect.
+    static void SetCurrentThreadName(std::string name);
+
+    /// \brief Records a finished task on the current thread
+    void Record(const char* name, SteadyClock::time_point start, SteadyClock::time_point end);
+
+    /// \brief Writes all currently recorded events to a file as Chrome trace JSON
+    bool WriteChromeTrace(std::string_view path);
+
+    void Clear();
+
+private:
+    ThreadBuffer& GetCurrentThreadBuffer();
+
+private:
+    std::atomic<bool> enabled{false};
+
+    SteadyClock::time_point origin;
+
+    std::mutex buffersMutex;
+
+    /// Buffers are never deleted as threads keep a pointer to their own buffer
+    std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+};
+
+} // namespace Thrive
@@ -1,9 +1,13 @@
 // ------------------------------------ //
 #include "TaskSystem.hpp"
 
+#include <algorithm>
+
 #include "Jolt/Physics/PhysicsSettings.h"
 
+#include "IdleBackoff.hpp"
 #include "Logger.hpp"
+#include "TaskProfiler.hpp"
 #include "Time.hpp"
 
 #ifdef _WIN32
@@ -15,10 +19,17 @@
 #include <debugapi.h>
 #include <processthreadsapi.h>
 
+#include <bit>
+
 #else
 #include <pthread.h>
 #endif
 
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <sched.h>
+#include <unistd.h>
+#endif
+
 // ------------------------------------ //
 namespace Thrive
 {
@@ -27,6 +38,10 @@ static thread_local int MainThreadIdentifier = 0;
 
 static std::atomic<int> ThreadIdentifierNumber{0};
 
+/// Index of the work queue owned by the current thread, -1 if the thread is not a task thread (or didn't get a
+/// queue)
+static thread_local int CurrentWorkerQueue = -1;
+
 std::string GenerateThreadName(int id)
 {
     return "TNative_" + std::to_string(id);
@@ -101,6 +116,41 @@ void SetThreadNameCurrent(int id)
     UNUSED(id);
 }
 
+/// \brief Pins the current thread to the cpuIndex:th CPU the process is allowed to run on, or if negative allows
+/// running on all CPUs again
+bool SetCurrentThreadCPU(int cpuIndex)
+{
+    DWORD_PTR processMask;
+    DWORD_PTR systemMask;
+
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+        return false;
+
+    if (cpuIndex < 0)
+        return SetThreadAffinityMask(GetCurrentThread(), processMask) != 0;
+
+    // Only the processor group the process is in is supported (so at most 64 CPUs)
+    const auto available = std::popcount(static_cast<uint64_t>(processMask));
+
+    if (available < 1)
+        return false;
+
+    int target = cpuIndex % available;
+
+    for (int i = 0; i < 64; ++i)
+    {
+        const auto bit = static_cast<DWORD_PTR>(1) << i;
+
+        if ((processMask & bit) == 0)
+            continue;
+
+        if (target-- == 0)
+            return SetThreadAffinityMask(GetCurrentThread(), bit) != 0;
+    }
+
+    return false;
+}
+
 #elif __APPLE__
 
 void SetThreadName(int id, std::thread& thread)
@@ -116,6 +166,14 @@ void SetThreadNameCurrent(int id)
     pthread_setname_np(GenerateThreadName(id).c_str());
 }
 
+bool SetCurrentThreadCPU(int cpuIndex)
+{
+    // Apple doesn't allow binding threads to specific cores (the affinity policy is only a hint and doesn't work on
+    // ARM)
+    UNUSED(cpuIndex);
+    return false;
+}
+
 #else
 // Assume standard pthreads on Linux or another UNIX type
 
@@ -130,6 +188,43 @@ void SetThreadNameCurrent(int id)
     UNUSED(id);
 }
 
+bool SetCurrentThreadCPU(int cpuIndex)
+{
+    // The main thread's affinity is used as the set of CPUs this process is allowed to use
+    cpu_set_t processSet;
+    CPU_ZERO(&processSet);
+
+    if (sched_getaffinity(getpid(), sizeof(processSet), &processSet) != 0)
+        return false;
+
+    if (cpuIndex < 0)
+        return pthread_setaffinity_np(pthread_self(), sizeof(processSet), &processSet) == 0;
+
+    const int available = CPU_COUNT(&processSet);
+
+    if (available < 1)
+        return false;
+
+    int target = cpuIndex % available;
+
+    for (int i = 0; i < CPU_SETSIZE; ++i)
+    {
+        if (!CPU_ISSET(i, &processSet))
+            continue;
+
+        if (target-- == 0)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(i, &set);
+
+            return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+        }
+    }
+
+    return false;
+}
+
 #endif
 
 TaskSystem::QueuedTask::QueuedTask(SimpleCallable callable)
@@ -141,23 +236,15 @@ TaskSystem::QueuedTask::QueuedTask(SimpleCallable callable)
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "cppcoreguidelines-pro-type-member-init"
 
-#ifdef USE_LOCK_FREE_QUEUE
 TaskSystem::QueuedTask::QueuedTask() : Type(TaskType::Cleared)
 {
 }
-#endif
 
-TaskSystem::QueuedTask::QueuedTask(std::function<void()> callable) : Type(TaskType::StdFunction)
+TaskSystem::QueuedTask::QueuedTask(TaskCallable&& callable) : Type(TaskType::Callable)
 {
-    new (&Function) std::function<void()>(std::move(callable));
+    new (&Function) TaskCallable(std::move(callable));
 }
 
-/*TaskSystem::QueuedTask::QueuedTask(std::function<void()>&& callable)
-{
-    Type = TaskType::StdFunction;
-    new (&Function) std::function<void()>(std::move(callable));
-}*/
-
 TaskSystem::QueuedTask::QueuedTask(Job* callable) : Type(TaskType::JoltJob)
 {
     callable->AddRef();
@@ -176,7 +263,7 @@ TaskSystem::QueuedTask::QueuedTask(QueuedTask&& other) noexcept : Jolt(nullptr),
 
 #pragma clang diagnostic pop
 
-void TaskSystem::QueuedTask::Invoke() const
+void TaskSystem::QueuedTask::Invoke()
 {
     switch (Type)
     {
@@ -188,7 +275,7 @@ void TaskSystem::QueuedTask::Invoke() const
         case TaskType::Simple:
             Simple();
             break;
-        case TaskType::StdFunction:
+        case TaskType::Callable:
             Function();
             break;
         case TaskType::JoltJob:
@@ -198,14 +285,49 @@ void TaskSystem::QueuedTask::Invoke() const
     }
 }
 
-TaskSystem::QueuedTask& TaskSystem::QueuedTask::operator=(QueuedTask&& other) noexcept
+const char* TaskSystem::QueuedTask::GetProfileName() const noexcept
 {
-    if (other.Type != Type)
+    switch (Type)
     {
-        ReleaseCurrentData();
-        Type = other.Type;
+        case TaskType::Cleared:
+            return "Cleared";
+        case TaskType::Quit:
+            return "Quit";
+        case TaskType::Simple:
+            return "Task";
+        case TaskType::Callable:
+            return "Task (callable)";
+        case TaskType::JoltJob:
+            // All jobs are created by CreateJob so this cast is safe
+            return static_cast<const NamedJob*>(Jolt)->Name;
     }
 
+    return "Unknown";
+}
+
+void TaskSystem::NamedJob::RunProfiled()
+{
+    auto& profiler = TaskProfiler::Get();
+
+    if (!profiler.IsEnabled()) [[likely]]
+    {
+        Function();
+        return;
+    }
+
+    const auto start = SteadyClock::now();
+
+    Function();
+
+    profiler.Record(Name, start, SteadyClock::now());
+}
+
+TaskSystem::QueuedTask& TaskSystem::QueuedTask::operator=(QueuedTask&& other) noexcept
+{
+    // Always release the old data, otherwise assigning over an existing job or function would leak it
+    ReleaseCurrentData();
+    Type = other.Type;
+
     MoveDataFromOther(std::move(other));
 
     return *this;
@@ -215,8 +337,8 @@ void TaskSystem::QueuedTask::ReleaseCurrentData()
 {
     switch (Type)
     {
-        case TaskType::StdFunction:
-            Function.~function<void()>();
+        case TaskType::Callable:
+            Function.~TaskCallable();
             break;
         case TaskType::JoltJob:
             Jolt->Release();
@@ -245,8 +367,8 @@ void TaskSystem::QueuedTask::MoveDataFromOther(QueuedTask&& other)
         case TaskType::Simple:
             Simple = other.Simple;
             break;
-        case TaskType::StdFunction:
-            new (&Function) std::function<void()>(std::move(other.Function));
+        case TaskType::Callable:
+            new (&Function) TaskCallable(std::move(other.Function));
             break;
         case TaskType::JoltJob:
             // Steal the job from the other one
@@ -256,21 +378,19 @@ void TaskSystem::QueuedTask::MoveDataFromOther(QueuedTask&& other)
     }
 }
 
-TaskSystem::TaskSystem() :
+TaskSystem::TaskSystem()
 #ifdef USE_LOCK_FREE_QUEUE
     // Must have enough queue size to not deadlock when running with 32 threads (untested if this works with more than
     // 32 threads, but hopefully this does)
-    taskQueue(JPH::cMaxPhysicsJobs),
+    :
+    taskQueues{TaskQueue(JPH::cMaxPhysicsJobs), TaskQueue(JPH::cMaxPhysicsJobs), TaskQueue(JPH::cMaxPhysicsJobs)}
 #endif
-    queueLock(queueMutex)
 {
     // Mark main thread
     MainThreadIdentifier = MAIN_THREAD;
 
     Init(JPH::cMaxPhysicsBarriers);
 
-    queueLock.unlock();
-
     // Start at least one thread initially
     SetThreads(1);
 }
@@ -293,7 +413,10 @@ void TaskSystem::Shutdown()
 
     // A duplicate notify compared to the EndTaskThread method but this feels better to ensure all threads are woken
     // up if they were waiting immediately on shutdown
-    queueNotify.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        queueNotify.notify_all();
+    }
 
     try
     {
@@ -309,13 +432,26 @@ void TaskSystem::Shutdown()
         LOG_ERROR(std::string("Failed to join a task thread: ") + e.what());
     }
 
+    // Empty out the queues. Exiting threads move their remaining tasks to the global queue so only that needs to be
+    // cleared.
 #ifdef USE_LOCK_FREE_QUEUE
-    // Empty out the queue
-    for (int i = 0; i < 5; ++i)
+    for (auto& taskQueue : taskQueues)
     {
-        QueuedTask task;
-        while (taskQueue.try_dequeue(task))
+        for (int i = 0; i < 5; ++i)
         {
+            QueuedTask task;
+            while (taskQueue.try_dequeue(task))
+            {
+            }
+        }
+    }
+#else
+    std::lock_guard<std::mutex> lock(queueMutex);
+    for (auto& taskQueue : taskQueues)
+    {
+        while (!taskQueue.empty())
+        {
+            taskQueue.pop();
         }
     }
 #endif
@@ -341,7 +477,7 @@ void TaskSystem::AssertIsMainThread()
 // ------------------------------------ //
 #ifdef USE_LOCK_FREE_QUEUE
 
-void TaskSystem::TryEnqueueTask(QueuedTask&& task)
+void TaskSystem::TryEnqueueTask(TaskQueue& taskQueue, QueuedTask&& task)
 {
     int retryCount = 0;
 
@@ -382,40 +518,314 @@ void TaskSystem::TryEnqueueTask(QueuedTask&& task)
 #endif
 
 // ------------------------------------ //
-
-void TaskSystem::QueueTask(QueuedTask&& task)
+void TaskSystem::PushGlobalTask(QueuedTask&& task, TaskPriority priority)
 {
+    auto& taskQueue = taskQueues[static_cast<int>(priority)];
+
 #ifdef USE_LOCK_FREE_QUEUE
-    TryEnqueueTask(std::move(task));
+    TryEnqueueTask(taskQueue, std::move(task));
 #else
-    queueLock.lock();
+    std::lock_guard<std::mutex> lock(queueMutex);
 
     taskQueue.emplace(std::move(task));
+#endif
+}
 
-    queueLock.unlock();
+bool TaskSystem::TryPopGlobalTask(QueuedTask& task, TaskPriority priority)
+{
+    auto& taskQueue = taskQueues[static_cast<int>(priority)];
+
+#ifdef USE_LOCK_FREE_QUEUE
+    return taskQueue.try_dequeue(task);
+#else
+    std::lock_guard<std::mutex> lock(queueMutex);
+
+    if (taskQueue.empty())
+        return false;
+
+    task = std::move(taskQueue.front());
+    taskQueue.pop();
+    return true;
 #endif
+}
+
+void TaskSystem::PushLocalTask(WorkerQueue& queue, QueuedTask&& task, TaskPriority priority)
+{
+    auto& lane = queue.Lanes[static_cast<int>(priority)];
+
+    queue.Lock.Lock();
+
+    if (lane.Tasks.full()) [[unlikely]]
+    {
+        // Grow the queue instead of overwriting the oldest task (which is the default circular buffer behaviour)
+        lane.Tasks.set_capacity(std::max<size_t>(lane.Tasks.capacity() * 2, INITIAL_WORKER_QUEUE_CAPACITY));
+    }
+
+    lane.Tasks.push_back(std::move(task));
+    lane.ApproximateSize.store(static_cast<int>(lane.Tasks.size()), std::memory_order_relaxed);
+
+    queue.Lock.Unlock();
+}
+
+bool TaskSystem::TryPopLocalTask(WorkerQueue& queue, QueuedTask& task, TaskPriority priority)
+{
+    auto& lane = queue.Lanes[static_cast<int>(priority)];
+
+    if (lane.ApproximateSize.load(std::memory_order_relaxed) < 1)
+        return false;
+
+    queue.Lock.Lock();
+
+    if (lane.Tasks.empty())
+    {
+        queue.Lock.Unlock();
+        return false;
+    }
+
+    task = std::move(lane.Tasks.back());
+    lane.Tasks.pop_back();
+    lane.ApproximateSize.store(static_cast<int>(lane.Tasks.size()), std::memory_order_relaxed);
+
+    queue.Lock.Unlock();
+    return true;
+}
+
+void TaskSystem::EnqueueTask(QueuedTask&& task, TaskPriority priority)
+{
+    const auto workerIndex = CurrentWorkerQueue;
+
+    if (workerIndex >= 0)
+    {
+        // Task threads keep the work they create for themselves (and for others to steal) to keep related data in
+        // the cache of the current core
+        PushLocalTask(workerQueues[workerIndex], std::move(task), priority);
+    }
+    else
+    {
+        PushGlobalTask(std::move(task), priority);
+    }
+}
+
+// ------------------------------------ //
+bool TaskSystem::TryGetTask(int workerIndex, QueuedTask& task)
+{
+    // Higher priority work is always looked for everywhere before lower priority work
+    for (int i = 0; i < TASK_PRIORITY_COUNT; ++i)
+    {
+        const auto priority = static_cast<TaskPriority>(i);
+
+        if (workerIndex >= 0 && TryPopLocalTask(workerQueues[workerIndex], task, priority))
+            return true;
+
+        if (TryPopGlobalTask(task, priority))
+            return true;
+
+        if (TrySteal(workerIndex, task, priority))
+            return true;
+    }
+
+    return false;
+}
+
+bool TaskSystem::TrySteal(int thiefIndex, QueuedTask& task, TaskPriority priority)
+{
+    const auto queueCount = usedWorkerQueues.load(std::memory_order_acquire);
+
+    if (queueCount < 1)
+        return false;
+
+    // Start from the next queue after our own to spread out which threads are stolen from
+    const int start = thiefIndex >= 0 ? thiefIndex + 1 : 0;
+
+    for (int i = 0; i < queueCount; ++i)
+    {
+        const int index = (start + i) % queueCount;
+
+        if (index == thiefIndex)
+            continue;
+
+        auto& victim = workerQueues[index];
+        auto& lane = victim.Lanes[static_cast<int>(priority)];
+
+        if (lane.ApproximateSize.load(std::memory_order_relaxed) < 1)
+            continue;
+
+        // Don't wait on a contested queue as there are probably other queues with work as well
+        if (!victim.Lock.TryLock())
+            continue;
 
-    queueNotify.notify_one();
+        if (!lane.Tasks.empty())
+        {
+            task = std::move(lane.Tasks.front());
+            lane.Tasks.pop_front();
+            lane.ApproximateSize.store(static_cast<int>(lane.Tasks.size()), std::memory_order_relaxed);
+
+            victim.Lock.Unlock();
+            return true;
+        }
+
+        victim.Lock.Unlock();
+    }
+
+    return false;
 }
 
-void TaskSystem::QueueTaskFromBackgroundThread(QueuedTask&& task)
+bool TaskSystem::HasPendingTasks()
 {
 #ifdef USE_LOCK_FREE_QUEUE
-    TryEnqueueTask(std::move(task));
+    for (const auto& taskQueue : taskQueues)
+    {
+        if (taskQueue.size_approx() > 0)
+            return true;
+    }
 #else
-    std::lock_guard<std::mutex> lock(queueMutex);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
 
-    taskQueue.emplace(std::move(task));
+        for (const auto& taskQueue : taskQueues)
+        {
+            if (!taskQueue.empty())
+                return true;
+        }
+    }
 #endif
 
-    queueNotify.notify_one();
+    const auto queueCount = usedWorkerQueues.load(std::memory_order_acquire);
+
+    for (int i = 0; i < queueCount; ++i)
+    {
+        for (const auto& lane : workerQueues[i].Lanes)
+        {
+            if (lane.ApproximateSize.load(std::memory_order_relaxed) > 0)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+void TaskSystem::WakeThreads(uint32_t count)
+{
+    // Pairs with the sleeping thread incrementing the sleeper count before checking for work, this way either this
+    // sees the sleeper or the sleeper sees the new work
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    const auto sleeping = sleepingThreads.load(std::memory_order_relaxed);
+
+    if (sleeping < 1)
+        return;
+
+    // Locking here guarantees that a thread that has just decided to sleep is already waiting on the condition
+    std::lock_guard<std::mutex> lock(idleMutex);
+
+    if (count >= static_cast<uint32_t>(sleeping))
+    {
+        queueNotify.notify_all();
+    }
+    else
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            queueNotify.notify_one();
+        }
+    }
+}
+
+// ------------------------------------ //
+int TaskSystem::ClaimWorkerQueue()
+{
+    for (int i = 0; i < MAX_WORKER_QUEUES; ++i)
+    {
+        auto& queue = workerQueues[i];
+
+        bool expected = false;
+        if (!queue.InUse.compare_exchange_strong(expected, true))
+            continue;
+
+        queue.Lock.Lock();
+
+        for (auto& lane : queue.Lanes)
+        {
+            if (lane.Tasks.capacity() < INITIAL_WORKER_QUEUE_CAPACITY)
+                lane.Tasks.set_capacity(INITIAL_WORKER_QUEUE_CAPACITY);
+        }
+
+        queue.Lock.Unlock();
+
+        // Make the queue visible to stealing threads
+        auto used = usedWorkerQueues.load();
+        while (used < i + 1 && !usedWorkerQueues.compare_exchange_weak(used, i + 1))
+        {
+        }
+
+        return i;
+    }
+
+    return -1;
+}
+
+void TaskSystem::ReleaseWorkerQueue(int index)
+{
+    if (index < 0)
+        return;
+
+    auto& queue = workerQueues[index];
+
+    // Move any left over work to the global queue so that it is not lost when this thread quits
+    queue.Lock.Lock();
+
+    for (int i = 0; i < TASK_PRIORITY_COUNT; ++i)
+    {
+        auto& lane = queue.Lanes[i];
+
+        while (!lane.Tasks.empty())
+        {
+            PushGlobalTask(std::move(lane.Tasks.front()), static_cast<TaskPriority>(i));
+            lane.Tasks.pop_front();
+        }
+
+        lane.ApproximateSize.store(0, std::memory_order_relaxed);
+    }
+
+    queue.Lock.Unlock();
+
+    queue.InUse.store(false);
+
+    WakeThreads(1);
+}
+
+// ------------------------------------ //
+void TaskSystem::QueueTask(QueuedTask&& task, TaskPriority priority)
+{
+    EnqueueTask(std::move(task), priority);
+
+    WakeThreads(1);
+}
+
+bool TaskSystem::TryRunPendingTask()
+{
+    QueuedTask task;
+
+    if (!TryGetTask(CurrentWorkerQueue, task))
+        return false;
+
+    if (task.Type == TaskType::Quit) [[unlikely]]
+    {
+        // Quit is meant for a task thread, so put it back
+        PushGlobalTask(std::move(task), TaskPriority::High);
+        WakeThreads(1);
+        return false;
+    }
+
+    RunTask(task);
+    return true;
 }
 
 // ------------------------------------ //
 TaskSystem::JobHandle TaskSystem::CreateJob(
     const char* inName, JPH::ColorArg inColor, const JobFunction& inJobFunction, uint32_t inNumDependencies)
 {
-    Job* job;
+    NamedJob* job;
 
 #ifdef USE_OBJECT_POOLS
     {
@@ -423,10 +833,10 @@ TaskSystem::JobHandle TaskSystem::CreateJob(
         job = jobPool.malloc();
     }
 
-    ::new (job) Job(inName, inColor, this, inJobFunction, inNumDependencies);
+    ::new (job) NamedJob(inName, inColor, this, inJobFunction, inNumDependencies);
 
 #else
-    job = new Job(inName, inColor, this, inJobFunction, inNumDependencies);
+    job = new NamedJob(inName, inColor, this, inJobFunction, inNumDependencies);
 #endif
 
     JobHandle handle(job);
@@ -442,54 +852,78 @@ void TaskSystem::FreeJob(Job* inJob)
 #ifdef USE_OBJECT_POOLS
     std::lock_guard<std::mutex> lock(jobPoolMutex);
 
-    jobPool.destroy(inJob);
+    jobPool.destroy(static_cast<NamedJob*>(inJob));
 #else
-    delete inJob;
+    delete static_cast<NamedJob*>(inJob);
 #endif
 }
 
 void TaskSystem::QueueJob(Job* inJob)
 {
-#ifdef USE_LOCK_FREE_QUEUE
-    TryEnqueueTask(QueuedTask(inJob));
-#else
-    std::lock_guard<std::mutex> lock(queueMutex);
-    taskQueue.emplace(inJob);
-#endif
+    // Physics jobs are always high priority as the physics update is waiting on them
+    EnqueueTask(QueuedTask(inJob), TaskPriority::High);
 
-    queueNotify.notify_one();
+    WakeThreads(1);
 }
 
 void TaskSystem::QueueJobs(Job** inJobs, uint32_t inNumJobs)
 {
+    const auto workerIndex = CurrentWorkerQueue;
+
+    if (workerIndex >= 0)
+    {
+        // Put all the jobs in the local queue with one lock, other threads are woken up to steal part of them
+        auto& queue = workerQueues[workerIndex];
+        auto& lane = queue.Lanes[static_cast<int>(TaskPriority::High)];
+
+        queue.Lock.Lock();
+
+        const auto needed = lane.Tasks.size() + inNumJobs;
+        if (needed > lane.Tasks.capacity()) [[unlikely]]
+        {
+            auto newCapacity = std::max<size_t>(lane.Tasks.capacity() * 2, INITIAL_WORKER_QUEUE_CAPACITY);
+            while (newCapacity < needed)
+                newCapacity *= 2;
+
+            lane.Tasks.set_capacity(newCapacity);
+        }
+
+        for (size_t i = 0; i < inNumJobs; ++i)
+        {
+            lane.Tasks.push_back(QueuedTask(inJobs[i]));
+        }
+
+        lane.ApproximateSize.store(static_cast<int>(lane.Tasks.size()), std::memory_order_relaxed);
+
+        queue.Lock.Unlock();
+
+        // This thread will run one of the jobs itself
+        if (inNumJobs > 1)
+            WakeThreads(inNumJobs - 1);
+
+        return;
+    }
+
+    auto& taskQueue = taskQueues[static_cast<int>(TaskPriority::High)];
+
 #ifdef USE_LOCK_FREE_QUEUE
     // TODO: should try_enqueue_bulk be used instead (at least when num jobs is over 2)?
     for (size_t i = 0; i < inNumJobs; ++i)
     {
-        TryEnqueueTask(QueuedTask(inJobs[i]));
+        TryEnqueueTask(taskQueue, QueuedTask(inJobs[i]));
     }
 #else
-    std::lock_guard<std::mutex> lock(queueMutex);
-
-    for (size_t i = 0; i < inNumJobs; ++i)
     {
-        taskQueue.emplace(inJobs[i]);
+        std::lock_guard<std::mutex> lock(queueMutex);
+
+        for (size_t i = 0; i < inNumJobs; ++i)
+        {
+            taskQueue.emplace(inJobs[i]);
+        }
     }
 #endif
 
-    if (inNumJobs > 4)
-    {
-        queueNotify.notify_all();
-    }
-    else if (inNumJobs > 3)
-    {
-        queueNotify.notify_one();
-        queueNotify.notify_one();
-    }
-    else
-    {
-        queueNotify.notify_one();
-    }
+    WakeThreads(inNumJobs);
 }
 
 // ------------------------------------ //
@@ -509,7 +943,11 @@ void TaskSystem::SetThreads(int count) noexcept
         return;
     }
 
-    queueLock.lock();
+    if (count > MAX_WORKER_QUEUES)
+    {
+        LOG_WARNING("Task threads over the limit of " + std::to_string(MAX_WORKER_QUEUES) +
+            " won't have their own work queue");
+    }
 
     targetThreadCount = count;
 
@@ -525,14 +963,58 @@ void TaskSystem::SetThreads(int count) noexcept
         EndTaskThread();
     }
 
-    queueLock.unlock();
-
     // TODO: where should this thread cleaning exist? (here it is not possible to know really which threads have exited)
     /*for (auto iter = taskThreads.begin(); iter != taskThreads.end(); )
     {
     }*/
 }
 
+bool TaskSystem::SetThreadPinning(bool pin, int firstCPU) noexcept
+{
+#ifdef __APPLE__
+    if (pin)
+    {
+        LOG_WARNING("Pinning task threads to CPU cores is not supported on this platform");
+        return false;
+    }
+#endif
+
+    if (firstCPU < 0)
+    {
+        LOG_ERROR("First CPU index for task thread pinning can't be negative");
+        firstCPU = 0;
+    }
+
+    firstPinnedCPU.store(firstCPU, std::memory_order_relaxed);
+    pinThreads.store(pin, std::memory_order_relaxed);
+
+    // Threads check this when they are looking for work
+    affinityVersion.fetch_add(1, std::memory_order_release);
+
+    // Wake up all the threads so that they apply the new setting quickly
+    WakeThreads(MAX_WORKER_QUEUES);
+
+    return true;
+}
+
+void TaskSystem::ApplyThreadAffinity(int workerIndex)
+{
+    if (!pinThreads.load(std::memory_order_relaxed))
+    {
+        SetCurrentThreadCPU(-1);
+        return;
+    }
+
+    // Threads without a work queue are not pinned as there's no stable index for them
+    if (workerIndex < 0)
+        return;
+
+    if (!SetCurrentThreadCPU(firstPinnedCPU.load(std::memory_order_relaxed) + workerIndex))
+    {
+        LOG_WARNING("Failed to pin task thread to a CPU core");
+    }
+}
+
 // ------------------------------------ //
 void TaskSystem::StartTaskThread()
 {
@@ -549,108 +1031,113 @@ void TaskSystem::StartTaskThread()
 
 void TaskSystem::EndTaskThread()
 {
-#ifdef USE_LOCK_FREE_QUEUE
-    TryEnqueueTask(QueuedTask(QuitSentinel()));
-#else
-    queueLock.lock();
+    // Quit commands always go through the global queue to make sure they can't be stolen and then lost. High priority
+    // is used so that changing the thread count is not delayed by a lot of queued work.
+    PushGlobalTask(QueuedTask(QuitSentinel()), TaskPriority::High);
 
-    taskQueue.emplace(QuitSentinel());
-
-    queueLock.unlock();
-#endif
-
-    queueNotify.notify_one();
+    WakeThreads(1);
 
     --threadCount;
 }
 
 // ------------------------------------ //
+void TaskSystem::RunTask(QueuedTask& task)
+{
+    auto& profiler = TaskProfiler::Get();
+
+    // Jolt jobs record themselves so that the ones Jolt runs while waiting on a barrier are also recorded
+    if (!profiler.IsEnabled() || task.Type == TaskType::JoltJob) [[likely]]
+    {
+        task.Invoke();
+        return;
+    }
+
+    const auto start = SteadyClock::now();
+
+    task.Invoke();
+
+    profiler.Record(task.GetProfileName(), start, SteadyClock::now());
+}
+
 void TaskSystem::RunTaskThread(int id)
 {
     const auto threadWait = MillisecondDuration(8);
 
-    std::unique_lock<std::mutex> lock{queueMutex};
-
     SetThreadNameCurrent(id);
+    TaskProfiler::SetCurrentThreadName(GenerateThreadName(id));
 
-#ifdef USE_LOCK_FREE_QUEUE
-    lock.unlock();
-#endif
+    const auto workerIndex = ClaimWorkerQueue();
+    CurrentWorkerQueue = workerIndex;
 
-    while (runThreads)
-    {
-        bool processed = false;
+    uint32_t appliedAffinity = 0;
 
-#ifdef USE_LOCK_FREE_QUEUE
-        lock.lock();
-#endif
+    IdleBackoff backoff;
 
-        queueNotify.wait_for(lock, threadWait);
+    QueuedTask task;
 
-#ifdef USE_LOCK_FREE_QUEUE
-        lock.unlock();
-#endif
+    while (runThreads)
+    {
+        const auto wantedAffinity = affinityVersion.load(std::memory_order_acquire);
+        if (wantedAffinity != appliedAffinity) [[unlikely]]
+        {
+            appliedAffinity = wantedAffinity;
+            ApplyThreadAffinity(workerIndex);
+        }
 
-        for (int i = 0; i < TASK_WAIT_LOOP_COUNT; ++i)
+        if (TryGetTask(workerIndex, task))
         {
-            // Process tasks until empty before waiting again
-#ifdef USE_LOCK_FREE_QUEUE
-            // TODO: should this variable be in the outer scope?
-            QueuedTask task;
-            while (taskQueue.try_dequeue(task))
-#else
-            while (!taskQueue.empty())
-#endif
+            if (task.Type == TaskType::Quit)
             {
-                {
-#ifndef USE_LOCK_FREE_QUEUE
-                    const auto task = std::move(taskQueue.front());
+                CurrentWorkerQueue = -1;
+                ReleaseWorkerQueue(workerIndex);
+                return;
+            }
 
-                    taskQueue.pop();
+            backoff.OnSuccess();
 
-                    // Unlock while running the task
-                    lock.unlock();
-#endif
+            try
+            {
+                RunTask(task);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR(std::string("Background task exception: ") + e.what());
+                throw;
+            }
 
-                    if (task.Type == TaskType::Quit)
-                    {
-                        return;
-                    }
-
-                    processed = true;
-
-                    try
-                    {
-                        task.Invoke();
-                    }
-                    catch (const std::exception& e)
-                    {
-                        LOG_ERROR(std::string("Background task exception: ") + e.what());
-                        throw;
-                    }
-                }
+            // Release the task resources before looking for more work
+            task = QueuedTask();
+            continue;
+        }
 
-#ifndef USE_LOCK_FREE_QUEUE
-                // Extra scope used above to not lock this again until needed (task is destructed)
-                lock.lock();
-#endif
-            }
+        // No work found, first spin and yield for a while as new work often arrives very soon (for example the next
+        // batch of physics jobs), and only after that go to sleep
+        if (!backoff.Wait())
+            continue;
 
-#ifdef USE_LOCK_FREE_QUEUE
-            /*if (!processed)
-            {
-                // Reduce looping speed while the queue is empty
-                HYPER_THREAD_YIELD;
-            }*/
-#endif
+        {
+            std::unique_lock<std::mutex> lock{idleMutex};
 
-            // If we woke up but didn't find any work, go back to sleep
-            if (!processed)
+            sleepingThreads.fetch_add(1);
+
+            // Pairs with the fence in WakeThreads
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            // Re-check for work after registering as sleeping to not miss a wakeup. The timeout is a fallback in case
+            // a notify is missed some other way.
+            if (!HasPendingTasks())
             {
-                break;
+                queueNotify.wait_for(lock, threadWait);
             }
+
+            sleepingThreads.fetch_sub(1);
         }
+
+        backoff.OnParked();
     }
+
+    CurrentWorkerQueue = -1;
+    ReleaseWorkerQueue(workerIndex);
 }
 
 } // namespace Thrive
@@ -1,17 +1,20 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
-#include <functional>
 #include <queue>
 #include <thread>
 #include <vector>
 
+#include "boost/circular_buffer.hpp"
 #include "boost/pool/object_pool.hpp"
 #include "Jolt/Core/JobSystemWithBarrier.h"
 
 #include "Include.h"
 
+#include "InlineCallable.hpp"
+#include "Spinlock.hpp"
 #include "concurrentqueue.h"
 
 namespace Thrive
@@ -25,16 +28,55 @@ public:
 
     using SimpleCallable = void (*)();
 
+    /// \brief Callable type for tasks with captured state. Lambdas capturing more than this size don't compile.
+    using TaskCallable = InlineCallable<48>;
+
+    /// \brief Task threads always run all available higher priority tasks before starting lower priority ones
+    enum class TaskPriority : uint8_t
+    {
+        /// Used for Jolt jobs as a physics update is blocked until they are done
+        High = 0,
+        Normal,
+
+        /// For background work that doesn't need to complete quickly
+        Low,
+    };
+
+    static constexpr int TASK_PRIORITY_COUNT = 3;
+
 private:
     enum class TaskType : uint8_t
     {
         Cleared = 0,
         Quit,
         Simple,
-        StdFunction,
+        Callable,
         JoltJob,
     };
 
+    /// \brief Jolt only stores job names when its own profiler is enabled, so this keeps it for the task profiler
+    ///
+    /// Jobs record themselves to the profiler rather than being recorded when ran as a task, as Jolt also runs jobs
+    /// directly on the thread that is waiting on a barrier.
+    class NamedJob : public Job
+    {
+    public:
+        NamedJob(const char* name, JPH::ColorArg colour, JobSystem* jobSystem, const JobFunction& jobFunction,
+            uint32_t numDependencies) :
+            Job(name, colour, jobSystem, [this]() { RunProfiled(); }, numDependencies),
+            Name(name), Function(jobFunction)
+        {
+        }
+
+        const char* const Name;
+
+    private:
+        void RunProfiled();
+
+    private:
+        const JobFunction Function;
+    };
+
     struct QuitSentinel
     {
     };
@@ -43,16 +85,12 @@ private:
     {
     public:
     public:
-#ifdef USE_LOCK_FREE_QUEUE
         /// \brief Creates an empty task, for use to dequeue items
         explicit QueuedTask();
-#endif
 
         explicit QueuedTask(SimpleCallable callable);
 
-        explicit QueuedTask(std::function<void()> callable);
-
-        // explicit QueuedTask(std::function<void()>&& callable);
+        explicit QueuedTask(TaskCallable&& callable);
 
         explicit QueuedTask(Job* callable);
 
@@ -71,7 +109,10 @@ private:
             // Type = TaskType::Cleared;
         }
 
-        void Invoke() const;
+        void Invoke();
+
+        /// \brief Name of this task to show in profiling data
+        [[nodiscard]] const char* GetProfileName() const noexcept;
 
         QueuedTask& operator=(QueuedTask&& other) noexcept;
 
@@ -81,7 +122,7 @@ private:
         {
             SimpleCallable Simple;
 
-            std::function<void()> Function;
+            TaskCallable Function;
 
             Job* Jolt;
         };
@@ -93,6 +134,45 @@ private:
         void MoveDataFromOther(QueuedTask&& other);
     };
 
+    // Queued tasks are moved around a lot so they should fit in a single cache line
+    static_assert(sizeof(QueuedTask) <= 64, "Queued task has become too large");
+
+    /// \brief Tasks of a single priority in a WorkerQueue
+    struct WorkerLane
+    {
+    public:
+        /// Read without the lock by threads looking for work to steal
+        std::atomic<int> ApproximateSize{0};
+
+        boost::circular_buffer<QueuedTask> Tasks;
+    };
+
+    /// \brief Task deques owned by a single task thread
+    ///
+    /// The owning thread pushes and pops from the back (so the most recently queued, likely still in cache, work is
+    /// ran first) while other threads steal from the front. Aligned to not share cache lines between threads.
+    struct alignas(64) WorkerQueue
+    {
+    public:
+        /// Protects all the lanes
+        Spinlock Lock;
+
+        std::atomic<bool> InUse{false};
+
+        std::array<WorkerLane, TASK_PRIORITY_COUNT> Lanes;
+    };
+
+#if defined(USE_LOCK_FREE_QUEUE)
+    using TaskQueue = moodycamel::ConcurrentQueue<QueuedTask>;
+#else
+    using TaskQueue = std::queue<QueuedTask>;
+#endif
+
+    /// Max number of task threads that get their own work queue. Threads over this limit only use the global queue.
+    static constexpr int MAX_WORKER_QUEUES = 128;
+
+    static constexpr int INITIAL_WORKER_QUEUE_CAPACITY = 256;
+
 private:
     TaskSystem();
     ~TaskSystem() override;
@@ -108,31 +188,37 @@ public:
     [[nodiscard]] static bool IsOnMainThread();
     static void AssertIsMainThread();
 
-    /// \brief Enqueues a new task. Can only be called from the main thread.
-    void QueueTask(SimpleCallable callable)
+    /// \brief Enqueues a new task. Can be called from any thread, including from within running tasks.
+    ///
+    /// Tasks queued by a task thread go to that thread's own work queue (where other threads can steal them from) and
+    /// tasks from other threads go to the lock-free global queue.
+    void QueueTask(SimpleCallable callable, TaskPriority priority = TaskPriority::Normal)
     {
-        QueueTask(QueuedTask(callable));
+        QueueTask(QueuedTask(callable), priority);
     }
 
-    void QueueTask(QueuedTask&& task);
+    void QueueTask(QueuedTask&& task, TaskPriority priority = TaskPriority::Normal);
 
-    void QueueTask(std::function<void()> callable)
+    /// \brief Queues a callable (usually a lambda) that is stored without allocating memory
+    template<typename Callable>
+        requires std::is_invocable_r_v<void, std::decay_t<Callable>&>
+    void QueueTask(Callable&& callable, TaskPriority priority = TaskPriority::Normal)
     {
-        QueueTask(QueuedTask(std::move(callable)));
+        QueueTask(QueuedTask(TaskCallable(std::forward<Callable>(callable))), priority);
     }
 
-    /// \brief Variant of queue that can be called from any thread
-    void QueueTaskFromBackgroundThread(SimpleCallable callable)
+    /// \brief Queues low priority work that is only started when there are no other tasks waiting
+    template<typename Callable>
+        requires std::is_invocable_r_v<void, std::decay_t<Callable>&>
+    void QueueBackgroundTask(Callable&& callable)
     {
-        QueueTaskFromBackgroundThread(QueuedTask(callable));
+        QueueTask(QueuedTask(TaskCallable(std::forward<Callable>(callable))), TaskPriority::Low);
     }
 
-    void QueueTaskFromBackgroundThread(QueuedTask&& task);
-
-    void QueueTaskFromBackgroundThread(std::function<void()>&& callable)
-    {
-        QueueTaskFromBackgroundThread(QueuedTask(std::move(callable)));
-    }
+    /// \brief Runs one queued task on the calling thread if there is one. Used to help with the work while waiting
+    /// for tasks to complete.
+    /// \returns True if a task was ran
+    bool TryRunPendingTask();
 
     // Jolt task interface
 
@@ -146,6 +232,18 @@ public:
         return targetThreadCount;
     }
 
+    /// \brief Sets task threads to be pinned to specific CPU cores (or unpins them)
+    ///
+    /// Task thread with work queue index N is pinned to the (firstCPU + N):th CPU core the process is allowed to run
+    /// on. Threads apply the change the next time they look for work.
+    /// \returns False if thread pinning is not supported on the current platform
+    bool SetThreadPinning(bool pin, int firstCPU = 0) noexcept;
+
+    [[nodiscard]] bool IsThreadPinningEnabled() const noexcept
+    {
+        return pinThreads.load(std::memory_order_relaxed);
+    }
+
     /// \brief The number of physics tasks done in parallel
     ///
     /// TODO: determine if it would be good to limit the max physics threads (maybe 16?)
@@ -166,30 +264,53 @@ protected:
 
 private:
 #ifdef USE_LOCK_FREE_QUEUE
-    FORCE_INLINE void TryEnqueueTask(QueuedTask&& task);
+    FORCE_INLINE void TryEnqueueTask(TaskQueue& taskQueue, QueuedTask&& task);
 #endif
 
+    /// \brief Adds a task to the current thread's work queue if it is a task thread, otherwise to the global queue
+    void EnqueueTask(QueuedTask&& task, TaskPriority priority);
+
+    void PushGlobalTask(QueuedTask&& task, TaskPriority priority);
+    bool TryPopGlobalTask(QueuedTask& task, TaskPriority priority);
+
+    /// \brief Pushes a task to the back of a worker queue. Must be called by the thread owning the queue.
+    static void PushLocalTask(WorkerQueue& queue, QueuedTask&& task, TaskPriority priority);
+    static bool TryPopLocalTask(WorkerQueue& queue, QueuedTask& task, TaskPriority priority);
+
+    /// \brief Finds the next task for the current task thread: first from its own queue, then from the global
+    /// queue and last by stealing from other threads. This is done for each priority level starting from the highest.
+    bool TryGetTask(int workerIndex, QueuedTask& task);
+
+    bool TrySteal(int thiefIndex, QueuedTask& task, TaskPriority priority);
+
+    [[nodiscard]] bool HasPendingTasks();
+
+    /// \brief Wakes up to count sleeping task threads. Only touches the idle mutex if some thread is sleeping.
+    void WakeThreads(uint32_t count);
+
+    int ClaimWorkerQueue();
+    void ReleaseWorkerQueue(int index);
+
+    /// \brief Applies the current thread pinning settings to the calling task thread
+    void ApplyThreadAffinity(int workerIndex);
+
     void StartTaskThread();
     void EndTaskThread();
 
+    /// \brief Runs a task, recording it with the task profiler when that is enabled
+    static void RunTask(QueuedTask& task);
+
     void RunTaskThread(int id);
 
 private:
 #ifdef USE_OBJECT_POOLS
-    boost::object_pool<Job> jobPool;
+    boost::object_pool<NamedJob> jobPool;
 #endif
 
     std::vector<std::thread> taskThreads;
 
-    // || !defined(TASK_QUEUE_USES_POINTERS)
-#if defined(USE_LOCK_FREE_QUEUE)
-    moodycamel::ConcurrentQueue<QueuedTask> taskQueue;
-
-    // #ifdef TASK_QUEUE_USES_POINTERS
-
-#else
-    std::queue<QueuedTask> taskQueue;
-#endif
+    /// Global queues (one per priority) used by threads that are not task threads
+    std::array<TaskQueue, TASK_PRIORITY_COUNT> taskQueues;
 
 #ifdef USE_OBJECT_POOLS
     std::mutex jobPoolMutex;
@@ -198,10 +319,25 @@ private:
     /// When USE_LOCK_FREE_QUEUE is defined this should not be locked to write to the queue
     std::mutex queueMutex;
 
+    std::array<WorkerQueue, MAX_WORKER_QUEUES> workerQueues;
+
+    /// Upper bound of worker queue indexes that have been used. Limits how many queues need to be checked when
+    /// stealing.
+    std::atomic<int> usedWorkerQueues{0};
+
+    /// Lock for threads without work to wait on
+    std::mutex idleMutex;
+
     std::condition_variable queueNotify;
 
-    /// Lock used on the main thread to enqueue tasks
-    std::unique_lock<std::mutex> queueLock;
+    std::atomic<int> sleepingThreads{0};
+
+    /// Incremented each time the thread pinning settings change to make task threads re-apply it
+    std::atomic<uint32_t> affinityVersion{0};
+
+    std::atomic<bool> pinThreads{false};
+
+    std::atomic<int> firstPinnedCPU{0};
 
     int targetThreadCount = 0;
 
@@ -1,9 +1,11 @@
 // ------------------------------------ //
 #include "CInterop.h"
 
+#include <algorithm>
 #include <bit>
 #include <cstdarg>
 #include <cstring>
+#include <vector>
 
 #ifdef _MSC_VER
 #include <intrin.h>
@@ -12,10 +14,15 @@
 #include "Jolt/Core/Factory.h"
 #include "Jolt/Core/Memory.h"
 #include "Jolt/Jolt.h"
+#include "Jolt/Physics/Collision/RayCast.h"
 #include "Jolt/RegisterTypes.h"
 
+#include "core/IdleBackoff.hpp"
 #include "core/IntercommunicationManager.hpp"
+#include "core/TaskGroup.hpp"
+#include "core/TaskProfiler.hpp"
 #include "core/TaskSystem.hpp"
+#include "physics/CollisionEventStream.hpp"
 #include "physics/DebugDrawForwarder.hpp"
 #include "physics/PhysicalWorld.hpp"
 #include "physics/PhysicsBody.hpp"
@@ -133,6 +140,13 @@ PhysicalWorld* CreatePhysicalWorld()
     return reinterpret_cast<PhysicalWorld*>(new Thrive::Physics::PhysicalWorld());
 }
 
+PhysicalWorld* CreatePhysicalWorldWithCapacity(
+    uint32_t maxBodies, uint32_t maxBodyPairs, uint32_t maxContactConstraints)
+{
+    return reinterpret_cast<PhysicalWorld*>(
+        new Thrive::Physics::PhysicalWorld(maxBodies, maxBodyPairs, maxContactConstraints));
+}
+
 void DestroyPhysicalWorld(PhysicalWorld* physicalWorld)
 {
     if (physicalWorld == nullptr)
@@ -239,6 +253,62 @@ void DestroyPhysicalWorldBody(PhysicalWorld* physicalWorld, PhysicsBody* body)
         ->DestroyBody(reinterpret_cast<Thrive::Physics::PhysicsBody*>(body));
 }
 
+int32_t PhysicalWorldCreateBodiesBulk(PhysicalWorld* physicalWorld, const PhysicsBodyCreationInfo* infos,
+    int32_t count, PhysicsBody** bodiesReceiver, bool addToWorld)
+{
+    if (physicalWorld == nullptr || infos == nullptr || bodiesReceiver == nullptr || count <= 0)
+        return 0;
+
+    // Kept per thread to not allocate memory each time
+    thread_local std::vector<Thrive::Physics::PhysicsBodyCreationInfo> convertedInfos;
+    thread_local std::vector<Thrive::Ref<Thrive::Physics::PhysicsBody>> bodies;
+    convertedInfos.resize(count);
+    bodies.resize(count);
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const auto& info = infos[i];
+        auto& converted = convertedInfos[i];
+
+        converted.Shape = info.Shape != nullptr ?
+            reinterpret_cast<Thrive::Physics::ShapeWrapper*>(info.Shape)->GetShape().GetPtr() :
+            nullptr;
+        converted.Position = Thrive::DVec3FromCAPI(info.Position);
+        converted.Rotation = Thrive::QuatFromCAPI(info.Rotation);
+        converted.Static = info.Static != 0;
+        converted.Activate = info.Activate != 0;
+    }
+
+    const auto created = reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+                             ->CreateBodiesBulk(convertedInfos.data(), count, bodies.data(), addToWorld);
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        // The reference is handed over to the caller, this also leaves the scratch storage empty
+        bodiesReceiver[i] = reinterpret_cast<PhysicsBody*>(bodies[i].detach());
+    }
+
+    return created;
+}
+
+void PhysicalWorldAddBodiesBulk(PhysicalWorld* physicalWorld, PhysicsBody** bodies, int32_t count, bool activate)
+{
+    if (physicalWorld == nullptr || bodies == nullptr || count <= 0)
+        return;
+
+    reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->AddBodiesBulk(reinterpret_cast<Thrive::Physics::PhysicsBody* const*>(bodies), count, activate);
+}
+
+void DestroyPhysicalWorldBodiesBulk(PhysicalWorld* physicalWorld, PhysicsBody** bodies, int32_t count)
+{
+    if (physicalWorld == nullptr || bodies == nullptr || count <= 0)
+        return;
+
+    reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->DestroyBodiesBulk(reinterpret_cast<Thrive::Physics::PhysicsBody* const*>(bodies), count);
+}
+
 void SetPhysicsBodyLinearDamping(PhysicalWorld* physicalWorld, PhysicsBody* body, float damping)
 {
     reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
@@ -298,6 +368,68 @@ void ReadPhysicsBodyVelocity(
     *angularVelocityReceiver = Thrive::Vec3ToCAPI(readAngular);
 }
 
+void PhysicalWorldReadBodiesBulk(PhysicalWorld* physicalWorld, PhysicsBody** bodies, int32_t count,
+    JVec3* positionsReceiver, JQuat* rotationsReceiver, JVecF3* velocitiesReceiver, JVecF3* angularVelocitiesReceiver)
+{
+#ifndef NDEBUG
+    if (physicalWorld == nullptr || (count > 0 && (bodies == nullptr || positionsReceiver == nullptr ||
+                                                      rotationsReceiver == nullptr)))
+    {
+        LOG_ERROR("Physics bulk body read call with invalid parameters");
+        return;
+    }
+#endif
+
+    if (count <= 0)
+        return;
+
+    static_assert(sizeof(JVec3) == sizeof(double) * 3);
+    static_assert(sizeof(JQuat) == sizeof(float) * 4);
+    static_assert(sizeof(JVecF3) == sizeof(float) * 3);
+
+    // The C structs are plain packed values so the results are written directly into them
+    reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->ReadBodiesBulk(reinterpret_cast<Thrive::Physics::PhysicsBody* const*>(bodies), count,
+            reinterpret_cast<double*>(positionsReceiver), reinterpret_cast<float*>(rotationsReceiver),
+            reinterpret_cast<float*>(velocitiesReceiver), reinterpret_cast<float*>(angularVelocitiesReceiver));
+}
+
+void PhysicalWorldSetBodySnapshotsEnabled(PhysicalWorld* physicalWorld, bool enabled)
+{
+    reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)->SetBodySnapshotsEnabled(enabled);
+}
+
+bool ReadPhysicsBodySnapshot(PhysicalWorld* physicalWorld, PhysicsBody* body, JVec3* positionReceiver,
+    JQuat* rotationReceiver, JVecF3* velocityReceiver, JVecF3* angularVelocityReceiver)
+{
+#ifndef NDEBUG
+    if (physicalWorld == nullptr || body == nullptr || positionReceiver == nullptr || rotationReceiver == nullptr ||
+        velocityReceiver == nullptr || angularVelocityReceiver == nullptr)
+    {
+        LOG_ERROR("Physics body read snapshot call with invalid parameters");
+        return false;
+    }
+#endif
+
+    JPH::DVec3 readPosition;
+    JPH::Quat readQuat;
+    JPH::Vec3 readVelocity;
+    JPH::Vec3 readAngular;
+
+    if (!reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+            ->ReadBodySnapshot(reinterpret_cast<Thrive::Physics::PhysicsBody*>(body)->GetId(), readPosition, readQuat,
+                readVelocity, readAngular))
+    {
+        return false;
+    }
+
+    *positionReceiver = Thrive::DVec3ToCAPI(readPosition);
+    *rotationReceiver = Thrive::QuatToCAPI(readQuat);
+    *velocityReceiver = Thrive::Vec3ToCAPI(readVelocity);
+    *angularVelocityReceiver = Thrive::Vec3ToCAPI(readAngular);
+    return true;
+}
+
 #pragma clang diagnostic pop
 
 void GiveImpulse(PhysicalWorld* physicalWorld, PhysicsBody* body, JVecF3 impulse)
@@ -386,6 +518,43 @@ bool FixBodyYCoordinateToZero(PhysicalWorld* physicalWorld, PhysicsBody* body)
         ->FixBodyYCoordinateToZero(reinterpret_cast<Thrive::Physics::PhysicsBody*>(body)->GetId());
 }
 
+void PhysicalWorldApplyBodyCommands(PhysicalWorld* physicalWorld, const PhysicsBodyCommand* commands, int32_t count)
+{
+#ifndef NDEBUG
+    if (physicalWorld == nullptr || (count > 0 && commands == nullptr))
+    {
+        LOG_ERROR("Physics apply body commands call with invalid parameters");
+        return;
+    }
+#endif
+
+    static_assert(static_cast<int32_t>(Thrive::Physics::BodyCommandType::SetDampingAndAngularDamping) ==
+        PHYSICS_BODY_COMMAND_SET_DAMPING_AND_ANGULAR_DAMPING);
+
+    // Kept per thread to not allocate memory each time, commands may be applied from multiple threads at once
+    thread_local std::vector<Thrive::Physics::PhysicsBodyCommand> convertedCommands;
+    convertedCommands.resize(std::max(count, 0));
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const auto& command = commands[i];
+        auto& converted = convertedCommands[i];
+
+        converted.Body = reinterpret_cast<Thrive::Physics::PhysicsBody*>(command.Body);
+        converted.Position = Thrive::DVec3FromCAPI(command.Position);
+        converted.Rotation = Thrive::QuatFromCAPI(command.Rotation);
+        converted.Vector = Thrive::Vec3FromCAPI(command.Vector);
+        converted.AngularVector = Thrive::Vec3FromCAPI(command.AngularVector);
+        converted.Damping = command.Damping;
+        converted.AngularDamping = command.AngularDamping;
+        converted.Type = static_cast<Thrive::Physics::BodyCommandType>(command.Type);
+        converted.Activate = command.Activate != 0;
+    }
+
+    reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->ApplyBodyCommands(convertedCommands.data(), count);
+}
+
 void ChangeBodyShape(PhysicalWorld* physicalWorld, PhysicsBody* body, PhysicsShape* shape, bool activate)
 {
     return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
@@ -407,6 +576,13 @@ void PhysicsBodySetCollisionEnabledState(PhysicalWorld* physicalWorld, PhysicsBo
         ->SetCollisionDisabledState(*reinterpret_cast<Thrive::Physics::PhysicsBody*>(body), !collisionsEnabled);
 }
 
+void PhysicsBodySetCollisionGroup(
+    PhysicalWorld* physicalWorld, PhysicsBody* body, uint32_t group, uint32_t category, uint32_t mask)
+{
+    reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->SetCollisionGroup(*reinterpret_cast<Thrive::Physics::PhysicsBody*>(body), group, category, mask);
+}
+
 // ------------------------------------ //
 void PhysicsBodyAddCollisionIgnore(PhysicalWorld* physicalWorld, PhysicsBody* body, PhysicsBody* addIgnore)
 {
@@ -446,13 +622,13 @@ void PhysicsBodyClearAndSetSingleIgnore(PhysicalWorld* physicalWorld, PhysicsBod
 }
 
 // ------------------------------------ //
-int32_t* PhysicsBodyEnableCollisionRecording(
-    PhysicalWorld* physicalWorld, PhysicsBody* body, char* collisionRecordingTarget, int32_t maxRecordedCollisions)
+int32_t* PhysicsBodyEnableCollisionRecording(PhysicalWorld* physicalWorld, PhysicsBody* body,
+    char* collisionRecordingTarget, int32_t maxRecordedCollisions, bool recordEndedCollisions)
 {
     return const_cast<int32_t*>(reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
             ->EnableCollisionRecording(*reinterpret_cast<Thrive::Physics::PhysicsBody*>(body),
                 reinterpret_cast<Thrive::Physics::CollisionRecordListType>(collisionRecordingTarget),
-                maxRecordedCollisions));
+                maxRecordedCollisions, recordEndedCollisions));
 }
 
 void PhysicsBodyDisableCollisionRecording(PhysicalWorld* physicalWorld, PhysicsBody* body)
@@ -461,6 +637,34 @@ void PhysicsBodyDisableCollisionRecording(PhysicalWorld* physicalWorld, PhysicsB
         ->DisableCollisionRecording(*reinterpret_cast<Thrive::Physics::PhysicsBody*>(body));
 }
 
+void PhysicalWorldSetCollisionEventStreamCapacity(PhysicalWorld* physicalWorld, uint32_t capacity)
+{
+    reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)->SetCollisionEventStreamCapacity(capacity);
+}
+
+bool PhysicalWorldGetCollisionEvents(PhysicalWorld* physicalWorld, CollisionEventStreamData* receiver)
+{
+    const auto* stream = reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)->GetCollisionEvents();
+
+    if (stream == nullptr)
+    {
+        std::memset(receiver, 0, sizeof(CollisionEventStreamData));
+        return false;
+    }
+
+    receiver->FirstBodies = stream->GetFirstBodies();
+    receiver->SecondBodies = stream->GetSecondBodies();
+    receiver->FirstSubShapes = stream->GetFirstSubShapes();
+    receiver->SecondSubShapes = stream->GetSecondSubShapes();
+    receiver->Penetrations = stream->GetPenetrations();
+    receiver->Normals = stream->GetNormals();
+    receiver->RelativeNormalVelocities = stream->GetRelativeNormalVelocities();
+    receiver->Flags = stream->GetFlags();
+    receiver->Count = static_cast<int32_t>(stream->GetCount());
+    receiver->DroppedCount = static_cast<int32_t>(stream->GetDroppedCount());
+    return true;
+}
+
 void PhysicsBodyAddCollisionFilter(PhysicalWorld* physicalWorld, PhysicsBody* body, OnFilterPhysicsCollision callback)
 {
     // Needs a two-step cast to be able to cast the function with a pointer argument to a reference argument. This
@@ -490,12 +694,128 @@ void PhysicalWorldRemoveGravity(PhysicalWorld* physicalWorld)
 }
 
 // ------------------------------------ //
-int32_t PhysicalWorldCastRayGetAll(
-    PhysicalWorld* physicalWorld, JVec3 start, JVecF3 endOffset, PhysicsRayWithUserData* dataReceiver, int32_t maxHits)
+int32_t PhysicalWorldCastRayGetAll(PhysicalWorld* physicalWorld, JVec3 start, JVecF3 endOffset,
+    PhysicsRayWithUserData* dataReceiver, int32_t maxHits, uint32_t layerMask, PhysicsBody* ignoredBodies[],
+    int32_t ignoreCount)
 {
     return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
         ->CastRayGetAllUserData(Thrive::DVec3FromCAPI(start), Thrive::Vec3FromCAPI(endOffset),
-            reinterpret_cast<Thrive::Physics::PhysicsRayWithUserData*>(dataReceiver), maxHits);
+            reinterpret_cast<Thrive::Physics::PhysicsRayWithUserData*>(dataReceiver), maxHits, layerMask,
+            reinterpret_cast<Thrive::Physics::PhysicsBody* const*>(ignoredBodies), ignoreCount);
+}
+
+int32_t PhysicalWorldCastRaysBatch(PhysicalWorld* physicalWorld, const PhysicsRayCast* rays, int32_t count,
+    PhysicsRayWithUserData* results, int32_t* hitCountsReceiver, int32_t maxHitsPerRay, uint32_t layerMask,
+    PhysicsBody* ignoredBodies[], int32_t ignoreCount)
+{
+    // Kept per thread to not allocate memory each time, batches may be started from multiple threads at once
+    thread_local std::vector<JPH::RRayCast> convertedRays;
+    convertedRays.resize(std::max(count, 0));
+
+    for (int32_t i = 0; i < count; ++i)
+        convertedRays[i] = JPH::RRayCast{Thrive::DVec3FromCAPI(rays[i].Start), Thrive::Vec3FromCAPI(rays[i].EndOffset)};
+
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->CastRaysBatch(convertedRays.data(), count,
+            reinterpret_cast<Thrive::Physics::PhysicsRayWithUserData*>(results),
+            hitCountsReceiver, maxHitsPerRay, layerMask,
+            reinterpret_cast<Thrive::Physics::PhysicsBody* const*>(ignoredBodies), ignoreCount);
+}
+
+int32_t PhysicalWorldOverlapSphere(PhysicalWorld* physicalWorld, JVec3 center, float radius,
+    PhysicsRayWithUserData* dataReceiver, int32_t maxResults, uint32_t layerMask)
+{
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->OverlapSphere(Thrive::DVec3FromCAPI(center), radius,
+            reinterpret_cast<Thrive::Physics::PhysicsRayWithUserData*>(dataReceiver), maxResults, layerMask);
+}
+
+int32_t PhysicalWorldOverlapAABB(PhysicalWorld* physicalWorld, JVec3 min, JVec3 max,
+    PhysicsRayWithUserData* dataReceiver, int32_t maxResults, uint32_t layerMask)
+{
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->OverlapAABB(Thrive::DVec3FromCAPI(min), Thrive::DVec3FromCAPI(max),
+            reinterpret_cast<Thrive::Physics::PhysicsRayWithUserData*>(dataReceiver), maxResults, layerMask);
+}
+
+int32_t PhysicalWorldFindNearestK(PhysicalWorld* physicalWorld, JVec3 center, float maxDistance,
+    PhysicsRayWithUserData* dataReceiver, int32_t count, uint32_t layerMask)
+{
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->FindNearestK(Thrive::DVec3FromCAPI(center), maxDistance,
+            reinterpret_cast<Thrive::Physics::PhysicsRayWithUserData*>(dataReceiver), count, layerMask);
+}
+
+int32_t PhysicalWorldCollideShape(PhysicalWorld* physicalWorld, PhysicsShape* shape, JVec3 position, JQuat rotation,
+    PhysicsShapeHitWithUserData* dataReceiver, int32_t maxHits, uint32_t layerMask, PhysicsBody* ignoredBodies[],
+    int32_t ignoreCount)
+{
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->CollideShape(*reinterpret_cast<Thrive::Physics::ShapeWrapper*>(shape)->GetShape(),
+            Thrive::DVec3FromCAPI(position), Thrive::QuatFromCAPI(rotation),
+            reinterpret_cast<Thrive::Physics::PhysicsShapeHitWithUserData*>(dataReceiver), maxHits, layerMask,
+            reinterpret_cast<Thrive::Physics::PhysicsBody* const*>(ignoredBodies), ignoreCount);
+}
+
+int32_t PhysicalWorldCastShape(PhysicalWorld* physicalWorld, PhysicsShape* shape, JVec3 position, JQuat rotation,
+    JVecF3 direction, PhysicsShapeHitWithUserData* dataReceiver, int32_t maxHits, uint32_t layerMask,
+    PhysicsBody* ignoredBodies[], int32_t ignoreCount)
+{
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->CastShape(*reinterpret_cast<Thrive::Physics::ShapeWrapper*>(shape)->GetShape(),
+            Thrive::DVec3FromCAPI(position), Thrive::QuatFromCAPI(rotation), Thrive::Vec3FromCAPI(direction),
+            reinterpret_cast<Thrive::Physics::PhysicsShapeHitWithUserData*>(dataReceiver), maxHits, layerMask,
+            reinterpret_cast<Thrive::Physics::PhysicsBody* const*>(ignoredBodies), ignoreCount);
+}
+
+/// \brief Converts shape queries for the batch shape query methods. The returned storage is kept per thread to not
+/// allocate memory each time, batches may be started from multiple threads at once.
+static const std::vector<Thrive::Physics::PhysicsShapeQuery>& ConvertShapeQueries(
+    const PhysicsShapeQuery* queries, int32_t count)
+{
+    thread_local std::vector<Thrive::Physics::PhysicsShapeQuery> convertedQueries;
+    convertedQueries.resize(std::max(count, 0));
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const auto& query = queries[i];
+        auto& converted = convertedQueries[i];
+
+        converted.Shape = query.Shape != nullptr ?
+            reinterpret_cast<Thrive::Physics::ShapeWrapper*>(query.Shape)->GetShape().GetPtr() :
+            nullptr;
+        converted.Position = Thrive::DVec3FromCAPI(query.Position);
+        converted.Rotation = Thrive::QuatFromCAPI(query.Rotation);
+        converted.Direction = Thrive::Vec3FromCAPI(query.Direction);
+    }
+
+    return convertedQueries;
+}
+
+int32_t PhysicalWorldCollideShapesBatch(PhysicalWorld* physicalWorld, const PhysicsShapeQuery* queries, int32_t count,
+    PhysicsShapeHitWithUserData* results, int32_t* hitCountsReceiver, int32_t maxHitsPerQuery, uint32_t layerMask,
+    PhysicsBody* ignoredBodies[], int32_t ignoreCount)
+{
+    const auto& convertedQueries = ConvertShapeQueries(queries, count);
+
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->CollideShapesBatch(convertedQueries.data(), count,
+            reinterpret_cast<Thrive::Physics::PhysicsShapeHitWithUserData*>(results), hitCountsReceiver,
+            maxHitsPerQuery, layerMask, reinterpret_cast<Thrive::Physics::PhysicsBody* const*>(ignoredBodies),
+            ignoreCount);
+}
+
+int32_t PhysicalWorldCastShapesBatch(PhysicalWorld* physicalWorld, const PhysicsShapeQuery* queries, int32_t count,
+    PhysicsShapeHitWithUserData* results, int32_t* hitCountsReceiver, int32_t maxHitsPerQuery, uint32_t layerMask,
+    PhysicsBody* ignoredBodies[], int32_t ignoreCount)
+{
+    const auto& convertedQueries = ConvertShapeQueries(queries, count);
+
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->CastShapesBatch(convertedQueries.data(), count,
+            reinterpret_cast<Thrive::Physics::PhysicsShapeHitWithUserData*>(results), hitCountsReceiver,
+            maxHitsPerQuery, layerMask, reinterpret_cast<Thrive::Physics::PhysicsBody* const*>(ignoredBodies),
+            ignoreCount);
 }
 
 // ------------------------------------ //
@@ -514,6 +834,57 @@ bool PhysicalWorldDumpPhysicsState(PhysicalWorld* physicalWorld, const char* pat
     return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)->DumpSystemState(path);
 }
 
+void PhysicalWorldSetMaxStepsPerUpdate(PhysicalWorld* physicalWorld, int32_t maxSteps, int32_t maxCatchUpMultiplier)
+{
+    reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->SetMaxStepsPerUpdate(maxSteps, maxCatchUpMultiplier);
+}
+
+int32_t PhysicalWorldSaveSimulationSnapshot(
+    PhysicalWorld* physicalWorld, char* buffer, int32_t bufferLength, bool delta)
+{
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->SaveSimulationSnapshot(reinterpret_cast<uint8_t*>(buffer), bufferLength, delta);
+}
+
+bool PhysicalWorldRestoreSimulationSnapshot(PhysicalWorld* physicalWorld, const char* data, int32_t length)
+{
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->RestoreSimulationSnapshot(reinterpret_cast<const uint8_t*>(data), length);
+}
+
+void PhysicalWorldSetDeterministicMode(PhysicalWorld* physicalWorld, bool enabled)
+{
+    reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)->SetDeterministicMode(enabled);
+}
+
+void PhysicalWorldSetStepStateHashing(PhysicalWorld* physicalWorld, bool enabled)
+{
+    reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)->SetStepStateHashing(enabled);
+}
+
+uint64_t PhysicalWorldComputeStateHash(PhysicalWorld* physicalWorld)
+{
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)->ComputeStateHash();
+}
+
+uint64_t PhysicalWorldGetStepStateHashChain(PhysicalWorld* physicalWorld)
+{
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)->GetStepStateHashChain();
+}
+
+bool PhysicalWorldResizeCapacity(
+    PhysicalWorld* physicalWorld, uint32_t maxBodies, uint32_t maxBodyPairs, uint32_t maxContactConstraints)
+{
+    return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)
+        ->ResizeCapacity(maxBodies, maxBodyPairs, maxContactConstraints);
+}
+
+void PhysicalWorldSetAutoCapacityGrowth(PhysicalWorld* physicalWorld, bool enabled)
+{
+    reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)->SetAutoCapacityGrowth(enabled);
+}
+
 void PhysicalWorldSetDebugDrawLevel(PhysicalWorld* physicalWorld, int32_t level)
 {
     return reinterpret_cast<Thrive::Physics::PhysicalWorld*>(physicalWorld)->SetDebugLevel(level);
@@ -545,6 +916,11 @@ bool PhysicsBodyIsDetached(PhysicsBody* body)
     return detached;
 }
 
+uint32_t PhysicsBodyGetId(PhysicsBody* body)
+{
+    return reinterpret_cast<Thrive::Physics::PhysicsBody*>(body)->GetId().GetIndexAndSequenceNumber();
+}
+
 void PhysicsBodySetUserData(PhysicsBody* body, const char* data, int32_t dataLength)
 {
     if (!reinterpret_cast<Thrive::Physics::PhysicsBody*>(body)->SetUserData(data, dataLength))
@@ -703,6 +1079,120 @@ int32_t GetNativeExecutorThreads()
     return Thrive::TaskSystem::Get().GetThreads();
 }
 
+bool SetNativeExecutorThreadPinning(bool pinThreads, int32_t firstCPU)
+{
+    LOG_DEBUG("Set native thread pinning: " + std::to_string(pinThreads));
+    return Thrive::TaskSystem::Get().SetThreadPinning(pinThreads, firstCPU);
+}
+
+bool GetNativeExecutorThreadPinning()
+{
+    return Thrive::TaskSystem::Get().IsThreadPinningEnabled();
+}
+
+void SetNativeExecutorIdlePolicy(int32_t minSpinCount, int32_t maxSpinCount, int32_t yieldCount)
+{
+    LOG_DEBUG("Set native idle policy, spin: " + std::to_string(minSpinCount) + "-" + std::to_string(maxSpinCount) +
+        " yield: " + std::to_string(yieldCount));
+    Thrive::IdleBackoff::SetLimits(minSpinCount, maxSpinCount, yieldCount);
+}
+
+void SetNativeTaskProfiling(bool enabled)
+{
+    LOG_DEBUG("Set native task profiling: " + std::to_string(enabled));
+    Thrive::TaskProfiler::Get().SetEnabled(enabled);
+}
+
+bool DumpNativeTaskProfile(const char* path)
+{
+    return Thrive::TaskProfiler::Get().WriteChromeTrace(path);
+}
+
+// ------------------------------------ //
+NativeTaskGroup* CreateNativeTaskGroup()
+{
+    return reinterpret_cast<NativeTaskGroup*>(new Thrive::TaskGroup());
+}
+
+void DestroyNativeTaskGroup(NativeTaskGroup* group)
+{
+    if (group == nullptr)
+        return;
+
+    delete reinterpret_cast<Thrive::TaskGroup*>(group);
+}
+
+void NativeTaskGroupRun(NativeTaskGroup* group, OnNativeTask callback, void* userData)
+{
+    if (group == nullptr)
+    {
+        LOG_ERROR("Null task group given to run");
+        return;
+    }
+
+    if (callback == nullptr)
+    {
+        LOG_ERROR("Null callback given to task group run");
+        return;
+    }
+
+    reinterpret_cast<Thrive::TaskGroup*>(group)->Run([callback, userData]() { callback(userData); });
+}
+
+void NativeTaskGroupRunRange(NativeTaskGroup* group, int64_t begin, int64_t end, int64_t grainSize,
+    OnNativeParallelForRange callback, void* userData)
+{
+    if (group == nullptr)
+    {
+        LOG_ERROR("Null task group given to range run");
+        return;
+    }
+
+    if (callback == nullptr)
+    {
+        LOG_ERROR("Null callback given to task group range run");
+        return;
+    }
+
+    reinterpret_cast<Thrive::TaskGroup*>(group)->RunRange(begin, end, grainSize,
+        [callback, userData](int64_t rangeStart, int64_t rangeEnd) { callback(rangeStart, rangeEnd, userData); });
+}
+
+void NativeTaskGroupWait(NativeTaskGroup* group)
+{
+    if (group == nullptr)
+    {
+        LOG_ERROR("Null task group given to wait");
+        return;
+    }
+
+    reinterpret_cast<Thrive::TaskGroup*>(group)->Wait();
+}
+
+bool NativeTaskGroupIsDone(NativeTaskGroup* group)
+{
+    if (group == nullptr)
+    {
+        LOG_ERROR("Null task group given to done check");
+        return true;
+    }
+
+    return reinterpret_cast<Thrive::TaskGroup*>(group)->IsDone();
+}
+
+void NativeParallelFor(
+    int64_t begin, int64_t end, int64_t grainSize, OnNativeParallelForRange callback, void* userData)
+{
+    if (callback == nullptr)
+    {
+        LOG_ERROR("Null callback given to parallel for");
+        return;
+    }
+
+    Thrive::ParallelFor(begin, end, grainSize,
+        [callback, userData](int64_t rangeStart, int64_t rangeEnd) { callback(rangeStart, rangeEnd, userData); });
+}
+
 bool ArmWaitForEvent()
 {
 #if defined(_MSC_VER) && defined(_M_ARM64)
@@ -16,6 +16,9 @@ extern "C"
 
     typedef bool (*OnFilterPhysicsCollision)(PhysicsCollision* potentialCollision);
 
+    typedef void (*OnNativeTask)(void* userData);
+    typedef void (*OnNativeParallelForRange)(int64_t rangeStart, int64_t rangeEnd, void* userData);
+
     // ------------------------------------ //
     // General
 
@@ -44,6 +47,8 @@ extern "C"
     // Physics world
 
     [[maybe_unused]] THRIVE_NATIVE_API PhysicalWorld* CreatePhysicalWorld();
+    [[maybe_unused]] THRIVE_NATIVE_API PhysicalWorld* CreatePhysicalWorldWithCapacity(
+        uint32_t maxBodies, uint32_t maxBodyPairs, uint32_t maxContactConstraints);
     [[maybe_unused]] THRIVE_NATIVE_API void DestroyPhysicalWorld(PhysicalWorld* physicalWorld);
 
     [[maybe_unused]] THRIVE_NATIVE_API bool ProcessPhysicalWorld(PhysicalWorld* physicalWorld, float delta);
@@ -71,6 +76,18 @@ extern "C"
 
     [[maybe_unused]] THRIVE_NATIVE_API void DestroyPhysicalWorldBody(PhysicalWorld* physicalWorld, PhysicsBody* body);
 
+    /// \brief Creates many bodies at once. Each created body has a reference for the caller like with the single
+    /// body create functions. Bodies that failed to be created are set to null.
+    /// \returns The number of created bodies
+    [[maybe_unused]] THRIVE_NATIVE_API int32_t PhysicalWorldCreateBodiesBulk(PhysicalWorld* physicalWorld,
+        const PhysicsBodyCreationInfo* infos, int32_t count, PhysicsBody** bodiesReceiver, bool addToWorld);
+
+    [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldAddBodiesBulk(
+        PhysicalWorld* physicalWorld, PhysicsBody** bodies, int32_t count, bool activate);
+
+    [[maybe_unused]] THRIVE_NATIVE_API void DestroyPhysicalWorldBodiesBulk(
+        PhysicalWorld* physicalWorld, PhysicsBody** bodies, int32_t count);
+
     [[maybe_unused]] THRIVE_NATIVE_API void SetPhysicsBodyLinearDamping(
         PhysicalWorld* physicalWorld, PhysicsBody* body, float damping);
 
@@ -83,6 +100,21 @@ extern "C"
     [[maybe_unused]] THRIVE_NATIVE_API void ReadPhysicsBodyVelocity(
         PhysicalWorld* physicalWorld, PhysicsBody* body, JVecF3* velocityReceiver, JVecF3* angularVelocityReceiver);
 
+    /// \brief Reads transforms of count bodies into the receiver arrays with a single call. The velocity receivers
+    /// may be null to skip reading velocities.
+    [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldReadBodiesBulk(PhysicalWorld* physicalWorld,
+        PhysicsBody** bodies, int32_t count, JVec3* positionsReceiver, JQuat* rotationsReceiver,
+        JVecF3* velocitiesReceiver, JVecF3* angularVelocitiesReceiver);
+
+    [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldSetBodySnapshotsEnabled(
+        PhysicalWorld* physicalWorld, bool enabled);
+
+    /// \brief Reads body state as it was after the latest physics update, safe to call while physics is running in
+    /// the background
+    /// \returns False if snapshots are not enabled or the body wasn't in the world
+    [[maybe_unused]] THRIVE_NATIVE_API bool ReadPhysicsBodySnapshot(PhysicalWorld* physicalWorld, PhysicsBody* body,
+        JVec3* positionReceiver, JQuat* rotationReceiver, JVecF3* velocityReceiver, JVecF3* angularVelocityReceiver);
+
     [[maybe_unused]] THRIVE_NATIVE_API void GiveImpulse(
         PhysicalWorld* physicalWorld, PhysicsBody* body, JVecF3 impulse);
 
@@ -116,6 +148,11 @@ extern "C"
 
     [[maybe_unused]] THRIVE_NATIVE_API bool FixBodyYCoordinateToZero(PhysicalWorld* physicalWorld, PhysicsBody* body);
 
+    /// \brief Applies a buffer of body modifications with a single call. Commands for the same body should be next to
+    /// each other for best performance.
+    [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldApplyBodyCommands(
+        PhysicalWorld* physicalWorld, const PhysicsBodyCommand* commands, int32_t count);
+
     [[maybe_unused]] THRIVE_NATIVE_API void ChangeBodyShape(
         PhysicalWorld* physicalWorld, PhysicsBody* body, PhysicsShape* shape, bool activate);
 
@@ -125,6 +162,11 @@ extern "C"
     [[maybe_unused]] THRIVE_NATIVE_API void PhysicsBodySetCollisionEnabledState(
         PhysicalWorld* physicalWorld, PhysicsBody* body, bool collisionsEnabled);
 
+    /// Bodies with the same non-zero group don't collide, and bodies only collide if each one's category matches the
+    /// other one's mask. Group 0, category 1 and a full mask disable group filtering for the body.
+    [[maybe_unused]] THRIVE_NATIVE_API void PhysicsBodySetCollisionGroup(
+        PhysicalWorld* physicalWorld, PhysicsBody* body, uint32_t group, uint32_t category, uint32_t mask);
+
     [[maybe_unused]] THRIVE_NATIVE_API void PhysicsBodyAddCollisionIgnore(
         PhysicalWorld* physicalWorld, PhysicsBody* body, PhysicsBody* addIgnore);
 
@@ -141,13 +183,20 @@ extern "C"
         PhysicalWorld* physicalWorld, PhysicsBody* body, PhysicsBody* onlyIgnoredBody);
 
     /// Sets up collision recording for a body. The returned value is a pointer to read the currently active collisions
-    /// that have been written to collisionRecordingTarget
-    [[maybe_unused]] THRIVE_NATIVE_API int32_t* PhysicsBodyEnableCollisionRecording(
-        PhysicalWorld* physicalWorld, PhysicsBody* body, char* collisionRecordingTarget, int32_t maxRecordedCollisions);
+    /// that have been written to collisionRecordingTarget. recordEndedCollisions also records contacts ending.
+    [[maybe_unused]] THRIVE_NATIVE_API int32_t* PhysicsBodyEnableCollisionRecording(PhysicalWorld* physicalWorld,
+        PhysicsBody* body, char* collisionRecordingTarget, int32_t maxRecordedCollisions, bool recordEndedCollisions);
 
     [[maybe_unused]] THRIVE_NATIVE_API void PhysicsBodyDisableCollisionRecording(
         PhysicalWorld* physicalWorld, PhysicsBody* body);
 
+    /// Capacity of 0 disables the world-level collision event stream
+    [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldSetCollisionEventStreamCapacity(
+        PhysicalWorld* physicalWorld, uint32_t capacity);
+
+    [[maybe_unused]] THRIVE_NATIVE_API bool PhysicalWorldGetCollisionEvents(
+        PhysicalWorld* physicalWorld, CollisionEventStreamData* receiver);
+
     [[maybe_unused]] THRIVE_NATIVE_API void PhysicsBodyAddCollisionFilter(
         PhysicalWorld* physicalWorld, PhysicsBody* body, OnFilterPhysicsCollision callback);
 
@@ -157,8 +206,43 @@ extern "C"
     [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldSetGravity(PhysicalWorld* physicalWorld, JVecF3 gravity);
     [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldRemoveGravity(PhysicalWorld* physicalWorld);
 
+    /// Layer mask has bit (1 << layer) set for each object layer that can be hit. Ignored bodies is an optional
+    /// (can be null) list of bodies that can't be hit.
     [[maybe_unused]] THRIVE_NATIVE_API int32_t PhysicalWorldCastRayGetAll(PhysicalWorld* physicalWorld, JVec3 start,
-        JVecF3 endOffset, PhysicsRayWithUserData* dataReceiver, int32_t maxHits);
+        JVecF3 endOffset, PhysicsRayWithUserData* dataReceiver, int32_t maxHits, uint32_t layerMask,
+        PhysicsBody* ignoredBodies[], int32_t ignoreCount);
+
+    /// Results needs space for count * maxHitsPerRay hits, the hits of ray i start at index i * maxHitsPerRay
+    [[maybe_unused]] THRIVE_NATIVE_API int32_t PhysicalWorldCastRaysBatch(PhysicalWorld* physicalWorld,
+        const PhysicsRayCast* rays, int32_t count, PhysicsRayWithUserData* results, int32_t* hitCountsReceiver,
+        int32_t maxHitsPerRay, uint32_t layerMask, PhysicsBody* ignoredBodies[], int32_t ignoreCount);
+
+    /// Layer mask has bit (1 << layer) set for each object layer to include in the results
+    [[maybe_unused]] THRIVE_NATIVE_API int32_t PhysicalWorldOverlapSphere(PhysicalWorld* physicalWorld, JVec3 center,
+        float radius, PhysicsRayWithUserData* dataReceiver, int32_t maxResults, uint32_t layerMask);
+    [[maybe_unused]] THRIVE_NATIVE_API int32_t PhysicalWorldOverlapAABB(PhysicalWorld* physicalWorld, JVec3 min,
+        JVec3 max, PhysicsRayWithUserData* dataReceiver, int32_t maxResults, uint32_t layerMask);
+    [[maybe_unused]] THRIVE_NATIVE_API int32_t PhysicalWorldFindNearestK(PhysicalWorld* physicalWorld, JVec3 center,
+        float maxDistance, PhysicsRayWithUserData* dataReceiver, int32_t count, uint32_t layerMask);
+
+    /// Exact shape overlap and sweep queries, only one hit per body is reported
+    [[maybe_unused]] THRIVE_NATIVE_API int32_t PhysicalWorldCollideShape(PhysicalWorld* physicalWorld,
+        PhysicsShape* shape, JVec3 position, JQuat rotation, PhysicsShapeHitWithUserData* dataReceiver,
+        int32_t maxHits, uint32_t layerMask, PhysicsBody* ignoredBodies[], int32_t ignoreCount);
+    [[maybe_unused]] THRIVE_NATIVE_API int32_t PhysicalWorldCastShape(PhysicalWorld* physicalWorld,
+        PhysicsShape* shape, JVec3 position, JQuat rotation, JVecF3 direction,
+        PhysicsShapeHitWithUserData* dataReceiver, int32_t maxHits, uint32_t layerMask, PhysicsBody* ignoredBodies[],
+        int32_t ignoreCount);
+
+    /// Results needs space for count * maxHitsPerQuery hits, the hits of query i start at index i * maxHitsPerQuery
+    [[maybe_unused]] THRIVE_NATIVE_API int32_t PhysicalWorldCollideShapesBatch(PhysicalWorld* physicalWorld,
+        const PhysicsShapeQuery* queries, int32_t count, PhysicsShapeHitWithUserData* results,
+        int32_t* hitCountsReceiver, int32_t maxHitsPerQuery, uint32_t layerMask, PhysicsBody* ignoredBodies[],
+        int32_t ignoreCount);
+    [[maybe_unused]] THRIVE_NATIVE_API int32_t PhysicalWorldCastShapesBatch(PhysicalWorld* physicalWorld,
+        const PhysicsShapeQuery* queries, int32_t count, PhysicsShapeHitWithUserData* results,
+        int32_t* hitCountsReceiver, int32_t maxHitsPerQuery, uint32_t layerMask, PhysicsBody* ignoredBodies[],
+        int32_t ignoreCount);
 
     [[maybe_unused]] THRIVE_NATIVE_API float PhysicalWorldGetPhysicsLatestTime(PhysicalWorld* physicalWorld);
     [[maybe_unused]] THRIVE_NATIVE_API float PhysicalWorldGetPhysicsAverageTime(PhysicalWorld* physicalWorld);
@@ -166,6 +250,31 @@ extern "C"
     [[maybe_unused]] THRIVE_NATIVE_API bool PhysicalWorldDumpPhysicsState(
         PhysicalWorld* physicalWorld, const char* path);
 
+    /// \brief Limits physics steps per process call (0 for unlimited). Pending steps over the limit are merged up to
+    /// maxCatchUpMultiplier times (1 to not merge) before the extra time is discarded.
+    [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldSetMaxStepsPerUpdate(
+        PhysicalWorld* physicalWorld, int32_t maxSteps, int32_t maxCatchUpMultiplier);
+
+    /// Returns the number of bytes written or the negative of the required buffer size if the buffer is too small.
+    /// INT32_MIN is returned if the snapshot can't be saved right now. Snapshots only contain the state of the existing
+    /// bodies, see PhysicalWorld::SaveSimulationSnapshot.
+    [[maybe_unused]] THRIVE_NATIVE_API int32_t PhysicalWorldSaveSimulationSnapshot(
+        PhysicalWorld* physicalWorld, char* buffer, int32_t bufferLength, bool delta);
+    [[maybe_unused]] THRIVE_NATIVE_API bool PhysicalWorldRestoreSimulationSnapshot(
+        PhysicalWorld* physicalWorld, const char* data, int32_t length);
+
+    [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldSetDeterministicMode(
+        PhysicalWorld* physicalWorld, bool enabled);
+    [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldSetStepStateHashing(
+        PhysicalWorld* physicalWorld, bool enabled);
+    [[maybe_unused]] THRIVE_NATIVE_API uint64_t PhysicalWorldComputeStateHash(PhysicalWorld* physicalWorld);
+    [[maybe_unused]] THRIVE_NATIVE_API uint64_t PhysicalWorldGetStepStateHashChain(PhysicalWorld* physicalWorld);
+
+    [[maybe_unused]] THRIVE_NATIVE_API bool PhysicalWorldResizeCapacity(PhysicalWorld* physicalWorld,
+        uint32_t maxBodies, uint32_t maxBodyPairs, uint32_t maxContactConstraints);
+    [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldSetAutoCapacityGrowth(
+        PhysicalWorld* physicalWorld, bool enabled);
+
     [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldSetDebugDrawLevel(
         PhysicalWorld* physicalWorld, int32_t level = 0);
     [[maybe_unused]] THRIVE_NATIVE_API void PhysicalWorldSetDebugDrawCameraLocation(
@@ -177,6 +286,9 @@ extern "C"
 
     [[maybe_unused]] THRIVE_NATIVE_API bool PhysicsBodyIsDetached(PhysicsBody* body);
 
+    /// Returns the Jolt body ID (index and sequence number) used to refer to this body in collision event streams
+    [[maybe_unused]] THRIVE_NATIVE_API uint32_t PhysicsBodyGetId(PhysicsBody* body);
+
     /// Set user data for a physics body, note that currently all data needs to be the same size to fully work,
     /// which is specified by Thrive::PHYSICS_USER_DATA_SIZE
     [[maybe_unused]] THRIVE_NATIVE_API void PhysicsBodySetUserData(
@@ -225,4 +337,44 @@ extern "C"
 
     [[maybe_unused]] THRIVE_NATIVE_API void SetNativeExecutorThreads(int32_t count);
     [[maybe_unused]] THRIVE_NATIVE_API int32_t GetNativeExecutorThreads();
+
+    /// \brief Pins native executor threads to CPU cores starting from firstCPU (or unpins them)
+    /// \returns False if not supported on the current platform
+    [[maybe_unused]] THRIVE_NATIVE_API bool SetNativeExecutorThreadPinning(bool pinThreads, int32_t firstCPU);
+    [[maybe_unused]] THRIVE_NATIVE_API bool GetNativeExecutorThreadPinning();
+
+    /// \brief Configures how long idle native threads spin and yield before sleeping. Negative values are clamped to 0
+    /// and maxSpinCount is raised to at least minSpinCount.
+    [[maybe_unused]] THRIVE_NATIVE_API void SetNativeExecutorIdlePolicy(
+        int32_t minSpinCount, int32_t maxSpinCount, int32_t yieldCount);
+
+    /// \brief Starts or stops recording executed native tasks. Starting clears old data.
+    [[maybe_unused]] THRIVE_NATIVE_API void SetNativeTaskProfiling(bool enabled);
+
+    /// \brief Writes the recorded task data to a file in the Chrome trace event JSON format
+    [[maybe_unused]] THRIVE_NATIVE_API bool DumpNativeTaskProfile(const char* path);
+
+    // ------------------------------------ //
+    // Task groups
+
+    [[maybe_unused]] THRIVE_NATIVE_API NativeTaskGroup* CreateNativeTaskGroup();
+
+    /// \brief Destroys a task group, waits for any pending tasks first
+    [[maybe_unused]] THRIVE_NATIVE_API void DestroyNativeTaskGroup(NativeTaskGroup* group);
+
+    [[maybe_unused]] THRIVE_NATIVE_API void NativeTaskGroupRun(
+        NativeTaskGroup* group, OnNativeTask callback, void* userData);
+
+    /// \brief Queues callback to be called for all grainSize sized chunks of [begin, end) without waiting for them
+    [[maybe_unused]] THRIVE_NATIVE_API void NativeTaskGroupRunRange(NativeTaskGroup* group, int64_t begin, int64_t end,
+        int64_t grainSize, OnNativeParallelForRange callback, void* userData);
+
+    /// \brief Waits for all tasks in a group to complete. The calling thread helps with running tasks while waiting.
+    [[maybe_unused]] THRIVE_NATIVE_API void NativeTaskGroupWait(NativeTaskGroup* group);
+    [[maybe_unused]] THRIVE_NATIVE_API bool NativeTaskGroupIsDone(NativeTaskGroup* group);
+
+    /// \brief Runs callback in parallel for chunks of [begin, end) that are at least grainSize long, returns when
+    /// all chunks are done
+    [[maybe_unused]] THRIVE_NATIVE_API void NativeParallelFor(
+        int64_t begin, int64_t end, int64_t grainSize, OnNativeParallelForRange callback, void* userData);
 }
@@ -13,6 +13,7 @@ extern "C"
     typedef struct ThriveConfig ThriveConfig;
     typedef struct DebugDrawer DebugDrawer;
     typedef struct GodotVariant GodotVariant;
+    typedef struct NativeTaskGroup NativeTaskGroup;
 
     typedef struct JVec3
     {
@@ -52,6 +53,11 @@ extern "C"
         char RayData[PHYSICS_RAY_DATA_SIZE];
     } PhysicsRayWithUserData;
 
+    typedef struct PhysicsShapeHitWithUserData
+    {
+        char HitData[PHYSICS_SHAPE_HIT_DATA_SIZE];
+    } PhysicsShapeHitWithUserData;
+
     BEGIN_PACKED_STRUCT;
 
     typedef struct PACKED_STRUCT SubShapeDefinition
@@ -66,6 +72,134 @@ extern "C"
 
     static inline const JQuat QuatIdentity = JQuat{0, 0, 0, 1};
 
+    /// \brief Type of PhysicsBodyCommand, this tells which of the fields of the command are used
+    enum PHYSICS_BODY_COMMAND_TYPE : int32_t
+    {
+        /// Uses Vector
+        PHYSICS_BODY_COMMAND_GIVE_IMPULSE = 0,
+        /// Uses AngularVector
+        PHYSICS_BODY_COMMAND_GIVE_ANGULAR_IMPULSE = 1,
+        /// Uses Vector
+        PHYSICS_BODY_COMMAND_SET_VELOCITY = 2,
+        /// Uses AngularVector
+        PHYSICS_BODY_COMMAND_SET_ANGULAR_VELOCITY = 3,
+        /// Uses Vector and AngularVector
+        PHYSICS_BODY_COMMAND_SET_VELOCITY_AND_ANGULAR_VELOCITY = 4,
+        /// Uses Position and Activate
+        PHYSICS_BODY_COMMAND_SET_POSITION = 5,
+        /// Uses Position, Rotation and Activate
+        PHYSICS_BODY_COMMAND_SET_POSITION_AND_ROTATION = 6,
+        /// Uses Damping
+        PHYSICS_BODY_COMMAND_SET_DAMPING = 7,
+        /// Uses Damping and AngularDamping
+        PHYSICS_BODY_COMMAND_SET_DAMPING_AND_ANGULAR_DAMPING = 8,
+    };
+
+    /// \brief A single body modification for PhysicalWorldApplyBodyCommands. Must match the C# side
+    /// PhysicsBodyCommand struct.
+    typedef struct PhysicsBodyCommand
+    {
+        PhysicsBody* Body;
+        JVec3 Position;
+        JQuat Rotation;
+        JVecF3 Vector;
+        JVecF3 AngularVector;
+        float Damping;
+        float AngularDamping;
+        int32_t Type;
+
+        /// Non-zero to activate the body on position change
+        int32_t Activate;
+    } PhysicsBodyCommand;
+
+#ifdef __cplusplus
+    static_assert(sizeof(PhysicsBodyCommand) == 88, "PhysicsBodyCommand layout changed (expected 88 bytes)");
+#endif
+
+    /// \brief Parameters for creating one body with PhysicalWorldCreateBodiesBulk. Must match the C# side
+    /// PhysicsBodyCreationInfo struct. Sensors, axis locks and limited degrees of freedom are not supported here.
+    typedef struct PhysicsBodyCreationInfo
+    {
+        PhysicsShape* Shape;
+        JVec3 Position;
+        JQuat Rotation;
+
+        /// Non-zero to create a static body instead of a moving one
+        int32_t Static;
+
+        /// Non-zero to activate the body when it is added to the world
+        int32_t Activate;
+    } PhysicsBodyCreationInfo;
+
+#ifdef __cplusplus
+    static_assert(sizeof(PhysicsBodyCreationInfo) == 56, "PhysicsBodyCreationInfo layout changed (expected 56 bytes)");
+#endif
+
+    /// \brief One ray for PhysicalWorldCastRaysBatch. Must match the C# side PhysicsRayCast struct.
+    typedef struct PhysicsRayCast
+    {
+        JVec3 Start;
+
+        /// End point is Start + EndOffset
+        JVecF3 EndOffset;
+
+        /// Explicitly specified to not rely on the compilers adding the same padding
+        int32_t Padding;
+    } PhysicsRayCast;
+
+#ifdef __cplusplus
+    static_assert(sizeof(PhysicsRayCast) == 40, "PhysicsRayCast layout changed (expected 40 bytes)");
+#endif
+
+    /// \brief One shape query for the batch shape query functions. Must match the C# side PhysicsShapeQuery struct.
+    typedef struct PhysicsShapeQuery
+    {
+        PhysicsShape* Shape;
+        JVec3 Position;
+        JQuat Rotation;
+
+        /// Direction and length of the cast for shape casts, not used by collide shape queries
+        JVecF3 Direction;
+
+        int32_t Padding;
+    } PhysicsShapeQuery;
+
+#ifdef __cplusplus
+    static_assert(sizeof(PhysicsShapeQuery) == 64, "PhysicsShapeQuery layout changed (expected 64 bytes)");
+#endif
+
+    /// \brief Pointers to the arrays of the world-level collision event stream. Each array has Count valid items,
+    /// item i of each array belongs to the same collision. Must match the C# side CollisionEventStreamData struct.
+    typedef struct CollisionEventStreamData
+    {
+        /// Jolt body IDs (index and sequence number) of the colliding bodies, first body has the lower ID
+        const uint32_t* FirstBodies;
+        const uint32_t* SecondBodies;
+
+        const uint32_t* FirstSubShapes;
+        const uint32_t* SecondSubShapes;
+        const float* Penetrations;
+
+        /// 3 floats per collision, the normal points from the first body towards the second
+        const float* Normals;
+
+        /// Speed the bodies are approaching each other along the normal (positive when approaching)
+        const float* RelativeNormalVelocities;
+
+        /// Bit 1 is set on the first update the collision appeared, bit 2 when the contact ended (ended records only
+        /// have the bodies and raw sub-shapes set)
+        const uint8_t* Flags;
+
+        int32_t Count;
+
+        /// Number of collisions that didn't fit in the stream
+        int32_t DroppedCount;
+    } CollisionEventStreamData;
+
+#ifdef __cplusplus
+    static_assert(sizeof(CollisionEventStreamData) == 72, "CollisionEventStreamData layout changed");
+#endif
+
     /// Opaque type for passing through info on Thrive::NativeLibIntercommunication instances on the C# side
     typedef struct NativeLibIntercommunicationOpaque
     {
@@ -9,6 +9,7 @@ using System.Reflection;
 using System.Runtime.InteropServices;
 using System.Runtime.Intrinsics.X86;
 using System.Text;
+using System.Threading;
 using DevCenterCommunication.Models.Enums;
 using Godot;
 using SharedBase.Models;
@@ -24,6 +25,8 @@ public static class NativeInterop
 
     // Need these delegate holders to keep delegates alive
     private static readonly NativeMethods.OnLogMessage LogMessageCallback = ForwardMessage;
+    private static readonly NativeMethods.OnNativeTask NativeTaskCallback = RunNativeTask;
+    private static readonly NativeMethods.OnNativeParallelForRange NativeRangeCallback = RunNativeRange;
 
     private static readonly Dictionary<string, string> FoundFolderLibraries = new();
 
@@ -242,6 +245,175 @@ public static class NativeInterop
         NativeMethods.SetNativeExecutorThreads(threads);
     }
 
+    /// <summary>
+    ///   Pins the native executor threads to CPU cores (or unpins them)
+    /// </summary>
+    /// <returns>False if native library is not loaded or pinning is not supported on the current platform</returns>
+    public static bool SetNativeThreadPinning(bool pinThreads, int firstCPU = 0)
+    {
+        if (!nativeLoadSucceeded)
+            return false;
+
+        return NativeMethods.SetNativeExecutorThreadPinning(pinThreads, firstCPU);
+    }
+
+    /// <returns>True if the native executor threads are currently pinned to CPU cores</returns>
+    public static bool GetNativeThreadPinning()
+    {
+        if (!nativeLoadSucceeded)
+            return false;
+
+        return NativeMethods.GetNativeExecutorThreadPinning();
+    }
+
+    /// <summary>
+    ///   Configures how long idle native threads busy wait before sleeping. Spinning adapts between the min and max
+    ///   spin counts and is followed by yieldCount thread yields. Lower values use less CPU time when idle but make
+    ///   waking up to new work slower.
+    /// </summary>
+    public static void SetNativeIdlePolicy(int minSpinCount, int maxSpinCount, int yieldCount)
+    {
+        if (!nativeLoadSucceeded)
+            return;
+
+        NativeMethods.SetNativeExecutorIdlePolicy(minSpinCount, maxSpinCount, yieldCount);
+    }
+
+    /// <summary>
+    ///   Starts or stops recording timings of the tasks ran by the native executor threads. Starting clears the
+    ///   previously recorded data.
+    /// </summary>
+    public static void SetNativeTaskProfiling(bool enabled)
+    {
+        if (!nativeLoadSucceeded)
+            return;
+
+        NativeMethods.SetNativeTaskProfiling(enabled);
+    }
+
+    /// <summary>
+    ///   Writes the recorded native task timings to a file that can be opened in chrome://tracing or Perfetto
+    /// </summary>
+    /// <returns>True on success</returns>
+    public static bool DumpNativeTaskProfile(string path)
+    {
+        if (!nativeLoadSucceeded)
+            return false;
+
+        return NativeMethods.DumpNativeTaskProfile(path);
+    }
+
+    /// <summary>
+    ///   Runs rangeAction(chunkStart, chunkEnd) for [begin, end) split into chunks of grainSize on the native
+    ///   executor threads. The calling thread also processes chunks. Returns once all chunks are done.
+    /// </summary>
+    public static void ParallelFor(long begin, long end, long grainSize, Action<long, long> rangeAction)
+    {
+        if (end <= begin)
+            return;
+
+        if (!nativeLoadSucceeded)
+        {
+            rangeAction(begin, end);
+            return;
+        }
+
+        // As this waits for all chunks to be done, there's no need to count the chunks to know when to free this
+        var handle = GCHandle.Alloc(new RangeTask(rangeAction, -1));
+        try
+        {
+            NativeMethods.NativeParallelFor(begin, end, grainSize, NativeRangeCallback, GCHandle.ToIntPtr(handle));
+        }
+        finally
+        {
+            handle.Free();
+        }
+    }
+
+    /// <summary>
+    ///   Creates a native task group that tasks can be added to and then waited for together. Must be destroyed with
+    ///   <see cref="DestroyTaskGroup"/>.
+    /// </summary>
+    /// <returns>The group or zero if the native library is not loaded</returns>
+    public static IntPtr CreateTaskGroup()
+    {
+        if (!nativeLoadSucceeded)
+            return IntPtr.Zero;
+
+        return NativeMethods.CreateNativeTaskGroup();
+    }
+
+    /// <summary>
+    ///   Destroys a task group. Waits for the tasks of the group if they are not finished yet.
+    /// </summary>
+    public static void DestroyTaskGroup(IntPtr group)
+    {
+        if (group == IntPtr.Zero)
+            return;
+
+        NativeMethods.DestroyNativeTaskGroup(group);
+    }
+
+    /// <summary>
+    ///   Queues a task in a task group. If the native library is not loaded, the task is ran immediately.
+    /// </summary>
+    public static void RunInTaskGroup(IntPtr group, Action task)
+    {
+        if (group == IntPtr.Zero)
+        {
+            task();
+            return;
+        }
+
+        NativeMethods.NativeTaskGroupRun(group, NativeTaskCallback, GCHandle.ToIntPtr(GCHandle.Alloc(task)));
+    }
+
+    /// <summary>
+    ///   Queues tasks in a task group to run rangeAction(chunkStart, chunkEnd) on all grainSize sized chunks of
+    ///   [begin, end)
+    /// </summary>
+    public static void RunRangeInTaskGroup(IntPtr group, long begin, long end, long grainSize,
+        Action<long, long> rangeAction)
+    {
+        if (end <= begin)
+            return;
+
+        if (group == IntPtr.Zero)
+        {
+            rangeAction(begin, end);
+            return;
+        }
+
+        if (grainSize < 1)
+            grainSize = 1;
+
+        // Must match the chunk splitting on the native side so that the handle is freed after the last chunk
+        var chunks = (end - begin + grainSize - 1) / grainSize;
+
+        var handle = GCHandle.Alloc(new RangeTask(rangeAction, chunks));
+        NativeMethods.NativeTaskGroupRunRange(group, begin, end, grainSize, NativeRangeCallback,
+            GCHandle.ToIntPtr(handle));
+    }
+
+    /// <summary>
+    ///   Blocks until all tasks in the group are complete. The calling thread helps run the tasks of the group.
+    /// </summary>
+    public static void WaitTaskGroup(IntPtr group)
+    {
+        if (group == IntPtr.Zero)
+            return;
+
+        NativeMethods.NativeTaskGroupWait(group);
+    }
+
+    public static bool IsTaskGroupDone(IntPtr group)
+    {
+        if (group == IntPtr.Zero)
+            return true;
+
+        return NativeMethods.NativeTaskGroupIsDone(group);
+    }
+
     public static bool TryArmWaitForEvent()
     {
         if (!nativeLoadSucceeded)
@@ -258,6 +430,49 @@ public static class NativeInterop
         return NativeMethods.ArmDataMemoryBarrierAndSendEvent();
     }
 
+    /// <summary>
+    ///   Callback for <see cref="RunInTaskGroup"/>. Exceptions can't be allowed to propagate to the native side so
+    ///   they are just printed.
+    /// </summary>
+    private static void RunNativeTask(IntPtr userData)
+    {
+        var handle = GCHandle.FromIntPtr(userData);
+
+        try
+        {
+            ((Action)handle.Target!).Invoke();
+        }
+        catch (Exception e)
+        {
+            GD.PrintErr("Native task group task failed: ", e);
+        }
+        finally
+        {
+            handle.Free();
+        }
+    }
+
+    private static void RunNativeRange(long rangeStart, long rangeEnd, IntPtr userData)
+    {
+        var handle = GCHandle.FromIntPtr(userData);
+        var task = (RangeTask)handle.Target!;
+
+        try
+        {
+            task.Action.Invoke(rangeStart, rangeEnd);
+        }
+        catch (Exception e)
+        {
+            GD.PrintErr("Native parallel range task failed: ", e);
+        }
+        finally
+        {
+            // Free the handle once all the chunks of a task group range run are done
+            if (task.RemainingChunks > 0 && Interlocked.Decrement(ref task.RemainingChunks) == 0)
+                handle.Free();
+        }
+    }
+
     private static CPUCheckResult CheckCPUFeaturesFull()
     {
         var result = CPUCheckResult.CPUCheckSuccess;
@@ -405,8 +620,15 @@ public static class NativeInterop
         CheckSizeOfType<JColour>(4 * 4);
 
         // These must match the configuration in the relevant C++ files or otherwise things will break badly
-        CheckSizeOfType<PhysicsCollision>(56);
+        CheckSizeOfType<PhysicsCollision>(72);
         CheckSizeOfType<PhysicsRayWithUserData>(32);
+        CheckSizeOfType<PhysicsShapeHitWithUserData>(48);
+
+        CheckSizeOfType<PhysicsRayCast>(40);
+        CheckSizeOfType<PhysicsShapeQuery>(64);
+        CheckSizeOfType<PhysicsBodyCommand>(88);
+        CheckSizeOfType<PhysicsBodyCreationInfo>(56);
+        CheckSizeOfType<CollisionEventStreamData>(72);
 
         CheckSizeOfType<SubShapeDefinition>(40);
 
@@ -775,6 +997,22 @@ public static class NativeInterop
         FoundFolderLibraries[libraryName] = "NOT_FOUND_LIBRARY";
         return false;
     }
+
+    private class RangeTask
+    {
+        public readonly Action<long, long> Action;
+
+        /// <summary>
+        ///   Chunks not yet ran, negative if the creator of this object frees the handle to this
+        /// </summary>
+        public long RemainingChunks;
+
+        public RangeTask(Action<long, long> action, long chunks)
+        {
+            Action = action;
+            RemainingChunks = chunks;
+        }
+    }
 }
 
 /// <summary>
@@ -789,6 +1027,10 @@ internal static partial class NativeMethods
 
     internal delegate void OnTriangleDraw(JVec3 vertex1, JVec3 vertex2, JVec3 vertex3, JColour colour);
 
+    internal delegate void OnNativeTask(IntPtr userData);
+
+    internal delegate void OnNativeParallelForRange(long rangeStart, long rangeEnd, IntPtr userData);
+
     internal enum LogLevel : byte
     {
         Debug = 0,
@@ -830,6 +1072,48 @@ internal static partial class NativeMethods
     [DllImport("thrive_native")]
     internal static extern int GetNativeExecutorThreads();
 
+    [DllImport("thrive_native")]
+    [return: MarshalAs(UnmanagedType.U1)]
+    internal static extern bool SetNativeExecutorThreadPinning(bool pinThreads, int firstCPU);
+
+    [DllImport("thrive_native")]
+    [return: MarshalAs(UnmanagedType.U1)]
+    internal static extern bool GetNativeExecutorThreadPinning();
+
+    [DllImport("thrive_native")]
+    internal static extern void SetNativeExecutorIdlePolicy(int minSpinCount, int maxSpinCount, int yieldCount);
+
+    [DllImport("thrive_native")]
+    internal static extern void SetNativeTaskProfiling(bool enabled);
+
+    [DllImport("thrive_native", CharSet = CharSet.Ansi, BestFitMapping = false)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    internal static extern bool DumpNativeTaskProfile(string path);
+
+    [DllImport("thrive_native")]
+    internal static extern IntPtr CreateNativeTaskGroup();
+
+    [DllImport("thrive_native")]
+    internal static extern void DestroyNativeTaskGroup(IntPtr group);
+
+    [DllImport("thrive_native")]
+    internal static extern void NativeTaskGroupRun(IntPtr group, OnNativeTask callback, IntPtr userData);
+
+    [DllImport("thrive_native")]
+    internal static extern void NativeTaskGroupRunRange(IntPtr group, long begin, long end, long grainSize,
+        OnNativeParallelForRange callback, IntPtr userData);
+
+    [DllImport("thrive_native")]
+    internal static extern void NativeTaskGroupWait(IntPtr group);
+
+    [DllImport("thrive_native")]
+    [return: MarshalAs(UnmanagedType.U1)]
+    internal static extern bool NativeTaskGroupIsDone(IntPtr group);
+
+    [DllImport("thrive_native")]
+    internal static extern void NativeParallelFor(long begin, long end, long grainSize,
+        OnNativeParallelForRange callback, IntPtr userData);
+
     [SuppressGCTransition]
     [DllImport("thrive_native")]
     [return: MarshalAs(UnmanagedType.I1)]
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "Jolt/Physics/Body/BodyLock.h"
+#include "Jolt/Physics/Body/BodyLockInterface.h"
+#include "Jolt/Physics/Collision/CollideShape.h"
+#include "Jolt/Physics/Collision/ShapeCast.h"
+
+#include "PhysicsBody.hpp"
+#include "PhysicsShapeHitWithUserData.hpp"
+
+namespace Thrive::Physics
+{
+
+/// \brief Helper class to collect shape cast or collide shape hits from Jolt into PhysicsShapeHitWithUserData array.
+///
+/// Only one hit is kept per body (the earliest one for casts and the deepest one for collisions). When more bodies
+/// are hit than there is space for, the worst stored hit is replaced, so the result is the best maxHits bodies in no
+/// particular order. Once full, the query is told to skip hits that can't be better than the worst stored hit.
+template<class BaseCollector>
+class ArrayShapeHitCollector final : public BaseCollector, public NonCopyable
+{
+    static constexpr bool IS_CAST = std::is_same_v<typename BaseCollector::ResultType, JPH::ShapeCastResult>;
+
+    /// \brief Open addressing hash table slot from a hit body to its index in the hit storage
+    struct LookupSlot
+    {
+        const PhysicsBody* Body;
+        int Index;
+    };
+
+public:
+    using typename BaseCollector::ResultType;
+
+    ArrayShapeHitCollector(
+        PhysicsShapeHitWithUserData dataReceiver[], int maxHits, const JPH::BodyLockInterface& bodyLockInterface) :
+        bodyInterface(bodyLockInterface),
+        hitStorage(dataReceiver), maxHitCount(dataReceiver != nullptr ? maxHits : 0), lookup(GetLookupStorage())
+    {
+        if (maxHitCount > 0)
+        {
+            // Keeping the load factor at most half keeps the probe sequences short
+            lookup.assign(std::bit_ceil(static_cast<unsigned int>(maxHitCount) * 2), LookupSlot{nullptr, -1});
+            lookupMask = static_cast<uint32_t>(lookup.size() - 1);
+        }
+        else
+        {
+            // Old data from a previous query must not be looked at
+            lookup.clear();
+        }
+    }
+
+    void AddHit(const ResultType& inResult) override
+    {
+        // We need to lock the body to read the user data in it
+        JPH::BodyLockRead lock(bodyInterface, inResult.mBodyID2);
+        if (!lock.Succeeded()) [[unlikely]]
+        {
+            // Can't read body
+            return;
+        }
+
+        const auto* bodyWrapper = PhysicsBody::FromJoltBody(lock.GetBody().GetUserData());
+
+        // Smaller is better, this is how Jolt compares hits as well
+        const float quality = inResult.GetEarlyOutFraction();
+
+        PhysicsShapeHitWithUserData* target;
+        int targetIndex;
+
+        // Update an existing hit on the same body if this one is better
+        if (const auto existing = FindExisting(bodyWrapper); existing >= 0)
+        {
+            if (quality >= StoredQuality(hitStorage[existing]))
+                return;
+
+            targetIndex = existing;
+            target = &hitStorage[targetIndex];
+        }
+        else if (hitCount < maxHitCount)
+        {
+            targetIndex = hitCount++;
+            target = &hitStorage[targetIndex];
+
+            SetHitBody(*target, targetIndex, bodyWrapper);
+        }
+        else
+        {
+            if (maxHitCount < 1) [[unlikely]]
+            {
+                // Nothing can be stored so there's no point in continuing the query
+                this->ForceEarlyOut();
+                return;
+            }
+
+            if (quality >= StoredQuality(hitStorage[worstIndex]))
+                return;
+
+            // Out of space, so this replaces the worst hit
+            targetIndex = worstIndex;
+            target = &hitStorage[targetIndex];
+
+            RemoveFromLookup(target->Body);
+            SetHitBody(*target, targetIndex, bodyWrapper);
+        }
+
+        target->SubShapeData = inResult.mSubShapeID2.GetValue();
+        target->PenetrationDepth = inResult.mPenetrationDepth;
+
+        const auto axis = inResult.mPenetrationAxis.NormalizedOr(JPH::Vec3::sZero());
+        target->PenetrationAxis = {axis.GetX(), axis.GetY(), axis.GetZ()};
+
+        if constexpr (IS_CAST)
+        {
+            target->HitFraction = inResult.mFraction;
+        }
+        else
+        {
+            target->HitFraction = 0;
+        }
+
+        if (hitCount < maxHitCount)
+            return;
+
+        // The worst hit only needs to be found again when it may have changed
+        if (!worstFound || targetIndex == worstIndex)
+        {
+            UpdateWorstHit();
+
+            // Later hits need to beat the worst stored one to be useful. This can only get smaller as the worst hit
+            // is only ever replaced by a better one.
+            this->UpdateEarlyOutFraction(StoredQuality(hitStorage[worstIndex]));
+        }
+    }
+
+    [[nodiscard]] inline int GetHitCount() const noexcept
+    {
+        return hitCount;
+    }
+
+private:
+    /// \brief Matches what ResultType::GetEarlyOutFraction returns for the hit that was stored
+    static float StoredQuality(const PhysicsShapeHitWithUserData& hit) noexcept
+    {
+        if constexpr (IS_CAST)
+        {
+            return hit.HitFraction > 0 ? hit.HitFraction : -hit.PenetrationDepth;
+        }
+        else
+        {
+            return -hit.PenetrationDepth;
+        }
+    }
+
+    static std::vector<LookupSlot>& GetLookupStorage()
+    {
+        // Kept per thread to not allocate memory for each query. Queries don't nest so one is enough per thread.
+        thread_local std::vector<LookupSlot> storage;
+        return storage;
+    }
+
+    [[nodiscard]] inline uint32_t Hash(const PhysicsBody* body) const noexcept
+    {
+        return static_cast<uint32_t>(
+                   (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(body)) * 0x9E3779B97F4A7C15ull) >> 32) &
+            lookupMask;
+    }
+
+    [[nodiscard]] int FindExisting(const PhysicsBody* body) const noexcept
+    {
+        // Hits without a body wrapper can't be told apart
+        if (body == nullptr || lookup.empty()) [[unlikely]]
+            return -1;
+
+        for (auto index = Hash(body);; index = (index + 1) & lookupMask)
+        {
+            const auto& slot = lookup[index];
+
+            if (slot.Body == body)
+                return slot.Index;
+
+            if (slot.Body == nullptr)
+                return -1;
+        }
+    }
+
+    void SetHitBody(PhysicsShapeHitWithUserData& hit, int index, const PhysicsBody* body) noexcept
+    {
+        hit.Body = body;
+
+        if (body == nullptr)
+        {
+            std::memset(hit.BodyUserData.data(), 0, hit.BodyUserData.size());
+            return;
+        }
+
+        std::memcpy(hit.BodyUserData.data(), body->GetUserData().data(), hit.BodyUserData.size());
+
+        // There's always a free slot as there are at least twice as many slots as there are stored hits
+        auto slotIndex = Hash(body);
+
+        while (lookup[slotIndex].Body != nullptr)
+            slotIndex = (slotIndex + 1) & lookupMask;
+
+        lookup[slotIndex] = LookupSlot{body, index};
+    }
+
+    void RemoveFromLookup(const PhysicsBody* body) noexcept
+    {
+        if (body == nullptr)
+            return;
+
+        auto emptyIndex = Hash(body);
+
+        while (lookup[emptyIndex].Body != body)
+            emptyIndex = (emptyIndex + 1) & lookupMask;
+
+        // Move following entries back so that no probe sequence goes through the freed slot
+        for (auto index = (emptyIndex + 1) & lookupMask; lookup[index].Body != nullptr;
+             index = (index + 1) & lookupMask)
+        {
+            const auto home = Hash(lookup[index].Body);
+
+            // Entries can only be moved back if that doesn't go before their home slot
+            if (((index - home) & lookupMask) >= ((index - emptyIndex) & lookupMask))
+            {
+                lookup[emptyIndex] = lookup[index];
+                emptyIndex = index;
+            }
+        }
+
+        lookup[emptyIndex] = LookupSlot{nullptr, -1};
+    }
+
+    void UpdateWorstHit() noexcept
+    {
+        worstIndex = 0;
+
+        for (int i = 1; i < hitCount; ++i)
+        {
+            if (StoredQuality(hitStorage[i]) > StoredQuality(hitStorage[worstIndex]))
+                worstIndex = i;
+        }
+
+        worstFound = true;
+    }
+
+private:
+    const JPH::BodyLockInterface& bodyInterface;
+
+    PhysicsShapeHitWithUserData* hitStorage;
+    const int maxHitCount;
+    int hitCount = 0;
+
+    /// Only valid once the storage is full
+    int worstIndex = 0;
+    bool worstFound = false;
+
+    std::vector<LookupSlot>& lookup;
+    uint32_t lookupMask = 0;
+};
+
+} // namespace Thrive::Physics
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Jolt/Physics/Body/BodyManager.h"
+#include "Jolt/Physics/Collision/BroadPhase/BroadPhaseQuery.h"
+
+#include "core/NonCopyable.hpp"
+
+namespace Thrive::Physics
+{
+
+/// \brief Collects the bodies found by a broadphase query into a list. Stops the query once the list has maxBodies
+/// entries.
+class BodyIdCollector final : public JPH::CollideShapeBodyCollector, public NonCopyable
+{
+public:
+    BodyIdCollector(JPH::BodyIDVector& bodiesReceiver, size_t maxBodies) :
+        receiver(bodiesReceiver), maxCount(maxBodies)
+    {
+        if (maxCount < 1)
+            ForceEarlyOut();
+    }
+
+    void AddHit(const ResultType& inResult) override
+    {
+        receiver.push_back(inResult);
+
+        if (receiver.size() >= maxCount)
+            ForceEarlyOut();
+    }
+
+private:
+    JPH::BodyIDVector& receiver;
+    const size_t maxCount;
+};
+
+} // namespace Thrive::Physics
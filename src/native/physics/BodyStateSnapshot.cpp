@@ -0,0 +1,117 @@
+// ------------------------------------ //
+#include "BodyStateSnapshot.hpp"
+
+#include "Jolt/Physics/PhysicsSystem.h"
+
+#include "Include.h"
+
+// ------------------------------------ //
+namespace Thrive::Physics
+{
+
+BodyStateSnapshot::ReadAccess::ReadAccess(const BodyStateSnapshot& snapshot, int bufferIndex) noexcept :
+    snapshot(snapshot), bufferIndex(bufferIndex)
+{
+}
+
+BodyStateSnapshot::ReadAccess::~ReadAccess()
+{
+    snapshot.activeReaders[bufferIndex].fetch_sub(1, std::memory_order_release);
+}
+
+bool BodyStateSnapshot::ReadAccess::ReadBody(JPH::BodyID bodyId, BodyState& receiver) const noexcept
+{
+    const auto& buffer = snapshot.buffers[bufferIndex];
+
+    const auto index = bodyId.GetIndex();
+
+    if (index >= buffer.States.size()) [[unlikely]]
+        return false;
+
+    const auto& state = buffer.States[index];
+
+    if (state.Version != buffer.Version || state.ID != bodyId)
+        return false;
+
+    receiver = state;
+    return true;
+}
+
+// ------------------------------------ //
+BodyStateSnapshot::BodyStateSnapshot(unsigned int maxBodies)
+{
+    for (auto& buffer : buffers)
+    {
+        buffer.States.resize(maxBodies);
+    }
+}
+
+// ------------------------------------ //
+void BodyStateSnapshot::Write(const JPH::PhysicsSystem& physicsSystem)
+{
+    const auto target = 1 - publishedBuffer.load(std::memory_order_relaxed);
+
+    // Readers that started before the previous publish may still be reading this. Readers are short-lived so this
+    // doesn't need to sleep.
+    while (activeReaders[target].load(std::memory_order_seq_cst) > 0)
+    {
+        HYPER_THREAD_YIELD;
+    }
+
+    auto& buffer = buffers[target];
+
+    auto version = latestVersion.load(std::memory_order_relaxed) + 1;
+
+    // 0 is reserved for default initialized entries
+    if (version == 0) [[unlikely]]
+        version = 1;
+
+    buffer.Version = version;
+
+    // The body capacity of the world can grow
+    if (buffer.States.size() < physicsSystem.GetMaxBodies()) [[unlikely]]
+        buffer.States.resize(physicsSystem.GetMaxBodies());
+
+    physicsSystem.GetBodies(bodyIds);
+
+    // Nothing else is accessing the bodies between physics updates so there is no need to lock them
+    const auto& lockInterface = physicsSystem.GetBodyLockInterfaceNoLock();
+
+    for (const auto bodyId : bodyIds)
+    {
+        const auto* body = lockInterface.TryGetBody(bodyId);
+
+        if (body == nullptr) [[unlikely]]
+            continue;
+
+        auto& state = buffer.States[bodyId.GetIndex()];
+
+        state.Position = body->GetPosition();
+        state.Rotation = body->GetRotation();
+        state.Velocity = body->GetLinearVelocity();
+        state.AngularVelocity = body->GetAngularVelocity();
+        state.ID = bodyId;
+        state.Version = version;
+    }
+
+    latestVersion.store(version, std::memory_order_release);
+    publishedBuffer.store(target, std::memory_order_seq_cst);
+}
+
+BodyStateSnapshot::ReadAccess BodyStateSnapshot::BeginRead() const noexcept
+{
+    while (true)
+    {
+        const auto index = publishedBuffer.load(std::memory_order_seq_cst);
+
+        activeReaders[index].fetch_add(1, std::memory_order_seq_cst);
+
+        // If the buffer was swapped in between, the writer may already be overwriting the buffer, so try again
+        if (publishedBuffer.load(std::memory_order_seq_cst) == index) [[likely]]
+            return ReadAccess(*this, index);
+
+        activeReaders[index].fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace Thrive::Physics
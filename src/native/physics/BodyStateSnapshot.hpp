@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include "Jolt/Physics/Body/BodyManager.h"
+
+#include "core/NonCopyable.hpp"
+
+namespace JPH
+{
+class PhysicsSystem;
+} // namespace JPH
+
+namespace Thrive::Physics
+{
+
+/// \brief Double buffered copy of body transforms and velocities as they were at the end of the latest completed
+/// physics update
+///
+/// Reading doesn't touch Jolt at all, so the snapshot can be read while the next physics update is already running.
+/// Before overwriting the older buffer the writer waits for any readers that are still using it.
+class BodyStateSnapshot : public NonCopyable
+{
+public:
+    struct BodyState
+    {
+    public:
+        JPH::RVec3 Position;
+        JPH::Quat Rotation;
+        JPH::Vec3 Velocity;
+        JPH::Vec3 AngularVelocity;
+
+        /// Used to detect stale entries (removed bodies and reused body indexes)
+        JPH::BodyID ID;
+        uint32_t Version;
+    };
+
+    /// \brief Keeps one snapshot buffer from being overwritten while it exists
+    class ReadAccess : public NonCopyable
+    {
+        friend BodyStateSnapshot;
+
+    public:
+        ~ReadAccess();
+
+        /// \returns False if the body was not in the world when the snapshot was taken
+        bool ReadBody(JPH::BodyID bodyId, BodyState& receiver) const noexcept;
+
+    private:
+        ReadAccess(const BodyStateSnapshot& snapshot, int bufferIndex) noexcept;
+
+    private:
+        const BodyStateSnapshot& snapshot;
+        const int bufferIndex;
+    };
+
+private:
+    struct Buffer
+    {
+    public:
+        std::vector<BodyState> States;
+
+        /// Only entries with this version were written for this snapshot
+        uint32_t Version = 0;
+    };
+
+public:
+    explicit BodyStateSnapshot(unsigned int maxBodies);
+
+    /// \brief Copies the state of all bodies into the not currently visible buffer and then publishes it. Only one
+    /// thread may call this at once and not while the physics system is updating.
+    void Write(const JPH::PhysicsSystem& physicsSystem);
+
+    /// \brief Starts reading the latest published snapshot, that snapshot is kept intact while the returned object
+    /// is alive so it should be released quickly
+    [[nodiscard]] ReadAccess BeginRead() const noexcept;
+
+    [[nodiscard]] inline bool HasData() const noexcept
+    {
+        return latestVersion.load(std::memory_order_acquire) != 0;
+    }
+
+private:
+    std::array<Buffer, 2> buffers;
+
+    mutable std::array<std::atomic<int>, 2> activeReaders{};
+
+    /// Index of the buffer readers should use
+    std::atomic<int> publishedBuffer{0};
+
+    std::atomic<uint32_t> latestVersion{0};
+
+    /// Reused between writes to not allocate each time
+    JPH::BodyIDVector bodyIds;
+};
+
+} // namespace Thrive::Physics
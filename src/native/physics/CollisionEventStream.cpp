@@ -0,0 +1,134 @@
+// ------------------------------------ //
+#include "CollisionEventStream.hpp"
+
+#include <bit>
+
+// ------------------------------------ //
+namespace Thrive::Physics
+{
+
+CollisionEventStream::CollisionEventStream(uint32_t capacity) :
+    capacity(capacity), firstBodies(capacity), secondBodies(capacity), firstSubShapes(capacity),
+    secondSubShapes(capacity), penetrations(capacity), normals(static_cast<size_t>(capacity) * 3),
+    relativeNormalVelocities(capacity), flags(capacity),
+    mergeSlots(std::bit_ceil(std::max(capacity, 1U) * 2)), usedMergeSlots(mergeSlots.size()),
+    mergeHashShift(64 - std::countr_zero(static_cast<uint32_t>(mergeSlots.size())))
+{
+}
+
+// ------------------------------------ //
+void CollisionEventStream::Append(JPH::BodyID firstBody, JPH::BodyID secondBody, uint32_t firstSubShape,
+    uint32_t secondSubShape, float penetration, JPH::Vec3Arg normal, float relativeNormalVelocity,
+    uint8_t recordFlags) noexcept
+{
+    Write(firstBody, secondBody, firstSubShape, secondSubShape, penetration, normal, relativeNormalVelocity,
+        recordFlags);
+}
+
+void CollisionEventStream::AppendOrMerge(JPH::BodyID firstBody, JPH::BodyID secondBody, uint32_t firstSubShape,
+    uint32_t secondSubShape, float penetration, JPH::Vec3Arg normal, float relativeNormalVelocity,
+    uint8_t recordFlags) noexcept
+{
+    const uint64_t bodyPair = (static_cast<uint64_t>(firstBody.GetIndexAndSequenceNumber()) << 32) |
+        secondBody.GetIndexAndSequenceNumber();
+    const uint64_t subShapes = (static_cast<uint64_t>(firstSubShape) << 32) | secondSubShape;
+
+    const auto mask = static_cast<uint32_t>(mergeSlots.size() - 1);
+    auto slotIndex = static_cast<uint32_t>((bodyPair * 0x9E3779B97F4A7C15ull) >> mergeHashShift);
+
+    for (size_t probes = 0; probes < mergeSlots.size(); ++probes)
+    {
+        auto& slot = mergeSlots[slotIndex];
+
+        uint64_t existingPair = slot.BodyPair.load(std::memory_order_acquire);
+
+        if (existingPair == 0)
+        {
+            if (slot.BodyPair.compare_exchange_strong(
+                    existingPair, bodyPair, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                usedMergeSlots[usedMergeSlotCount.fetch_add(1, std::memory_order_relaxed)] = slotIndex;
+
+                const auto index = Write(firstBody, secondBody, firstSubShape, secondSubShape, penetration, normal,
+                    relativeNormalVelocity, recordFlags);
+
+                slot.SubShapes = subShapes;
+
+                // When out of space the slot is kept with an invalid index so that the same contact is not retried
+                slot.RecordIndex = index;
+                return;
+            }
+
+            // Another thread claimed this slot first (for a different body pair), keep looking
+        }
+
+        if (existingPair == bodyPair && slot.SubShapes == subShapes)
+        {
+            const auto index = slot.RecordIndex;
+
+            if (index >= capacity) [[unlikely]]
+                return;
+
+            // Keep the strongest values of the merged records, like the per-body collision recording does
+            if (penetration >= penetrations[index])
+            {
+                penetrations[index] = penetration;
+                normal.StoreFloat3(reinterpret_cast<JPH::Float3*>(&normals[static_cast<size_t>(index) * 3]));
+            }
+
+            relativeNormalVelocities[index] = std::max(relativeNormalVelocities[index], relativeNormalVelocity);
+            flags[index] |= recordFlags;
+            return;
+        }
+
+        slotIndex = (slotIndex + 1) & mask;
+    }
+
+    // Table is full (this can only happen once the stream is also full)
+    Write(firstBody, secondBody, firstSubShape, secondSubShape, penetration, normal, relativeNormalVelocity,
+        recordFlags);
+}
+
+uint32_t CollisionEventStream::Write(JPH::BodyID firstBody, JPH::BodyID secondBody, uint32_t firstSubShape,
+    uint32_t secondSubShape, float penetration, JPH::Vec3Arg normal, float relativeNormalVelocity,
+    uint8_t recordFlags) noexcept
+{
+    const auto index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+
+    // Out of space, the count of dropped records can be read from the write index
+    if (index >= capacity) [[unlikely]]
+        return capacity;
+
+    firstBodies[index] = firstBody.GetIndexAndSequenceNumber();
+    secondBodies[index] = secondBody.GetIndexAndSequenceNumber();
+    firstSubShapes[index] = firstSubShape;
+    secondSubShapes[index] = secondSubShape;
+    penetrations[index] = penetration;
+    normal.StoreFloat3(reinterpret_cast<JPH::Float3*>(&normals[static_cast<size_t>(index) * 3]));
+    relativeNormalVelocities[index] = relativeNormalVelocity;
+    flags[index] = recordFlags;
+    return index;
+}
+
+void CollisionEventStream::AppendEnded(
+    JPH::BodyID firstBody, JPH::BodyID secondBody, uint32_t firstSubShape, uint32_t secondSubShape) noexcept
+{
+    Append(firstBody, secondBody, firstSubShape, secondSubShape, 0, JPH::Vec3::sZero(), 0, FLAG_ENDED);
+}
+
+void CollisionEventStream::Clear() noexcept
+{
+    writeIndex.store(0, std::memory_order_release);
+
+    // Only the used merge slots need to be freed
+    const auto usedSlots = usedMergeSlotCount.load(std::memory_order_acquire);
+
+    for (uint32_t i = 0; i < usedSlots; ++i)
+    {
+        mergeSlots[usedMergeSlots[i]].BodyPair.store(0, std::memory_order_relaxed);
+    }
+
+    usedMergeSlotCount.store(0, std::memory_order_release);
+}
+
+} // namespace Thrive::Physics
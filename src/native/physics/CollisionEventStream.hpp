@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "Jolt/Jolt.h"
+#include "Jolt/Physics/Body/BodyID.h"
+
+#include "core/NonCopyable.hpp"
+
+namespace Thrive::Physics
+{
+
+/// \brief World-level stream of compact collision records stored as separate arrays (struct of arrays)
+///
+/// This is an alternative to each recording body having its own PhysicsCollision array. All contacts in the world are
+/// appended here from the contact listener threads, so reading this needs just one pointer and count per field
+/// instead of checking each body. Records are only valid to read between physics updates.
+class CollisionEventStream : public NonCopyable
+{
+public:
+    /// Set when this is the first physics update the contact appeared
+    static constexpr uint8_t FLAG_JUST_STARTED = 1;
+
+    /// Set when the contact stopped existing. These records don't have penetration, normal or velocity info.
+    static constexpr uint8_t FLAG_ENDED = 2;
+
+public:
+    explicit CollisionEventStream(uint32_t capacity);
+
+    /// \brief Appends a record, safe to call from multiple threads at once. Record is dropped if out of space.
+    void Append(JPH::BodyID firstBody, JPH::BodyID secondBody, uint32_t firstSubShape, uint32_t secondSubShape,
+        float penetration, JPH::Vec3Arg normal, float relativeNormalVelocity, uint8_t recordFlags) noexcept;
+
+    /// \brief Appends a record or merges it into an earlier record of the same contact since the last clear. Used when
+    /// multiple physics steps are combined so that persisted contacts don't appear once per step. Safe to call from
+    /// multiple threads at once as long as each body pair is only reported by one thread at a time (which Jolt does).
+    void AppendOrMerge(JPH::BodyID firstBody, JPH::BodyID secondBody, uint32_t firstSubShape, uint32_t secondSubShape,
+        float penetration, JPH::Vec3Arg normal, float relativeNormalVelocity, uint8_t recordFlags) noexcept;
+
+    /// \brief Appends a contact end record, safe to call from multiple threads at once
+    void AppendEnded(
+        JPH::BodyID firstBody, JPH::BodyID secondBody, uint32_t firstSubShape, uint32_t secondSubShape) noexcept;
+
+    /// \brief Clears all records, may not be called while anything is appending
+    void Clear() noexcept;
+
+    [[nodiscard]] inline uint32_t GetCount() const noexcept
+    {
+        return std::min(writeIndex.load(std::memory_order_acquire), capacity);
+    }
+
+    /// \returns How many records didn't fit since the last clear
+    [[nodiscard]] inline uint32_t GetDroppedCount() const noexcept
+    {
+        const auto written = writeIndex.load(std::memory_order_acquire);
+        return written > capacity ? written - capacity : 0;
+    }
+
+    [[nodiscard]] inline uint32_t GetCapacity() const noexcept
+    {
+        return capacity;
+    }
+
+    [[nodiscard]] inline const uint32_t* GetFirstBodies() const noexcept
+    {
+        return firstBodies.data();
+    }
+
+    [[nodiscard]] inline const uint32_t* GetSecondBodies() const noexcept
+    {
+        return secondBodies.data();
+    }
+
+    [[nodiscard]] inline const uint32_t* GetFirstSubShapes() const noexcept
+    {
+        return firstSubShapes.data();
+    }
+
+    [[nodiscard]] inline const uint32_t* GetSecondSubShapes() const noexcept
+    {
+        return secondSubShapes.data();
+    }
+
+    [[nodiscard]] inline const float* GetPenetrations() const noexcept
+    {
+        return penetrations.data();
+    }
+
+    /// \returns Contact normals as 3 floats per record, the normal points from the first body towards the second
+    [[nodiscard]] inline const float* GetNormals() const noexcept
+    {
+        return normals.data();
+    }
+
+    [[nodiscard]] inline const float* GetRelativeNormalVelocities() const noexcept
+    {
+        return relativeNormalVelocities.data();
+    }
+
+    [[nodiscard]] inline const uint8_t* GetFlags() const noexcept
+    {
+        return flags.data();
+    }
+
+private:
+    /// Slot in the table used to find existing records of contacts for merging
+    struct MergeSlot
+    {
+        /// Both body IDs combined, 0 when the slot is free (the second body ID is never 0 as it is the higher ID)
+        std::atomic<uint64_t> BodyPair{0};
+
+        // These are only accessed by the thread that handles the body pair in the key so these don't need to be atomic
+        uint64_t SubShapes = 0;
+        uint32_t RecordIndex = 0;
+    };
+
+    /// \returns The index of a new record with all fields written, or capacity if out of space
+    uint32_t Write(JPH::BodyID firstBody, JPH::BodyID secondBody, uint32_t firstSubShape, uint32_t secondSubShape,
+        float penetration, JPH::Vec3Arg normal, float relativeNormalVelocity, uint8_t recordFlags) noexcept;
+
+private:
+    const uint32_t capacity;
+
+    /// Threads reserve the index to write to by incrementing this, can go past capacity when records are dropped
+    std::atomic<uint32_t> writeIndex{0};
+
+    std::vector<uint32_t> firstBodies;
+    std::vector<uint32_t> secondBodies;
+    std::vector<uint32_t> firstSubShapes;
+    std::vector<uint32_t> secondSubShapes;
+    std::vector<float> penetrations;
+    std::vector<float> normals;
+    std::vector<float> relativeNormalVelocities;
+    std::vector<uint8_t> flags;
+
+    /// Open addressing table from contacts to record index, only used by AppendOrMerge
+    std::vector<MergeSlot> mergeSlots;
+
+    /// Slots used in mergeSlots since the last clear so that the whole table doesn't need to be cleared each time
+    std::vector<uint32_t> usedMergeSlots;
+    std::atomic<uint32_t> usedMergeSlotCount{0};
+
+    int mergeHashShift;
+};
+
+} // namespace Thrive::Physics
@@ -0,0 +1,126 @@
+// ------------------------------------ //
+#include "CollisionIgnoreList.hpp"
+
+#include "PhysicsBody.hpp"
+
+// ------------------------------------ //
+namespace Thrive::Physics
+{
+
+bool CollisionIgnoreList::Add(JPH::BodyID bodyId, bool skipDuplicates) noexcept
+{
+    if (sortedIds.empty())
+    {
+        if (skipDuplicates && Contains(bodyId))
+            return false;
+
+        if (inlineCount < INLINE_CAPACITY) [[likely]]
+        {
+            inlineIds[inlineCount++] = bodyId;
+            return true;
+        }
+
+        // Out of inline space, all items need to move to the sorted storage
+        MoveToSorted();
+    }
+
+    const auto position = std::lower_bound(sortedIds.begin(), sortedIds.end(), bodyId);
+
+    if (skipDuplicates && position != sortedIds.end() && *position == bodyId)
+        return false;
+
+    sortedIds.insert(position, bodyId);
+    return true;
+}
+
+bool CollisionIgnoreList::Remove(JPH::BodyID bodyId) noexcept
+{
+    if (sortedIds.empty())
+    {
+        for (int i = 0; i < inlineCount; ++i)
+        {
+            if (inlineIds[i] == bodyId)
+            {
+                // Order doesn't matter in the inline storage
+                inlineIds[i] = inlineIds[--inlineCount];
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    const auto position = std::lower_bound(sortedIds.begin(), sortedIds.end(), bodyId);
+
+    if (position == sortedIds.end() || *position != bodyId)
+        return false;
+
+    sortedIds.erase(position);
+
+    // Switch back to the inline storage once everything fits there again
+    if (sortedIds.size() <= INLINE_CAPACITY)
+    {
+        inlineCount = static_cast<int>(sortedIds.size());
+        std::copy(sortedIds.begin(), sortedIds.end(), inlineIds.begin());
+        sortedIds.clear();
+    }
+
+    return true;
+}
+
+void CollisionIgnoreList::Set(PhysicsBody* const* bodies, int count) noexcept
+{
+    Clear();
+
+    if (bodies == nullptr || count <= 0)
+        return;
+
+    if (count <= INLINE_CAPACITY) [[likely]]
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (bodies[i] != nullptr)
+                inlineIds[inlineCount++] = bodies[i]->GetId();
+        }
+
+        return;
+    }
+
+    sortedIds.reserve(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (bodies[i] != nullptr)
+            sortedIds.emplace_back(bodies[i]->GetId());
+    }
+
+    std::sort(sortedIds.begin(), sortedIds.end());
+
+    // If a lot of nulls were skipped, the inline storage should be used
+    if (sortedIds.size() <= INLINE_CAPACITY) [[unlikely]]
+    {
+        inlineCount = static_cast<int>(sortedIds.size());
+        std::copy(sortedIds.begin(), sortedIds.end(), inlineIds.begin());
+        sortedIds.clear();
+    }
+}
+
+void CollisionIgnoreList::SetSingle(JPH::BodyID bodyId) noexcept
+{
+    Clear();
+
+    inlineIds[0] = bodyId;
+    inlineCount = 1;
+}
+
+// ------------------------------------ //
+void CollisionIgnoreList::MoveToSorted() noexcept
+{
+    sortedIds.reserve(INLINE_CAPACITY * 2);
+    sortedIds.assign(inlineIds.begin(), inlineIds.begin() + inlineCount);
+    std::sort(sortedIds.begin(), sortedIds.end());
+
+    inlineCount = 0;
+}
+
+} // namespace Thrive::Physics
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "Jolt/Jolt.h"
+#include "Jolt/Physics/Body/BodyID.h"
+
+#include "Include.h"
+
+#ifdef USE_SMALL_VECTOR_POOLS
+#include "boost/pool/pool_alloc.hpp"
+#endif
+
+namespace Thrive::Physics
+{
+
+class PhysicsBody;
+
+#ifdef USE_SMALL_VECTOR_POOLS
+using IgnoredCollisionList = std::vector<JPH::BodyID, boost::pool_allocator<JPH::BodyID>>;
+#else
+using IgnoredCollisionList = std::vector<JPH::BodyID>;
+#endif
+
+/// \brief List of bodies to ignore collisions with that adapts to its size
+///
+/// Small lists (the common case) are stored inline and searched linearly. Once there are more items than fit inline
+/// (for example a large colony ignoring all of its members), the items are kept in a sorted vector that is binary
+/// searched so collision validation doesn't slow down linearly with the number of ignores.
+class CollisionIgnoreList
+{
+public:
+    static constexpr int INLINE_CAPACITY = 8;
+
+public:
+    [[nodiscard]] inline bool Contains(JPH::BodyID bodyId) const noexcept
+    {
+        if (sortedIds.empty()) [[likely]]
+        {
+            for (int i = 0; i < inlineCount; ++i)
+            {
+                if (inlineIds[i] == bodyId)
+                    return true;
+            }
+
+            return false;
+        }
+
+        return std::binary_search(sortedIds.begin(), sortedIds.end(), bodyId);
+    }
+
+    /// \returns False if skipDuplicates is true and the body was already in the list
+    bool Add(JPH::BodyID bodyId, bool skipDuplicates) noexcept;
+
+    /// \returns True when removed, false if the body was not in the list
+    bool Remove(JPH::BodyID bodyId) noexcept;
+
+    /// \brief Replaces all items with the given bodies. This sorts only once so this is much faster than adding the
+    /// items one by one for big lists. Null pointers are skipped.
+    void Set(PhysicsBody* const* bodies, int count) noexcept;
+
+    void SetSingle(JPH::BodyID bodyId) noexcept;
+
+    inline void Clear() noexcept
+    {
+        inlineCount = 0;
+        sortedIds.clear();
+    }
+
+    [[nodiscard]] inline size_t GetCount() const noexcept
+    {
+        return sortedIds.empty() ? static_cast<size_t>(inlineCount) : sortedIds.size();
+    }
+
+private:
+    void MoveToSorted() noexcept;
+
+private:
+    std::array<JPH::BodyID, INLINE_CAPACITY> inlineIds;
+    int inlineCount = 0;
+
+    /// When this is not empty this contains all the items (and they are sorted) and the inline ids are not used
+    IgnoredCollisionList sortedIds;
+};
+
+} // namespace Thrive::Physics
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+
+#include "core/NonCopyable.hpp"
+
+namespace Thrive::Physics
+{
+
+class PhysicsBody;
+
+/// \brief Small open addressing hash table from the other body in a collision to the index of the recorded collision
+///
+/// Used by PhysicsBody to find an already recorded collision with a body in constant time when collisions are
+/// persisted. Slots are claimed with atomic operations so this works without locks from the contact listener threads.
+/// The table is only cleared between physics steps.
+class CollisionRecordLookup : public NonCopyable
+{
+public:
+    /// Record index of a slot that has been claimed but doesn't have its record reserved yet
+    static constexpr int32_t PENDING_RECORD = -1;
+
+    /// Record index of a slot whose collision didn't fit in the recording array
+    static constexpr int32_t NO_RECORD = -2;
+
+private:
+    struct Slot
+    {
+        std::atomic<const PhysicsBody*> Key{nullptr};
+        std::atomic<int32_t> RecordIndex{PENDING_RECORD};
+    };
+
+public:
+    CollisionRecordLookup() = default;
+
+    /// \brief Allocates the table for the given max record count and empties it, must not be called while a step is
+    /// running
+    void Resize(int maxRecords)
+    {
+        if (maxRecords <= 0)
+        {
+            Release();
+            return;
+        }
+
+        // Keeping the load factor at most half keeps the probe sequences short
+        const auto wantedSize = std::bit_ceil(static_cast<uint32_t>(maxRecords) * 2);
+
+        if (wantedSize != slotCount)
+        {
+            // New slots start out empty
+            slots = std::make_unique<Slot[]>(wantedSize);
+            slotCount = wantedSize;
+            hashShift = 64 - std::countr_zero(wantedSize);
+            return;
+        }
+
+        Clear();
+    }
+
+    void Release() noexcept
+    {
+        slots.reset();
+        slotCount = 0;
+    }
+
+    /// \brief Empties all slots, must not be called while anything may be recording
+    void Clear() noexcept
+    {
+        for (uint32_t i = 0; i < slotCount; ++i)
+        {
+            slots[i].Key.store(nullptr, std::memory_order_relaxed);
+            slots[i].RecordIndex.store(PENDING_RECORD, std::memory_order_relaxed);
+        }
+    }
+
+    /// \brief Looks up the record for a body or claims a slot for it
+    /// \param claimedSlot Set to the claimed slot index when the caller needs to reserve a new record and report it
+    /// with SetRecordIndex, or -1 if no slot was claimed (table is full or the key was not usable)
+    /// \returns Index of the existing record or a negative value if there isn't a usable existing record
+    int32_t FindOrClaim(const PhysicsBody* otherBody, int32_t& claimedSlot) noexcept
+    {
+        claimedSlot = -1;
+
+        if (slotCount == 0 || otherBody == nullptr) [[unlikely]]
+            return PENDING_RECORD;
+
+        const auto mask = slotCount - 1;
+        auto index = Hash(otherBody);
+
+        for (uint32_t probes = 0; probes < slotCount; ++probes)
+        {
+            auto& slot = slots[index];
+
+            const PhysicsBody* existingKey = slot.Key.load(std::memory_order_acquire);
+
+            if (existingKey == nullptr)
+            {
+                if (slot.Key.compare_exchange_strong(
+                        existingKey, otherBody, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    claimedSlot = static_cast<int32_t>(index);
+                    return PENDING_RECORD;
+                }
+
+                // Someone else claimed this slot first, check if it was for the same body
+            }
+
+            if (existingKey == otherBody)
+            {
+                // Jolt handles each body pair on a single thread so this shouldn't see a pending record in practice,
+                // if it does the caller just records a duplicate like the linear search used to do in that case
+                return slot.RecordIndex.load(std::memory_order_acquire);
+            }
+
+            index = (index + 1) & mask;
+        }
+
+        return PENDING_RECORD;
+    }
+
+    void SetRecordIndex(int32_t claimedSlot, int32_t recordIndex) noexcept
+    {
+        slots[claimedSlot].RecordIndex.store(recordIndex, std::memory_order_release);
+    }
+
+private:
+    [[nodiscard]] inline uint32_t Hash(const PhysicsBody* key) const noexcept
+    {
+        // Fibonacci hashing, the low bits of the pointer are always zero due to alignment so the high bits of the
+        // product are used
+        return static_cast<uint32_t>(
+            (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key)) * 0x9E3779B97F4A7C15ull) >> hashShift);
+    }
+
+private:
+    std::unique_ptr<Slot[]> slots;
+    uint32_t slotCount = 0;
+    int hashShift = 64;
+};
+
+} // namespace Thrive::Physics
@@ -2,6 +2,7 @@
 #include "ContactListener.hpp"
 
 #include "Jolt/Physics/Body/Body.h"
+#include "Jolt/Physics/Body/BodyLockInterface.h"
 #include "Jolt/Physics/Collision/CollideShape.h"
 #include "Jolt/Physics/Collision/Shape/CompoundShape.h"
 #include "Jolt/Physics/Collision/Shape/SubShapeID.h"
@@ -29,6 +30,37 @@ FORCE_INLINE float PreprocessPenetrationDepth(float penetration)
     return std::abs(penetration);
 }
 
+/// \brief Calculates how fast the bodies are moving towards each other along the contact normal at the first contact
+/// point (positive when approaching). The bodies are locked by Jolt while contact callbacks run.
+inline float CalculateRelativeNormalVelocity(
+    const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold)
+{
+    if (manifold.mRelativeContactPointsOn1.empty()) [[unlikely]]
+        return 0;
+
+    const auto velocity1 = body1.GetPointVelocity(manifold.GetWorldSpaceContactPointOn1(0));
+    const auto velocity2 = body2.GetPointVelocity(manifold.GetWorldSpaceContactPointOn2(0));
+
+    // The manifold normal points from body 1 towards body 2
+    return (velocity1 - velocity2).Dot(manifold.mWorldSpaceNormal);
+}
+
+inline void WriteContactNormal(PhysicsCollision& collision, JPH::Vec3Arg normal, bool swapOrder)
+{
+    // The recorded normal always points away from the first body, so it needs flipping when the order is swapped
+    const auto orientedNormal = swapOrder ? -normal : normal;
+
+#ifdef USE_ATOMIC_COLLISION_WRITE
+    // Each component is written atomically, when there are multiple writers at once the result may mix the
+    // components but the normals of one body pair are all similar anyway
+    std::atomic_ref<float>{collision.ContactNormal[0]}.store(orientedNormal.GetX(), std::memory_order::relaxed);
+    std::atomic_ref<float>{collision.ContactNormal[1]}.store(orientedNormal.GetY(), std::memory_order::relaxed);
+    std::atomic_ref<float>{collision.ContactNormal[2]}.store(orientedNormal.GetZ(), std::memory_order::relaxed);
+#else
+    collision.ContactNormal = {orientedNormal.GetX(), orientedNormal.GetY(), orientedNormal.GetZ()};
+#endif
+}
+
 inline void PrepareBasicCollisionInfo(PhysicsCollision& collision, const PhysicsBody* body1, const PhysicsBody* body2)
 {
     collision.FirstBody = body1;
@@ -67,15 +99,19 @@ inline void ClearUnknownDataForCollisionFilter(PhysicsCollision& collision)
     collision.FirstSubShapeData = COLLISION_UNKNOWN_SUB_SHAPE;
     collision.SecondSubShapeData = COLLISION_UNKNOWN_SUB_SHAPE;
     collision.PenetrationAmount = -1;
+    collision.RelativeNormalVelocity = 0;
+    collision.ContactNormal = {0, 0, 0};
+    collision.Ended = false;
 }
 
 #ifdef AUTO_RESOLVE_FIRST_LEVEL_SHAPE_INDEX
 inline void PrepareCollisionInfoFromManifold(PhysicsCollision& collision, const PhysicsBody* body1,
     const JPH::Body& joltBody1, const PhysicsBody* body2, const JPH::Body& joltBody2,
-    const JPH::ContactManifold& manifold, bool justStarted, bool swapOrder)
+    const JPH::ContactManifold& manifold, float relativeNormalVelocity, bool justStarted, bool swapOrder)
 #else
 inline void PrepareCollisionInfoFromManifold(PhysicsCollision& collision, const PhysicsBody* body1,
-    const PhysicsBody* body2, const JPH::ContactManifold& manifold, bool justStarted, bool swapOrder)
+    const PhysicsBody* body2, const JPH::ContactManifold& manifold, float relativeNormalVelocity, bool justStarted,
+    bool swapOrder)
 #endif
 {
     if (swapOrder)
@@ -111,7 +147,13 @@ inline void PrepareCollisionInfoFromManifold(PhysicsCollision& collision, const
     }
 #endif
 
+    // Velocity doesn't depend on the order as both the normal and the velocity difference flip
+    WriteContactNormal(collision, manifold.mWorldSpaceNormal, swapOrder);
+
 #ifdef USE_ATOMIC_COLLISION_WRITE
+    std::atomic_ref<float>{collision.RelativeNormalVelocity}.store(relativeNormalVelocity, std::memory_order::relaxed);
+    std::atomic_ref<bool>{collision.Ended}.store(false, std::memory_order::relaxed);
+
     const std::atomic_ref<float> penetrationAtomic{collision.PenetrationAmount};
 
     penetrationAtomic.store(PreprocessPenetrationDepth(manifold.mPenetrationDepth), std::memory_order::release);
@@ -119,6 +161,9 @@ inline void PrepareCollisionInfoFromManifold(PhysicsCollision& collision, const
     const std::atomic_ref<bool> startedAtomic{collision.JustStarted};
     startedAtomic.store(justStarted, std::memory_order::release);
 #else
+    collision.RelativeNormalVelocity = relativeNormalVelocity;
+    collision.Ended = false;
+
     collision.PenetrationAmount = PreprocessPenetrationDepth(manifold.mPenetrationDepth);
 
     collision.JustStarted = justStarted;
@@ -127,8 +172,8 @@ inline void PrepareCollisionInfoFromManifold(PhysicsCollision& collision, const
 
 /// \brief Updates just the properties of the collision that can change (i.e. collision entity IDs should have been set
 /// before as this will not touch them)
-inline void UpdateCollisionInfoFromManifold(
-    PhysicsCollision& collision, const JPH::ContactManifold& manifold, bool justStarted)
+inline void UpdateCollisionInfoFromManifold(PhysicsCollision& collision, const JPH::ContactManifold& manifold,
+    float relativeNormalVelocity, bool justStarted, bool swapOrder)
 {
     // Just started status is written on top of the previous data if this
     if (justStarted)
@@ -141,17 +186,43 @@ inline void UpdateCollisionInfoFromManifold(
 #endif
     }
 
-    // Keep the highest penetration of the merged collisions
+    // Keep the highest penetration and impact speed of the merged collisions. The normal is taken from the deepest
+    // contact. Multiple sub-shape contacts of the same body pair can be handled on different threads at once.
+    const auto penetration = PreprocessPenetrationDepth(manifold.mPenetrationDepth);
 
 #ifdef USE_ATOMIC_COLLISION_WRITE
+    // A contact can continue in the same merged update it ended in
+    std::atomic_ref<bool>{collision.Ended}.store(false, std::memory_order::relaxed);
+
+    const std::atomic_ref<float> velocityAtomic{collision.RelativeNormalVelocity};
+
+    auto previousVelocity = velocityAtomic.load(std::memory_order::relaxed);
+    while (relativeNormalVelocity > previousVelocity &&
+        !velocityAtomic.compare_exchange_weak(previousVelocity, relativeNormalVelocity, std::memory_order::relaxed))
+    {
+    }
+
     const std::atomic_ref<float> penetrationAtomic{collision.PenetrationAmount};
 
-    penetrationAtomic.store(std::max(PreprocessPenetrationDepth(manifold.mPenetrationDepth),
-                                penetrationAtomic.load(std::memory_order::acquire)),
-        std::memory_order::release);
+    auto previousPenetration = penetrationAtomic.load(std::memory_order::acquire);
+    while (penetration >= previousPenetration)
+    {
+        if (penetrationAtomic.compare_exchange_weak(previousPenetration, penetration, std::memory_order::acq_rel))
+        {
+            WriteContactNormal(collision, manifold.mWorldSpaceNormal, swapOrder);
+            break;
+        }
+    }
 #else
-    collision.PenetrationAmount =
-        std::max(PreprocessPenetrationDepth(manifold.mPenetrationDepth), collision.PenetrationAmount);
+    collision.Ended = false;
+
+    collision.RelativeNormalVelocity = std::max(relativeNormalVelocity, collision.RelativeNormalVelocity);
+
+    if (penetration >= collision.PenetrationAmount)
+    {
+        WriteContactNormal(collision, manifold.mWorldSpaceNormal, swapOrder);
+        collision.PenetrationAmount = penetration;
+    }
 #endif
 }
 
@@ -194,6 +265,13 @@ JPH::ValidateResult ContactListener::OnContactValidate(const JPH::Body& body1, c
             {
                 disallow = true;
             }
+            else if (body1Object != nullptr && body2Object != nullptr &&
+                !PhysicsBody::CollisionGroupsAllowCollision(*body1Object, *body2Object))
+            {
+                // Group filtering is checked first as it is the cheapest and doesn't need to call the user callbacks.
+                // Only one of the bodies may have the filter flag, so both wrappers need to be checked to exist.
+                disallow = true;
+            }
             else if (body1UsesFilter)
             {
                 // Filter based on custom filter callback if defined
@@ -291,14 +369,20 @@ void ContactListener::OnContactAdded(const JPH::Body& body1, const JPH::Body& bo
     }
 #endif
 
-    // TODO: should relative velocities be stored somehow here? The Jolt documentation mentions that can be used to
-    // determine how hard the collision is
-
     // Recording collisions (we record the start as only on the next update does the persisted connection trigger,
     // and well there are some potential gameplay uses for the initial collision flag)
     const auto userData1 = body1.GetUserData();
     const auto userData2 = body2.GetUserData();
 
+    // Relative velocity is what tells how hard the collision is, only calculated when something records it
+    float relativeNormalVelocity = 0;
+
+    if (eventStream != nullptr || (userData1 | userData2) & PHYSICS_BODY_RECORDING_FLAG)
+        relativeNormalVelocity = CalculateRelativeNormalVelocity(body1, body2, manifold);
+
+    if (eventStream != nullptr)
+        RecordCollisionEvent(body1, body2, manifold, relativeNormalVelocity, true);
+
     if (userData1 & PHYSICS_BODY_RECORDING_FLAG)
     {
         const auto body1Object = PhysicsBody::FromJoltBody(userData1);
@@ -320,7 +404,7 @@ void ContactListener::OnContactAdded(const JPH::Body& body1, const JPH::Body& bo
 
             if (existing)
             {
-                UpdateCollisionInfoFromManifold(*writeTarget, manifold, true);
+                UpdateCollisionInfoFromManifold(*writeTarget, manifold, relativeNormalVelocity, true, false);
 
                 // Feels a bit dirty to use a goto but this seems about the cleanest way to early exit from here
                 // without splitting this into multiple methods
@@ -334,9 +418,10 @@ void ContactListener::OnContactAdded(const JPH::Body& body1, const JPH::Body& bo
         {
 #ifdef AUTO_RESOLVE_FIRST_LEVEL_SHAPE_INDEX
             PrepareCollisionInfoFromManifold(
-                *writeTarget, body1Object, body1, body2Object, body2, manifold, true, false);
+                *writeTarget, body1Object, body1, body2Object, body2, manifold, relativeNormalVelocity, true, false);
 #else
-            PrepareCollisionInfoFromManifold(*writeTarget, body1Object, body2Object, manifold, true, false);
+            PrepareCollisionInfoFromManifold(
+                *writeTarget, body1Object, body2Object, manifold, relativeNormalVelocity, true, false);
 #endif
         }
     }
@@ -361,7 +446,7 @@ object1HandlingEnd:
 
             if (existing)
             {
-                UpdateCollisionInfoFromManifold(*writeTarget, manifold, true);
+                UpdateCollisionInfoFromManifold(*writeTarget, manifold, relativeNormalVelocity, true, true);
 
                 goto object2HandlingEnd;
             }
@@ -371,9 +456,10 @@ object1HandlingEnd:
         {
 #ifdef AUTO_RESOLVE_FIRST_LEVEL_SHAPE_INDEX
             PrepareCollisionInfoFromManifold(
-                *writeTarget, body1Object, body1, body2Object, body2, manifold, true, true);
+                *writeTarget, body1Object, body1, body2Object, body2, manifold, relativeNormalVelocity, true, true);
 #else
-            PrepareCollisionInfoFromManifold(*writeTarget, body1Object, body2Object, manifold, true, true);
+            PrepareCollisionInfoFromManifold(
+                *writeTarget, body1Object, body2Object, manifold, relativeNormalVelocity, true, true);
 #endif
         }
     }
@@ -419,6 +505,14 @@ void ContactListener::OnContactPersisted(const JPH::Body& body1, const JPH::Body
     const auto userData1 = body1.GetUserData();
     const auto userData2 = body2.GetUserData();
 
+    float relativeNormalVelocity = 0;
+
+    if (eventStream != nullptr || (userData1 | userData2) & PHYSICS_BODY_RECORDING_FLAG)
+        relativeNormalVelocity = CalculateRelativeNormalVelocity(body1, body2, manifold);
+
+    if (eventStream != nullptr)
+        RecordCollisionEvent(body1, body2, manifold, relativeNormalVelocity, false);
+
     if (userData1 & PHYSICS_BODY_RECORDING_FLAG)
     {
         const auto body1Object = PhysicsBody::FromJoltBody(userData1);
@@ -437,7 +531,7 @@ void ContactListener::OnContactPersisted(const JPH::Body& body1, const JPH::Body
 
             if (existing)
             {
-                UpdateCollisionInfoFromManifold(*writeTarget, manifold, false);
+                UpdateCollisionInfoFromManifold(*writeTarget, manifold, relativeNormalVelocity, false, false);
 
                 goto object1HandlingEnd;
             }
@@ -447,10 +541,11 @@ void ContactListener::OnContactPersisted(const JPH::Body& body1, const JPH::Body
         {
 #ifdef AUTO_RESOLVE_FIRST_LEVEL_SHAPE_INDEX
             PrepareCollisionInfoFromManifold(
-                *writeTarget, body1Object, body1, body2Object, body2, manifold, false, false);
+                *writeTarget, body1Object, body1, body2Object, body2, manifold, relativeNormalVelocity, false, false);
 #else
 
-            PrepareCollisionInfoFromManifold(*writeTarget, body1Object, body2Object, manifold, false, false);
+            PrepareCollisionInfoFromManifold(
+                *writeTarget, body1Object, body2Object, manifold, relativeNormalVelocity, false, false);
 #endif
         }
     }
@@ -475,7 +570,7 @@ object1HandlingEnd:
 
             if (existing)
             {
-                UpdateCollisionInfoFromManifold(*writeTarget, manifold, false);
+                UpdateCollisionInfoFromManifold(*writeTarget, manifold, relativeNormalVelocity, false, true);
 
                 goto object2HandlingEnd;
             }
@@ -485,9 +580,10 @@ object1HandlingEnd:
         {
 #ifdef AUTO_RESOLVE_FIRST_LEVEL_SHAPE_INDEX
             PrepareCollisionInfoFromManifold(
-                *writeTarget, body1Object, body1, body2Object, body2, manifold, false, true);
+                *writeTarget, body1Object, body1, body2Object, body2, manifold, relativeNormalVelocity, false, true);
 #else
-            PrepareCollisionInfoFromManifold(*writeTarget, body1Object, body2Object, manifold, false, true);
+            PrepareCollisionInfoFromManifold(
+                *writeTarget, body1Object, body2Object, manifold, relativeNormalVelocity, false, true);
 #endif
         }
     }
@@ -518,9 +614,140 @@ void ContactListener::OnContactRemoved(const JPH::SubShapeIDPair& subShapePair)
         if (iter != currentCollisions.end())
             currentCollisions.erase(iter);
     }
+#endif
+
+    // The bodies may already be destroyed here so only the IDs are known. This also means sub-shapes can't be
+    // resolved and are always the raw values.
+    if (eventStream != nullptr)
+    {
+        eventStream->AppendEnded(subShapePair.GetBody1ID(), subShapePair.GetBody2ID(),
+            subShapePair.GetSubShapeID1().GetValue(), subShapePair.GetSubShapeID2().GetValue());
+    }
+
+    if (bodyLockInterface == nullptr) [[unlikely]]
+        return;
+
+    // Bodies can't be destroyed while physics runs, so if both still exist they can be used. When a body was destroyed
+    // the other body can't get an ended record as there is nothing to fill in the other body's info from.
+    const auto* body1 = bodyLockInterface->TryGetBody(subShapePair.GetBody1ID());
+    const auto* body2 = bodyLockInterface->TryGetBody(subShapePair.GetBody2ID());
+
+    if (body1 == nullptr || body2 == nullptr)
+        return;
+
+    if (body1->GetUserData() & PHYSICS_BODY_RECORDING_FLAG)
+        RecordEndedCollision(*body1, *body2, subShapePair, false);
+
+    if (body2->GetUserData() & PHYSICS_BODY_RECORDING_FLAG)
+        RecordEndedCollision(*body1, *body2, subShapePair, true);
+}
+
+// ------------------------------------ //
+void ContactListener::SetCollisionEventStreamCapacity(uint32_t capacity)
+{
+    if (capacity == 0)
+    {
+        eventStream.reset();
+        return;
+    }
+
+    if (eventStream != nullptr && eventStream->GetCapacity() == capacity)
+        return;
+
+    eventStream = std::make_unique<CollisionEventStream>(capacity);
+}
+
+void ContactListener::RecordEndedCollision(
+    const JPH::Body& body1, const JPH::Body& body2, const JPH::SubShapeIDPair& subShapePair, bool swapOrder)
+{
+    const auto body1Object = PhysicsBody::FromJoltBody(body1.GetUserData());
+    const auto body2Object = PhysicsBody::FromJoltBody(body2.GetUserData());
+
+    const auto recordingBody = swapOrder ? body2Object : body1Object;
+
+    if (!recordingBody->RecordsEndedCollisions())
+        return;
+
+    PhysicsCollision* writeTarget;
+
+    if (!persistCollisions)
+    {
+        writeTarget = recordingBody->GetNextCollisionRecordLocation(physicsStep);
+    }
+    else
+    {
+        // If there's already a record for the pair in this merged update, some contact between them was active so
+        // that is left as is. Only one of the sub-shape contacts between the bodies may have ended.
+        bool existing;
+        writeTarget = recordingBody->GetNextOrExistingCollisionRecordLocation(
+            physicsStep, swapOrder ? body1Object : body2Object, existing);
+
+        if (existing)
+            return;
+    }
+
+    if (writeTarget == nullptr) [[unlikely]]
+        return;
+
+    if (swapOrder)
+    {
+        PrepareBasicCollisionInfo(*writeTarget, body2Object, body1Object);
+    }
+    else
+    {
+        PrepareBasicCollisionInfo(*writeTarget, body1Object, body2Object);
+    }
+
+#ifdef AUTO_RESOLVE_FIRST_LEVEL_SHAPE_INDEX
+    const auto subShape1 = ResolveTopLevelSubShapeId(&body1, subShapePair.GetSubShapeID1());
+    const auto subShape2 = ResolveTopLevelSubShapeId(&body2, subShapePair.GetSubShapeID2());
 #else
-    UNUSED(subShapePair);
+    const auto subShape1 = subShapePair.GetSubShapeID1().GetValue();
+    const auto subShape2 = subShapePair.GetSubShapeID2().GetValue();
 #endif
+
+    writeTarget->FirstSubShapeData = swapOrder ? subShape2 : subShape1;
+    writeTarget->SecondSubShapeData = swapOrder ? subShape1 : subShape2;
+    writeTarget->RelativeNormalVelocity = 0;
+    writeTarget->ContactNormal = {0, 0, 0};
+
+#ifdef USE_ATOMIC_COLLISION_WRITE
+    std::atomic_ref<float>{writeTarget->PenetrationAmount}.store(0, std::memory_order::release);
+    std::atomic_ref<bool>{writeTarget->JustStarted}.store(false, std::memory_order::release);
+    std::atomic_ref<bool>{writeTarget->Ended}.store(true, std::memory_order::release);
+#else
+    writeTarget->PenetrationAmount = 0;
+    writeTarget->JustStarted = false;
+    writeTarget->Ended = true;
+#endif
+}
+
+void ContactListener::RecordCollisionEvent(const JPH::Body& body1, const JPH::Body& body2,
+    const JPH::ContactManifold& manifold, float relativeNormalVelocity, bool justStarted)
+{
+#ifdef AUTO_RESOLVE_FIRST_LEVEL_SHAPE_INDEX
+    const auto subShape1 = ResolveTopLevelSubShapeId(&body1, manifold.mSubShapeID1);
+    const auto subShape2 = ResolveTopLevelSubShapeId(&body2, manifold.mSubShapeID2);
+#else
+    const auto subShape1 = manifold.mSubShapeID1.GetValue();
+    const auto subShape2 = manifold.mSubShapeID2.GetValue();
+#endif
+
+    const auto penetration = PreprocessPenetrationDepth(manifold.mPenetrationDepth);
+    const uint8_t recordFlags = justStarted ? CollisionEventStream::FLAG_JUST_STARTED : 0;
+
+    // When steps are combined the same contact is reported on each step, so the records need to be merged like the
+    // per-body recordings to not have duplicates
+    if (persistCollisions)
+    {
+        eventStream->AppendOrMerge(body1.GetID(), body2.GetID(), subShape1, subShape2, penetration,
+            manifold.mWorldSpaceNormal, relativeNormalVelocity, recordFlags);
+    }
+    else
+    {
+        eventStream->Append(body1.GetID(), body2.GetID(), subShape1, subShape2, penetration,
+            manifold.mWorldSpaceNormal, relativeNormalVelocity, recordFlags);
+    }
 }
 
 // ------------------------------------ //
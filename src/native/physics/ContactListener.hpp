@@ -1,15 +1,20 @@
 #pragma once
 
+#include <memory>
+
 #include "Jolt/Physics/Collision/ContactListener.h"
 
 #include "core/Mutex.hpp"
 
+#include "CollisionEventStream.hpp"
+
 namespace JPH
 {
 #ifdef JPH_DEBUG_RENDERER
 class DebugRenderer;
 #endif
 
+class BodyLockInterface;
 class Shape;
 } // namespace JPH
 
@@ -41,6 +46,27 @@ public:
     {
         physicsStep = step;
         persistCollisions = persistExistingCollisions;
+
+        // Like the per-body recordings the event stream only contains the latest step unless steps are being merged
+        if (!persistExistingCollisions && eventStream != nullptr)
+            eventStream->Clear();
+    }
+
+    /// \brief Sets the interface used to find bodies when contacts end. Must be a non-locking interface as bodies are
+    /// already locked when Jolt reports the removed contacts.
+    inline void SetBodyLockInterface(const JPH::BodyLockInterface* noLockInterface) noexcept
+    {
+        bodyLockInterface = noLockInterface;
+    }
+
+    /// \brief Enables recording all contacts into a world-level event stream with the given capacity, 0 disables
+    /// the stream. May not be called while physics is running.
+    void SetCollisionEventStreamCapacity(uint32_t capacity);
+
+    /// \returns The event stream or null if not enabled
+    [[nodiscard]] inline const CollisionEventStream* GetCollisionEventStream() const noexcept
+    {
+        return eventStream.get();
     }
 
 #ifdef JPH_DEBUG_RENDERER
@@ -59,9 +85,21 @@ public:
     }
 #endif
 
+private:
+    void RecordCollisionEvent(const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold,
+        float relativeNormalVelocity, bool justStarted);
+
+    /// \brief Writes an ended collision record for body1 (or body2 if swapOrder is true) if it wants ended collisions
+    void RecordEndedCollision(const JPH::Body& body1, const JPH::Body& body2, const JPH::SubShapeIDPair& subShapePair,
+        bool swapOrder);
+
 private:
     Mutex currentCollisionsMutex;
 
+    std::unique_ptr<CollisionEventStream> eventStream;
+
+    const JPH::BodyLockInterface* bodyLockInterface = nullptr;
+
     // This is currently only necessary when debug drawing
 #ifdef JPH_DEBUG_RENDERER
     // TODO: JPH seems to use a custom allocator here so we might need to do so as well (for performance)
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Jolt/Physics/Body/BodyFilter.h"
+
+#include "CollisionIgnoreList.hpp"
+
+namespace Thrive::Physics
+{
+
+/// \brief Query filter that skips a list of bodies (for example the body doing the query). The body IDs are copied on
+/// construction so the list may be freed while this exists.
+class IgnoredBodiesFilter final : public JPH::BodyFilter
+{
+public:
+    IgnoredBodiesFilter(PhysicsBody* const* ignoredBodies, int count)
+    {
+        ignored.Set(ignoredBodies, count);
+    }
+
+    [[nodiscard]] bool ShouldCollide(const JPH::BodyID& bodyId) const override
+    {
+        return !ignored.Contains(bodyId);
+    }
+
+private:
+    CollisionIgnoreList ignored;
+};
+
+} // namespace Thrive::Physics
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <limits>
+
 #include "Jolt/Jolt.h"
 #include "Jolt/Physics/Collision/BroadPhase/BroadPhaseLayer.h"
 #include "Jolt/Physics/Collision/ObjectLayer.h"
@@ -19,6 +21,9 @@ static constexpr JPH::ObjectLayer DEBRIS = 2;
 static constexpr JPH::ObjectLayer SENSOR = 3;
 static constexpr JPH::ObjectLayer PROJECTILE = 4;
 static constexpr JPH::ObjectLayer NUM_LAYERS = 8;
+
+/// Used by queries to specify which layers they find, each layer has the bit (1 << layer) in the mask
+static constexpr uint32_t ALL_LAYERS_MASK = std::numeric_limits<uint32_t>::max();
 }; // namespace Layers
 
 /// \brief Configuration for which object layer types can collide with each other
@@ -141,4 +146,49 @@ public:
     }
 };
 
+/// \brief Query filter that accepts objects whose layer has its bit set in a layer mask
+class ObjectLayerMaskFilter final : public JPH::ObjectLayerFilter
+{
+public:
+    explicit ObjectLayerMaskFilter(uint32_t layerMask) : layerMask(layerMask)
+    {
+    }
+
+    [[nodiscard]] bool ShouldCollide(JPH::ObjectLayer layer) const override
+    {
+        return layer < 32 && (layerMask & (1U << layer)) != 0;
+    }
+
+private:
+    const uint32_t layerMask;
+};
+
+/// \brief Broadphase part of ObjectLayerMaskFilter, this skips entire broadphase layers that can't contain any of the
+/// object layers in the mask
+class BroadPhaseLayerMaskFilter final : public JPH::BroadPhaseLayerFilter
+{
+public:
+    explicit BroadPhaseLayerMaskFilter(uint32_t objectLayerMask)
+    {
+        BroadPhaseLayerInterface layerInterface;
+
+        for (JPH::ObjectLayer layer = 0; layer <= Layers::PROJECTILE; ++layer)
+        {
+            if ((objectLayerMask & (1U << layer)) == 0)
+                continue;
+
+            const auto broadPhaseLayer = layerInterface.GetBroadPhaseLayer(layer);
+            broadPhaseMask |= 1U << static_cast<JPH::BroadPhaseLayer::Type>(broadPhaseLayer);
+        }
+    }
+
+    [[nodiscard]] bool ShouldCollide(JPH::BroadPhaseLayer layer) const override
+    {
+        return (broadPhaseMask & (1U << static_cast<JPH::BroadPhaseLayer::Type>(layer))) != 0;
+    }
+
+private:
+    uint32_t broadPhaseMask = 0;
+};
+
 } // namespace Thrive::Physics
@@ -1,32 +1,48 @@
 // ------------------------------------ //
 #include "PhysicalWorld.hpp"
 
+#include <algorithm>
+#include <array>
+#include <condition_variable>
 #include <cstring>
 #include <fstream>
 
 #include "boost/circular_buffer.hpp"
+#include "Jolt/Core/HashCombine.h"
 #include "Jolt/Core/StreamWrapper.h"
+#include "Jolt/Geometry/AABox.h"
 #include "Jolt/Physics/Body/BodyCreationSettings.h"
 #include "Jolt/Physics/Collision/CastResult.h"
+#include "Jolt/Physics/Collision/CollideShape.h"
 #include "Jolt/Physics/Collision/RayCast.h"
+#include "Jolt/Physics/Collision/ShapeCast.h"
 #include "Jolt/Physics/Constraints/SixDOFConstraint.h"
+#include "Jolt/Physics/Constraints/TwoBodyConstraint.h"
 #include "Jolt/Physics/PhysicsScene.h"
 #include "Jolt/Physics/PhysicsSettings.h"
 #include "Jolt/Physics/PhysicsSystem.h"
+#include "Jolt/Physics/StateRecorderImpl.h"
 
+#include "core/IdleBackoff.hpp"
 #include "core/Math.hpp"
 #include "core/Mutex.hpp"
 #include "core/Spinlock.hpp"
+#include "core/TaskGroup.hpp"
 #include "core/TaskSystem.hpp"
 #include "core/Time.hpp"
 
 #include "ArrayRayCollector.hpp"
+#include "ArrayShapeHitCollector.hpp"
 #include "BodyActivationListener.hpp"
 #include "BodyControlState.hpp"
+#include "BodyIdCollector.hpp"
+#include "BodyStateSnapshot.hpp"
 #include "ContactListener.hpp"
+#include "IgnoredBodiesFilter.hpp"
 #include "PhysicsBody.hpp"
 #include "StepListener.hpp"
 #include "TrackedConstraint.hpp"
+#include "WorldStateEncoder.hpp"
 
 #ifdef JPH_DEBUG_RENDERER
 #include "DebugDrawForwarder.hpp"
@@ -204,12 +220,37 @@ public:
 
     Spinlock bodiesStepControlLock;
 
+    /// Copy of bodiesWithPerStepControl used while applying body control so that the lock isn't held during the
+    /// parallel section. Raw pointers to not touch reference counts each step, the bodies are kept alive by
+    /// bodiesWithPerStepControl as that can't be modified while physics is running.
+    std::vector<PhysicsBody*> stepControlSnapshot;
+
+    /// Bodies that body control needs activated, gathered from all of the threads applying body control
+    JPH::BodyIDVector bodyControlActivations;
+
+    Spinlock bodyControlActivationsLock;
+
     JPH::Vec3 gravity = JPH::Vec3(0, -9.81f, 0);
 
     std::vector<PhysicsBody*> activeBodiesWithCollisions;
 
     Spinlock activeBodyWriteLock;
 
+    /// Used to sleep the main thread if background physics simulation takes a long time
+    Mutex backgroundSimulationMutex;
+    std::condition_variable backgroundSimulationDone;
+
+    /// Only used by the main thread when waiting for the background simulation
+    IdleBackoff backgroundWaitBackoff;
+
+    /// Only exists when body snapshots are enabled
+    std::unique_ptr<BodyStateSnapshot> bodySnapshot;
+
+    WorldStateEncoder stateEncoder;
+
+    /// Kept to not allocate a new buffer each time a state is saved
+    std::vector<uint8_t> encodedState;
+
     uint32_t stepCounter = 0;
 
 #ifdef JPH_DEBUG_RENDERER
@@ -219,7 +260,14 @@ public:
 #endif
 };
 
-PhysicalWorld::PhysicalWorld() : pimpl(std::make_unique<Pimpl>())
+PhysicalWorld::PhysicalWorld() :
+    PhysicalWorld(DEFAULT_MAX_BODIES, DEFAULT_MAX_BODY_PAIRS, DEFAULT_MAX_CONTACT_CONSTRAINTS)
+{
+}
+
+PhysicalWorld::PhysicalWorld(unsigned int maxBodies, unsigned int maxBodyPairs, unsigned int maxContactConstraints) :
+    maxBodies(std::max(maxBodies, 1U)), maxBodyPairs(std::max(maxBodyPairs, 1U)),
+    maxContactConstraints(std::max(maxContactConstraints, 1U)), pimpl(std::make_unique<Pimpl>())
 {
 #ifdef USE_OBJECT_POOLS
     tempAllocator = std::make_unique<JPH::TempAllocatorImpl>(32 * 1024 * 1024);
@@ -235,10 +283,7 @@ PhysicalWorld::~PhysicalWorld()
     if (runningBackgroundSimulation)
     {
         LOG_ERROR("World is being destroyed while a background operation is in progress");
-        while (runningBackgroundSimulation)
-        {
-            HYPER_THREAD_YIELD;
-        }
+        WaitForBackgroundSimulationEnd();
     }
 
     if (bodyCount != 0)
@@ -251,25 +296,34 @@ PhysicalWorld::~PhysicalWorld()
 // ------------------------------------ //
 void PhysicalWorld::InitPhysicsWorld()
 {
-    physicsSystem = std::make_unique<JPH::PhysicsSystem>();
-    physicsSystem->Init(maxBodies, maxBodyMutexes, maxBodyPairs, maxContactConstraints, pimpl->broadPhaseLayer,
-        pimpl->objectToBroadPhaseLayer, pimpl->objectToObjectPair);
-    physicsSystem->SetPhysicsSettings(pimpl->physicsSettings);
-
-    physicsSystem->SetGravity(pimpl->gravity);
-
     // Contact listening
     contactListener = std::make_unique<ContactListener>();
 
     // contactListener->SetNextListener(something);
-    physicsSystem->SetContactListener(contactListener.get());
 
     // Activation listening
     activationListener = std::make_unique<BodyActivationListener>();
-    physicsSystem->SetBodyActivationListener(activationListener.get());
 
     stepListener = std::make_unique<StepListener>(*this);
-    physicsSystem->AddStepListener(stepListener.get());
+
+    physicsSystem = CreatePhysicsSystem();
+}
+
+std::unique_ptr<JPH::PhysicsSystem> PhysicalWorld::CreatePhysicsSystem()
+{
+    auto system = std::make_unique<JPH::PhysicsSystem>();
+    system->Init(maxBodies, maxBodyMutexes, maxBodyPairs, maxContactConstraints, pimpl->broadPhaseLayer,
+        pimpl->objectToBroadPhaseLayer, pimpl->objectToObjectPair);
+    system->SetPhysicsSettings(pimpl->physicsSettings);
+
+    system->SetGravity(pimpl->gravity);
+
+    system->SetContactListener(contactListener.get());
+    contactListener->SetBodyLockInterface(&system->GetBodyLockInterfaceNoLock());
+    system->SetBodyActivationListener(activationListener.get());
+    system->AddStepListener(stepListener.get());
+
+    return system;
 }
 
 // ------------------------------------ //
@@ -281,27 +335,16 @@ bool PhysicalWorld::Process(float delta)
         return false;
     }
 
+    if (IsCapacityGrowthPending()) [[unlikely]]
+        ApplyPendingCapacityGrowth();
+
     nextStepIsFresh = true;
 
     elapsedSinceUpdate += delta;
 
-    const auto singlePhysicsFrame = 1 / physicsFrameRate;
-
-    bool simulatedPhysics = false;
-    float simulatedTime = 0;
-
-    // TODO: limit max steps per frame to avoid massive potential for lag spikes
-    // TODO: alternatively to this it is possible to use a bigger timestep at once but then collision steps and
-    // integration steps should be incremented
-    while (elapsedSinceUpdate > singlePhysicsFrame)
-    {
-        elapsedSinceUpdate -= singlePhysicsFrame;
-        simulatedTime += singlePhysicsFrame;
-        StepPhysics(singlePhysicsFrame);
-        simulatedPhysics = true;
-    }
+    const auto simulatedTime = StepElapsedTime();
 
-    if (!simulatedPhysics)
+    if (simulatedTime <= 0)
         return false;
 
     DrawPhysics(simulatedTime);
@@ -311,6 +354,10 @@ bool PhysicalWorld::Process(float delta)
 
 void PhysicalWorld::ProcessInBackground(float delta)
 {
+    // The system can only be rebuilt here on the main thread while it is not in use
+    if (IsCapacityGrowthPending() && !runningBackgroundSimulation) [[unlikely]]
+        ApplyPendingCapacityGrowth();
+
     bool previous = false;
     if (!runningBackgroundSimulation.compare_exchange_strong(previous, true))
     {
@@ -343,12 +390,7 @@ void PhysicalWorld::ProcessInBackground(float delta)
 
 bool PhysicalWorld::WaitForPhysicsToComplete()
 {
-    // For now this never sleep as it is assumed the physics should be done by the time the main thread gets here
-    // or very close to done
-    while (runningBackgroundSimulation)
-    {
-        HYPER_THREAD_YIELD;
-    }
+    WaitForBackgroundSimulationEnd();
 
     if (nextStepIsFresh)
         return false;
@@ -494,29 +536,153 @@ void PhysicalWorld::AddBody(PhysicsBody& body, bool activate)
         return;
     }
 
-    // Create constraints if not done yet
-    for (auto& constraint : body.GetConstraints())
+    CreatePendingConstraints(body);
+
+    physicsSystem->GetBodyInterface().AddBody(
+        body.GetId(), activate ? JPH::EActivation::Activate : JPH::EActivation::DontActivate);
+    OnPostBodyAdded(body);
+}
+
+int PhysicalWorld::CreateBodiesBulk(
+    const PhysicsBodyCreationInfo* infos, int count, Ref<PhysicsBody>* bodiesReceiver, bool addToWorld)
+{
+    if (count <= 0)
+        return 0;
+
+    auto& bodyInterface = physicsSystem->GetBodyInterface();
+
+    const auto createRange = [infos, bodiesReceiver, &bodyInterface](int64_t rangeStart, int64_t rangeEnd)
     {
-        if (!constraint->IsCreatedInWorld())
+        for (auto i = rangeStart; i < rangeEnd; ++i)
         {
-            // TODO: constraint creation has to be skipped if the other body the constraint is on is currently
-            // detached and created later
-            if ((constraint->optionalSecondBody != nullptr && constraint->optionalSecondBody.get() != &body &&
-                    constraint->optionalSecondBody->IsDetached()) ||
-                (constraint->firstBody.get() != &body && constraint->firstBody->IsDetached()))
+            const auto& info = infos[i];
+
+            bodiesReceiver[i] = nullptr;
+
+            if (info.Shape == nullptr) [[unlikely]]
             {
-                LOG_ERROR("Not implemented handling for deferring constraint creation for detached body");
+                LOG_ERROR("No shape given to bulk body create");
                 continue;
             }
 
-            physicsSystem->AddConstraint(constraint->GetConstraint().GetPtr());
-            constraint->OnRegisteredToWorld(*this);
+            const auto creationSettings = JPH::BodyCreationSettings(info.Shape, info.Position, info.Rotation,
+                info.Static ? JPH::EMotionType::Static : JPH::EMotionType::Dynamic,
+                info.Static ? Layers::NON_MOVING : Layers::MOVING);
+
+            auto* body = bodyInterface.CreateBody(creationSettings);
+
+            if (body == nullptr) [[unlikely]]
+            {
+                LOG_ERROR("Ran out of physics bodies");
+                continue;
+            }
+
+            bodiesReceiver[i] = WrapCreatedBody(*body);
         }
+    };
+
+    // Creating the bodies is thread safe in Jolt, and most of the time is spent calculating the mass properties of the
+    // shapes, so that is spread over the task threads. In deterministic mode the bodies need to get their IDs in a
+    // fixed order so they are created on this thread.
+    if (deterministicMode)
+    {
+        createRange(0, count);
+    }
+    else
+    {
+        ParallelFor(0, count, 8, createRange);
     }
 
-    physicsSystem->GetBodyInterface().AddBody(
-        body.GetId(), activate ? JPH::EActivation::Activate : JPH::EActivation::DontActivate);
-    OnPostBodyAdded(body);
+    CheckBodyCapacity();
+
+    // changesToBodies is not set here as the bodies are added to the broadphase as a single batch, which doesn't
+    // make the broadphase need an optimization like adding the bodies one by one does
+
+    int created = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (bodiesReceiver[i] == nullptr) [[unlikely]]
+            continue;
+
+        // Doesn't add to the world here, that's done below all at once
+        bodiesReceiver[i] = OnBodyCreated(std::move(bodiesReceiver[i]), false);
+        ++created;
+    }
+
+    if (!addToWorld || created < 1)
+        return created;
+
+    // Jolt may reorder the IDs so this needs a separate array
+    JPH::BodyIDVector bodyIds;
+    JPH::BodyIDVector activateIds;
+    bodyIds.reserve(created);
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (bodiesReceiver[i] == nullptr)
+            continue;
+
+        bodyIds.push_back(bodiesReceiver[i]->GetId());
+
+        if (infos[i].Activate)
+            activateIds.push_back(bodiesReceiver[i]->GetId());
+    }
+
+    // Inserting all the bodies at once is much cheaper for the broadphase than adding them one by one
+    const auto addState = bodyInterface.AddBodiesPrepare(bodyIds.data(), static_cast<int>(bodyIds.size()));
+    bodyInterface.AddBodiesFinalize(
+        bodyIds.data(), static_cast<int>(bodyIds.size()), addState, JPH::EActivation::DontActivate);
+
+    if (!activateIds.empty())
+        bodyInterface.ActivateBodies(activateIds.data(), static_cast<int>(activateIds.size()));
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (bodiesReceiver[i] != nullptr)
+            OnPostBodyAdded(*bodiesReceiver[i]);
+    }
+
+    return created;
+}
+
+void PhysicalWorld::AddBodiesBulk(PhysicsBody* const* bodies, int count, bool activate)
+{
+    JPH::BodyIDVector bodyIds;
+    bodyIds.reserve(count);
+
+    std::vector<PhysicsBody*> addedBodies;
+    addedBodies.reserve(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto& body = *bodies[i];
+
+        if ((body.IsInWorld() && !body.IsDetached()) || !body.IsInSpecificWorld(this)) [[unlikely]]
+        {
+            LOG_ERROR("Physics body in bulk add is already in a world or belongs to a different world, skipping it");
+            continue;
+        }
+
+        CreatePendingConstraints(body);
+
+        bodyIds.push_back(body.GetId());
+        addedBodies.push_back(&body);
+    }
+
+    if (bodyIds.empty())
+        return;
+
+    auto& bodyInterface = physicsSystem->GetBodyInterface();
+
+    const auto addState = bodyInterface.AddBodiesPrepare(bodyIds.data(), static_cast<int>(bodyIds.size()));
+    bodyInterface.AddBodiesFinalize(bodyIds.data(), static_cast<int>(bodyIds.size()), addState,
+        activate ? JPH::EActivation::Activate : JPH::EActivation::DontActivate);
+
+    for (auto* body : addedBodies)
+    {
+        OnPostBodyAdded(*body);
+    }
 }
 
 void PhysicalWorld::DetachBody(PhysicsBody& body)
@@ -573,6 +739,61 @@ void PhysicalWorld::DestroyBody(const Ref<PhysicsBody>& body)
     changesToBodies = true;
 }
 
+void PhysicalWorld::DestroyBodiesBulk(PhysicsBody* const* bodies, int count)
+{
+    JPH::BodyIDVector removeIds;
+    JPH::BodyIDVector destroyIds;
+    removeIds.reserve(count);
+    destroyIds.reserve(count);
+
+    // Keep the bodies alive until all of the world state related to them has been cleared
+    std::vector<Ref<PhysicsBody>> leavingBodies;
+    leavingBodies.reserve(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto* body = bodies[i];
+
+        if (body == nullptr)
+            continue;
+
+        if (!body->IsInWorld()) [[unlikely]]
+        {
+            LOG_ERROR("Cannot destroy a physics body not in the world");
+            continue;
+        }
+
+        destroyIds.push_back(body->GetId());
+
+        // Detached bodies have already performed their leave world logic
+        if (body->IsDetached())
+        {
+            body->MarkRemovedFromWorld();
+            continue;
+        }
+
+        OnBodyPreLeaveWorld(*body);
+        removeIds.push_back(body->GetId());
+        leavingBodies.emplace_back(body);
+    }
+
+    auto& bodyInterface = physicsSystem->GetBodyInterface();
+
+    if (!removeIds.empty())
+        bodyInterface.RemoveBodies(removeIds.data(), static_cast<int>(removeIds.size()));
+
+    if (!destroyIds.empty())
+        bodyInterface.DestroyBodies(destroyIds.data(), static_cast<int>(destroyIds.size()));
+
+    for (auto& body : leavingBodies)
+    {
+        body->MarkRemovedFromWorld();
+        OnPostBodyLeaveWorld(*body);
+    }
+
+    changesToBodies = true;
+}
+
 // ------------------------------------ //
 void PhysicalWorld::SetDamping(JPH::BodyID bodyId, float damping, const float* angularDamping /*= nullptr*/)
 {
@@ -612,6 +833,161 @@ void PhysicalWorld::ReadBodyTransform(
     }
 }
 
+/// \brief Locks each of the bodies for reading and gives them to the writer, or nullptr if locking failed
+template<class Writer>
+static void ReadLockedBodies(
+    const JPH::BodyLockInterface& lockInterface, PhysicsBody* const* bodies, int count, const Writer& writer)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        JPH::BodyLockRead lock(lockInterface, bodies[i]->GetId());
+        if (!lock.Succeeded()) [[unlikely]]
+        {
+            LOG_ERROR("Couldn't lock body for bulk reading");
+            writer(i, nullptr);
+            continue;
+        }
+
+        writer(i, &lock.GetBody());
+    }
+}
+
+void PhysicalWorld::ReadBodiesBulk(PhysicsBody* const* bodies, int count, JPH::RVec3* positionsReceiver,
+    JPH::Quat* rotationsReceiver, JPH::Vec3* velocitiesReceiver, JPH::Vec3* angularVelocitiesReceiver) const
+{
+    const bool readVelocities = velocitiesReceiver != nullptr && angularVelocitiesReceiver != nullptr;
+
+    ReadLockedBodies(GetQueryLockInterface(), bodies, count,
+        [=](int i, const JPH::Body* body)
+        {
+            if (body == nullptr) [[unlikely]]
+            {
+                std::memset(&positionsReceiver[i], 0, sizeof(JPH::RVec3));
+                std::memset(&rotationsReceiver[i], 0, sizeof(JPH::Quat));
+
+                if (readVelocities)
+                {
+                    std::memset(&velocitiesReceiver[i], 0, sizeof(JPH::Vec3));
+                    std::memset(&angularVelocitiesReceiver[i], 0, sizeof(JPH::Vec3));
+                }
+
+                return;
+            }
+
+            positionsReceiver[i] = body->GetPosition();
+            rotationsReceiver[i] = body->GetRotation();
+
+            if (readVelocities)
+            {
+                velocitiesReceiver[i] = body->GetLinearVelocity();
+                angularVelocitiesReceiver[i] = body->GetAngularVelocity();
+            }
+        });
+}
+
+void PhysicalWorld::ReadBodiesBulk(PhysicsBody* const* bodies, int count, double* positionsReceiver,
+    float* rotationsReceiver, float* velocitiesReceiver, float* angularVelocitiesReceiver) const
+{
+    const bool readVelocities = velocitiesReceiver != nullptr && angularVelocitiesReceiver != nullptr;
+
+    ReadLockedBodies(GetQueryLockInterface(), bodies, count,
+        [=](int i, const JPH::Body* body)
+        {
+            double* position = positionsReceiver + static_cast<size_t>(i) * 3;
+            float* rotation = rotationsReceiver + static_cast<size_t>(i) * 4;
+
+            if (body == nullptr) [[unlikely]]
+            {
+                std::memset(position, 0, sizeof(double) * 3);
+                std::memset(rotation, 0, sizeof(float) * 4);
+
+                if (readVelocities)
+                {
+                    std::memset(velocitiesReceiver + static_cast<size_t>(i) * 3, 0, sizeof(float) * 3);
+                    std::memset(angularVelocitiesReceiver + static_cast<size_t>(i) * 3, 0, sizeof(float) * 3);
+                }
+
+                return;
+            }
+
+            const auto bodyPosition = body->GetPosition();
+            position[0] = bodyPosition.GetX();
+            position[1] = bodyPosition.GetY();
+            position[2] = bodyPosition.GetZ();
+
+            const auto bodyRotation = body->GetRotation();
+            rotation[0] = bodyRotation.GetX();
+            rotation[1] = bodyRotation.GetY();
+            rotation[2] = bodyRotation.GetZ();
+            rotation[3] = bodyRotation.GetW();
+
+            if (readVelocities)
+            {
+                body->GetLinearVelocity().StoreFloat3(
+                    reinterpret_cast<JPH::Float3*>(velocitiesReceiver + static_cast<size_t>(i) * 3));
+                body->GetAngularVelocity().StoreFloat3(
+                    reinterpret_cast<JPH::Float3*>(angularVelocitiesReceiver + static_cast<size_t>(i) * 3));
+            }
+        });
+}
+
+void PhysicalWorld::SetBodySnapshotsEnabled(bool enabled)
+{
+    if (runningBackgroundSimulation)
+    {
+        LOG_ERROR("Can't change body snapshot state while background physics is running");
+        return;
+    }
+
+    if (!enabled)
+    {
+        pimpl->bodySnapshot.reset();
+        return;
+    }
+
+    if (pimpl->bodySnapshot)
+        return;
+
+    pimpl->bodySnapshot = std::make_unique<BodyStateSnapshot>(maxBodies);
+
+    // Take an initial snapshot to have data available before the next update
+    pimpl->bodySnapshot->Write(*physicsSystem);
+}
+
+void PhysicalWorld::SetCollisionEventStreamCapacity(uint32_t capacity)
+{
+    if (runningBackgroundSimulation)
+    {
+        LOG_ERROR("Can't change collision event stream while background physics is running");
+        return;
+    }
+
+    contactListener->SetCollisionEventStreamCapacity(capacity);
+}
+
+const CollisionEventStream* PhysicalWorld::GetCollisionEvents() const
+{
+    return contactListener->GetCollisionEventStream();
+}
+
+bool PhysicalWorld::ReadBodySnapshot(JPH::BodyID bodyId, JPH::RVec3& positionReceiver, JPH::Quat& rotationReceiver,
+    JPH::Vec3& velocityReceiver, JPH::Vec3& angularVelocityReceiver) const
+{
+    if (!pimpl->bodySnapshot) [[unlikely]]
+        return false;
+
+    BodyStateSnapshot::BodyState state;
+
+    if (!pimpl->bodySnapshot->BeginRead().ReadBody(bodyId, state))
+        return false;
+
+    positionReceiver = state.Position;
+    rotationReceiver = state.Rotation;
+    velocityReceiver = state.Velocity;
+    angularVelocityReceiver = state.AngularVelocity;
+    return true;
+}
+
 void PhysicalWorld::ReadBodyVelocity(
     JPH::BodyID bodyId, JPH::Vec3& velocityReceiver, JPH::Vec3& angularVelocityReceiver) const
 {
@@ -863,62 +1239,220 @@ void PhysicalWorld::SetBodyAllowSleep(JPH::BodyID bodyId, bool allowSleeping)
     body.SetAllowSleeping(allowSleeping);
 }
 
-bool PhysicalWorld::FixBodyYCoordinateToZero(JPH::BodyID bodyId)
+void PhysicalWorld::ApplyBodyCommands(const PhysicsBodyCommand* commands, int count)
 {
-    decltype(std::declval<JPH::Body>().GetPosition()) position;
+    // Writes always lock as this can be called from any thread, even while the physics update is running
+    const JPH::BodyLockInterface& lockInterface = physicsSystem->GetBodyLockInterface();
 
-    {
-        // TODO: maybe there's a way to avoid the double lock here? (setting position takes a lock as well)
-        JPH::BodyLockRead lock(physicsSystem->GetBodyLockInterface(), bodyId);
-        if (!lock.Succeeded()) [[unlikely]]
-        {
-            LOG_ERROR("Can't lock body for y-position fix");
-            return false;
-        }
+    // Temporary buffers kept per thread to not allocate memory each time while still allowing concurrent calls
+    thread_local JPH::BodyIDVector activations;
+    thread_local std::vector<std::tuple<JPH::BodyID, const PhysicsBodyCommand*>> transformChanges;
 
-        const JPH::Body& body = lock.GetBody();
+    activations.clear();
+    transformChanges.clear();
 
-        position = body.GetPosition();
-    }
+    int groupStart = 0;
 
-    // Likely is used here as this is only called from C# when drifting has actually been detected
-    if (std::abs(position.GetY()) > 0.0005f) [[likely]]
+    while (groupStart < count)
     {
-        SetPosition(bodyId, {position.GetX(), 0, position.GetZ()}, false);
-        return true;
-    }
+        const auto* bodyPointer = commands[groupStart].Body;
 
-    return false;
-}
+        int groupEnd = groupStart + 1;
 
-void PhysicalWorld::ChangeBodyShape(PhysicsBody& body, const JPH::RefConst<JPH::Shape>& shape, bool activate)
-{
-    // Must force no-activation when detached to prevent crashing
-    if (body.IsDetached())
-        activate = false;
+        while (groupEnd < count && commands[groupEnd].Body == bodyPointer)
+            ++groupEnd;
 
-    // For now this always recalculates mass and inertia
-    physicsSystem->GetBodyInterface().SetShape(
-        body.GetId(), shape, true, activate ? JPH::EActivation::Activate : JPH::EActivation::DontActivate);
-}
+        if (bodyPointer == nullptr) [[unlikely]]
+        {
+            LOG_ERROR("Physics body command has no body, skipping it");
+            groupStart = groupEnd;
+            continue;
+        }
 
-// ------------------------------------ //
-const int32_t* PhysicalWorld::EnableCollisionRecording(
-    PhysicsBody& body, CollisionRecordListType collisionRecordingTarget, int maxRecordedCollisions)
-{
-    if (maxRecordedCollisions < 1)
-    {
-        LOG_ERROR("Cannot start recording less than 1 collision");
-        DisableCollisionRecording(body);
-        return nullptr;
-    }
+        const auto bodyId = bodyPointer->GetId();
 
-    body.SetCollisionRecordingTarget(collisionRecordingTarget, maxRecordedCollisions);
+        bool activate = false;
 
-    if (body.MarkCollisionRecordingEnabled())
-    {
-        UpdateBodyUserPointer(body);
-    }
+        {
+            JPH::BodyLockWrite lock(lockInterface, bodyId);
+            if (!lock.Succeeded()) [[unlikely]]
+            {
+                LOG_ERROR("Couldn't lock body for applying commands");
+                groupStart = groupEnd;
+                continue;
+            }
+
+            JPH::Body& body = lock.GetBody();
+
+            for (int i = groupStart; i < groupEnd; ++i)
+            {
+                const auto& command = commands[i];
+
+                switch (command.Type)
+                {
+                    case BodyCommandType::GiveImpulse:
+                    {
+                        body.AddImpulse(command.Vector);
+                        activate |= !command.Vector.IsNearZero();
+                        break;
+                    }
+                    case BodyCommandType::GiveAngularImpulse:
+                    {
+                        body.AddAngularImpulse(command.AngularVector);
+                        activate |= !command.AngularVector.IsNearZero();
+                        break;
+                    }
+                    case BodyCommandType::SetVelocity:
+                    {
+                        body.SetLinearVelocityClamped(command.Vector);
+                        activate |= !command.Vector.IsNearZero();
+                        break;
+                    }
+                    case BodyCommandType::SetAngularVelocity:
+                    {
+                        body.SetAngularVelocityClamped(command.AngularVector);
+                        activate |= !command.AngularVector.IsNearZero();
+                        break;
+                    }
+                    case BodyCommandType::SetVelocityAndAngularVelocity:
+                    {
+                        body.SetLinearVelocityClamped(command.Vector);
+                        body.SetAngularVelocityClamped(command.AngularVector);
+                        activate |= !command.Vector.IsNearZero() || !command.AngularVector.IsNearZero();
+                        break;
+                    }
+                    case BodyCommandType::SetPosition:
+                    case BodyCommandType::SetPositionAndRotation:
+                        // These need to update the broadphase as well so these are done through the body
+                        // interface once the lock is released
+                        transformChanges.emplace_back(bodyId, &command);
+                        break;
+                    case BodyCommandType::SetDamping:
+                    case BodyCommandType::SetDampingAndAngularDamping:
+                    {
+                        auto* motionProperties = body.GetMotionProperties();
+
+                        if (motionProperties == nullptr) [[unlikely]]
+                        {
+                            LOG_ERROR("Can't set damping for a body without motion properties");
+                            break;
+                        }
+
+                        motionProperties->SetLinearDamping(command.Damping);
+
+                        if (command.Type == BodyCommandType::SetDampingAndAngularDamping)
+                            motionProperties->SetAngularDamping(command.AngularDamping);
+
+                        break;
+                    }
+                    default:
+                        LOG_ERROR("Unknown physics body command type: " +
+                            std::to_string(static_cast<int32_t>(command.Type)));
+                        break;
+                }
+            }
+
+            // Activation is mandatory when a body has velocity
+            if (activate && body.IsActive())
+                activate = false;
+        }
+
+        if (activate)
+            activations.push_back(bodyId);
+
+        groupStart = groupEnd;
+    }
+
+    auto& bodyInterface = physicsSystem->GetBodyInterface();
+
+    for (const auto& [bodyId, command] : transformChanges)
+    {
+        if (command->Type == BodyCommandType::SetPosition)
+        {
+            bodyInterface.SetPosition(bodyId, command->Position, JPH::EActivation::DontActivate);
+        }
+        else if (!command->Activate)
+        {
+            // Same as SetPositionAndRotation, this skips the broadphase update when nothing changed
+            bodyInterface.SetPositionAndRotationWhenChanged(
+                bodyId, command->Position, command->Rotation, JPH::EActivation::DontActivate);
+        }
+        else
+        {
+            bodyInterface.SetPositionAndRotation(
+                bodyId, command->Position, command->Rotation, JPH::EActivation::DontActivate);
+        }
+
+        if (command->Activate)
+            activations.push_back(bodyId);
+    }
+
+    if (!activations.empty())
+    {
+        // Multiple commands for the same body can request activation so remove duplicates
+        std::sort(activations.begin(), activations.end());
+        activations.erase(std::unique(activations.begin(), activations.end()), activations.end());
+
+        bodyInterface.ActivateBodies(activations.data(), static_cast<int>(activations.size()));
+    }
+}
+
+bool PhysicalWorld::FixBodyYCoordinateToZero(JPH::BodyID bodyId)
+{
+    decltype(std::declval<JPH::Body>().GetPosition()) position;
+
+    {
+        // TODO: maybe there's a way to avoid the double lock here? (setting position takes a lock as well)
+        JPH::BodyLockRead lock(physicsSystem->GetBodyLockInterface(), bodyId);
+        if (!lock.Succeeded()) [[unlikely]]
+        {
+            LOG_ERROR("Can't lock body for y-position fix");
+            return false;
+        }
+
+        const JPH::Body& body = lock.GetBody();
+
+        position = body.GetPosition();
+    }
+
+    // Likely is used here as this is only called from C# when drifting has actually been detected
+    if (std::abs(position.GetY()) > 0.0005f) [[likely]]
+    {
+        SetPosition(bodyId, {position.GetX(), 0, position.GetZ()}, false);
+        return true;
+    }
+
+    return false;
+}
+
+void PhysicalWorld::ChangeBodyShape(PhysicsBody& body, const JPH::RefConst<JPH::Shape>& shape, bool activate)
+{
+    // Must force no-activation when detached to prevent crashing
+    if (body.IsDetached())
+        activate = false;
+
+    // For now this always recalculates mass and inertia
+    physicsSystem->GetBodyInterface().SetShape(
+        body.GetId(), shape, true, activate ? JPH::EActivation::Activate : JPH::EActivation::DontActivate);
+}
+
+// ------------------------------------ //
+const int32_t* PhysicalWorld::EnableCollisionRecording(PhysicsBody& body,
+    CollisionRecordListType collisionRecordingTarget, int maxRecordedCollisions, bool recordEndedCollisions /*= false*/)
+{
+    if (maxRecordedCollisions < 1)
+    {
+        LOG_ERROR("Cannot start recording less than 1 collision");
+        DisableCollisionRecording(body);
+        return nullptr;
+    }
+
+    body.SetCollisionRecordingTarget(collisionRecordingTarget, maxRecordedCollisions, recordEndedCollisions);
+
+    if (body.MarkCollisionRecordingEnabled())
+    {
+        UpdateBodyUserPointer(body);
+    }
 
     return body.GetRecordedCollisionTargetAddress();
 }
@@ -1002,222 +1536,1015 @@ void PhysicalWorld::SetCollisionDisabledState(PhysicsBody& body, bool disableAll
         body.MarkCollisionDisableFlagDisabled();
     }
 
-    UpdateBodyUserPointer(body);
-}
+    UpdateBodyUserPointer(body);
+}
+
+void PhysicalWorld::SetCollisionGroup(PhysicsBody& body, uint32_t group, uint32_t category, uint32_t mask)
+{
+    bool changes;
+
+    if (body.SetCollisionGroup(group, category, mask))
+    {
+        changes = body.MarkCollisionGroupFilterEnabled();
+    }
+    else
+    {
+        changes = body.MarkCollisionGroupFilterDisabled();
+    }
+
+    if (changes)
+        UpdateBodyUserPointer(body);
+}
+
+void PhysicalWorld::AddCollisionFilter(PhysicsBody& body, CollisionFilterCallback callback)
+{
+    body.SetCollisionFilter(callback);
+
+    if (body.MarkCollisionFilterCallbackUsed())
+    {
+        UpdateBodyUserPointer(body);
+    }
+}
+
+void PhysicalWorld::DisableCollisionFilter(PhysicsBody& body)
+{
+    if (body.MarkCollisionFilterCallbackDisabled())
+    {
+        UpdateBodyUserPointer(body);
+    }
+
+    body.RemoveCollisionFilter();
+}
+
+// ------------------------------------ //
+Ref<TrackedConstraint> PhysicalWorld::CreateAxisLockConstraint(PhysicsBody& body, JPH::Vec3 axis, bool lockRotation)
+{
+    JPH::BodyLockWrite lock(physicsSystem->GetBodyLockInterface(), body.GetId());
+    if (!lock.Succeeded()) [[unlikely]]
+    {
+        LOG_ERROR("Locking body for adding a constraint failed");
+        return nullptr;
+    }
+
+    JPH::SixDOFConstraintSettings constraintSettings;
+
+    // This was in an example at https://github.com/jrouwe/JoltPhysics/issues/359 but would require some extra
+    // space calculation so this is left out
+    // constraintSettings.mSpace = JPH::EConstraintSpace::LocalToBodyCOM;
+
+    if (axis.GetX() != 0)
+        constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::TranslationX);
+
+    if (axis.GetY() != 0)
+        constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::TranslationY);
+
+    if (axis.GetZ() != 0)
+        constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::TranslationZ);
+
+    if (lockRotation)
+    {
+        if (axis.GetX() != 0)
+        {
+            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationY);
+            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationZ);
+        }
+
+        if (axis.GetY() != 0)
+        {
+            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationX);
+            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationZ);
+        }
+
+        if (axis.GetZ() != 0)
+        {
+            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationY);
+            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationZ);
+        }
+    }
+
+    // Needed for precision on the axis lock to actually stay relatively close to the target value
+    constraintSettings.mPosition1 = constraintSettings.mPosition2 = lock.GetBody().GetCenterOfMassPosition();
+
+    auto constraintPtr = (JPH::SixDOFConstraint*)constraintSettings.Create(JPH::Body::sFixedToWorld, lock.GetBody());
+
+#ifdef USE_OBJECT_POOLS
+    auto trackedConstraint =
+        ConstructFromGlobalPool<TrackedConstraint>(JPH::Ref<JPH::Constraint>(constraintPtr), Ref<PhysicsBody>(&body));
+#else
+    auto trackedConstraint = Ref<TrackedConstraint>(
+        new TrackedConstraint(JPH::Ref<JPH::Constraint>(constraintPtr), Ref<PhysicsBody>(&body)));
+#endif
+
+    if (body.IsInWorld() && !body.IsDetached())
+    {
+        // Immediately register the constraint if the body is in the world currently
+
+        // TODO: multithreaded adding?
+        physicsSystem->AddConstraint(trackedConstraint->GetConstraint().GetPtr());
+        trackedConstraint->OnRegisteredToWorld(*this);
+    }
+
+    return trackedConstraint;
+}
+
+void PhysicalWorld::DestroyConstraint(TrackedConstraint& constraint)
+{
+    // TODO: allow multithreading
+    physicsSystem->RemoveConstraint(constraint.GetConstraint().GetPtr());
+    constraint.OnDestroyByWorld(*this);
+}
+
+// ------------------------------------ //
+std::optional<std::tuple<float, JPH::Vec3, JPH::BodyID>> PhysicalWorld::CastRay(
+    JPH::RVec3 start, JPH::Vec3 endOffset, uint32_t layerMask)
+{
+    // The Jolt samples app has some really nice alternative cast modes that could be added in the future
+
+    JPH::RRayCast ray{start, endOffset};
+
+    // Cast ray
+    JPH::RayCastResult hit;
+
+    bool hitSomething = physicsSystem->GetNarrowPhaseQuery().CastRay(
+        ray, hit, BroadPhaseLayerMaskFilter(layerMask), ObjectLayerMaskFilter(layerMask));
+
+    if (!hitSomething)
+        return {};
+
+    const auto resultPosition = ray.GetPointOnRay(hit.mFraction);
+    const auto resultFraction = hit.mFraction;
+    const auto resultID = hit.mBodyID;
+
+    // Could do something with the hit sub-shape
+    // hit.mSubShapeID2
+
+    // Or material
+    // JPH::BodyLockRead lock(physicsSystem->GetBodyLockInterface(), hit.mBodyID);
+    // if (lock.Succeeded())
+    // {
+    //     const JPH::Body& resultBody = lock.GetBody();
+    //     const JPH::PhysicsMaterial* material = resultBody.GetShape()->GetMaterial(hit.mSubShapeID2);
+    // }
+    // else
+    // {
+    //     LOG_ERROR("Failed to get body read lock for ray cast");
+    // }
+
+    return std::tuple<float, JPH::Vec3, JPH::BodyID>(resultFraction, resultPosition, resultID);
+}
+
+int PhysicalWorld::CastRayGetAllUserData(JPH::RVec3 start, JPH::Vec3 endOffset, PhysicsRayWithUserData* dataReceiver,
+    int maxHits, uint32_t layerMask, PhysicsBody* const* ignoredBodies, int ignoreCount)
+{
+    if (maxHits < 1 || dataReceiver == nullptr)
+    {
+        LOG_ERROR("Physics ray collection given no storage space for results");
+        return 0;
+    }
+
+    JPH::RRayCast ray{start, endOffset};
+
+    ArrayRayCollector rayCollector{dataReceiver, maxHits, GetQueryLockInterface()};
+
+    JPH::RayCastSettings settings;
+
+    // TODO: should the option to treat convex as solid be set to false?
+    // settings.mTreatConvexAsSolid = false;
+
+    physicsSystem->GetNarrowPhaseQuery().CastRay(ray, settings, rayCollector, BroadPhaseLayerMaskFilter(layerMask),
+        ObjectLayerMaskFilter(layerMask), IgnoredBodiesFilter(ignoredBodies, ignoreCount));
+
+    return rayCollector.GetHitCount();
+}
+
+int PhysicalWorld::CastRaysBatch(const JPH::RRayCast* rays, int count, PhysicsRayWithUserData results[],
+    int32_t* hitCountsReceiver, int maxHitsPerRay, uint32_t layerMask, PhysicsBody* const* ignoredBodies,
+    int ignoreCount) const
+{
+    if (count <= 0)
+        return 0;
+
+    if (maxHitsPerRay < 1 || results == nullptr || hitCountsReceiver == nullptr) [[unlikely]]
+    {
+        LOG_ERROR("Physics batch ray cast given no storage space for results");
+        return 0;
+    }
+
+    const auto& lockInterface = GetQueryLockInterface();
+
+    const auto& query = physicsSystem->GetNarrowPhaseQuery();
+
+    const BroadPhaseLayerMaskFilter broadPhaseFilter(layerMask);
+    const ObjectLayerMaskFilter objectLayerFilter(layerMask);
+    const IgnoredBodiesFilter bodyFilter(ignoredBodies, ignoreCount);
+
+    // Each ray is quite a small amount of work, so the rays are handed out in batches
+    ParallelFor(0, count, 16,
+        [&](int64_t rangeStart, int64_t rangeEnd)
+        {
+            const JPH::RayCastSettings settings;
+
+            for (auto i = rangeStart; i < rangeEnd; ++i)
+            {
+                ArrayRayCollector rayCollector{results + i * maxHitsPerRay, maxHitsPerRay, lockInterface};
+
+                query.CastRay(rays[i], settings, rayCollector, broadPhaseFilter, objectLayerFilter, bodyFilter);
+
+                hitCountsReceiver[i] = rayCollector.GetHitCount();
+            }
+        });
+
+    int totalHits = 0;
+
+    for (int i = 0; i < count; ++i)
+        totalHits += hitCountsReceiver[i];
+
+    return totalHits;
+}
+
+// ------------------------------------ //
+/// Broadphase queries use single precision
+static inline JPH::Vec3 ToBroadPhaseVec3(JPH::RVec3Arg value)
+{
+    return {static_cast<float>(value.GetX()), static_cast<float>(value.GetY()), static_cast<float>(value.GetZ())};
+}
+
+/// Reused between queries as many threads may run queries at once
+static thread_local JPH::BodyIDVector QueryBodiesScratch;
+
+int PhysicalWorld::OverlapSphere(JPH::RVec3 center, float radius, PhysicsRayWithUserData dataReceiver[],
+    int maxResults, uint32_t layerMask) const
+{
+    if (maxResults < 1 || dataReceiver == nullptr) [[unlikely]]
+    {
+        LOG_ERROR("Physics overlap query given no storage space for results");
+        return 0;
+    }
+
+    auto& bodies = QueryBodiesScratch;
+    bodies.clear();
+
+    BodyIdCollector collector{bodies, static_cast<size_t>(maxResults)};
+
+    physicsSystem->GetBroadPhaseQuery().CollideSphere(ToBroadPhaseVec3(center), radius, collector,
+        BroadPhaseLayerMaskFilter(layerMask), ObjectLayerMaskFilter(layerMask));
+
+    return WriteBodyQueryResults(bodies.data(), bodies.size(), center, dataReceiver, maxResults, false);
+}
+
+int PhysicalWorld::OverlapAABB(
+    JPH::RVec3 min, JPH::RVec3 max, PhysicsRayWithUserData dataReceiver[], int maxResults, uint32_t layerMask) const
+{
+    if (maxResults < 1 || dataReceiver == nullptr) [[unlikely]]
+    {
+        LOG_ERROR("Physics overlap query given no storage space for results");
+        return 0;
+    }
+
+    auto& bodies = QueryBodiesScratch;
+    bodies.clear();
+
+    BodyIdCollector collector{bodies, static_cast<size_t>(maxResults)};
+
+    physicsSystem->GetBroadPhaseQuery().CollideAABox(JPH::AABox(ToBroadPhaseVec3(min), ToBroadPhaseVec3(max)),
+        collector, BroadPhaseLayerMaskFilter(layerMask), ObjectLayerMaskFilter(layerMask));
+
+    return WriteBodyQueryResults(bodies.data(), bodies.size(), (min + max) * 0.5, dataReceiver, maxResults, false);
+}
+
+int PhysicalWorld::FindNearestK(JPH::RVec3 center, float maxDistance, PhysicsRayWithUserData dataReceiver[],
+    int count, uint32_t layerMask) const
+{
+    if (count < 1 || dataReceiver == nullptr) [[unlikely]]
+    {
+        LOG_ERROR("Physics nearest body query given no storage space for results");
+        return 0;
+    }
+
+    auto& bodies = QueryBodiesScratch;
+    bodies.clear();
+
+    // All candidates are needed to find the closest ones
+    BodyIdCollector collector{bodies, std::numeric_limits<size_t>::max()};
+
+    physicsSystem->GetBroadPhaseQuery().CollideSphere(ToBroadPhaseVec3(center), maxDistance, collector,
+        BroadPhaseLayerMaskFilter(layerMask), ObjectLayerMaskFilter(layerMask));
+
+    // The broadphase finds bodies by their bounds so the ones with their position too far away need to be skipped
+    return WriteBodyQueryResults(bodies.data(), bodies.size(), center, dataReceiver, count, true, maxDistance);
+}
+
+const JPH::BodyLockInterface& PhysicalWorld::GetQueryLockInterface() const
+{
+    // Locking is only needed if the physics update can be modifying the bodies at the same time
+    if (runningBackgroundSimulation)
+        return physicsSystem->GetBodyLockInterface();
+
+    return physicsSystem->GetBodyLockInterfaceNoLock();
+}
+
+int PhysicalWorld::WriteBodyQueryResults(const JPH::BodyID* bodies, size_t bodyCount, JPH::RVec3Arg center,
+    PhysicsRayWithUserData dataReceiver[], int maxResults, bool sortByDistance, float maxDistance) const
+{
+    static thread_local std::vector<std::tuple<float, const PhysicsBody*>> foundBodies;
+    foundBodies.clear();
+
+    const auto& lockInterface = GetQueryLockInterface();
+
+    for (size_t i = 0; i < bodyCount; ++i)
+    {
+        JPH::BodyLockRead lock(lockInterface, bodies[i]);
+        if (!lock.Succeeded()) [[unlikely]]
+            continue;
+
+        const auto& body = lock.GetBody();
+
+        const auto distance = static_cast<float>((body.GetPosition() - center).Length());
+
+        if (distance > maxDistance)
+            continue;
+
+        foundBodies.emplace_back(distance, PhysicsBody::FromJoltBody(body.GetUserData()));
+    }
+
+    const auto resultCount = std::min(static_cast<int>(foundBodies.size()), maxResults);
+
+    if (sortByDistance)
+    {
+        std::partial_sort(foundBodies.begin(), foundBodies.begin() + resultCount, foundBodies.end(),
+            [](const auto& first, const auto& second) { return std::get<0>(first) < std::get<0>(second); });
+    }
+
+    for (int i = 0; i < resultCount; ++i)
+    {
+        const auto [distance, bodyWrapper] = foundBodies[i];
+        auto& result = dataReceiver[i];
+
+        result.Body = bodyWrapper;
+
+        if (bodyWrapper != nullptr) [[likely]]
+        {
+            std::memcpy(result.BodyUserData.data(), bodyWrapper->GetUserData().data(), result.BodyUserData.size());
+        }
+        else
+        {
+            std::memset(result.BodyUserData.data(), 0, result.BodyUserData.size());
+        }
+
+        result.SubShapeData = COLLISION_UNKNOWN_SUB_SHAPE;
+        result.HitFraction = distance;
+    }
+
+    return resultCount;
+}
+
+// ------------------------------------ //
+/// Jolt shape queries are given the transform of the center of mass of the shape
+static inline JPH::RMat44 ShapeQueryTransform(const JPH::Shape& shape, JPH::RVec3Arg position, JPH::QuatArg rotation)
+{
+    return JPH::RMat44::sRotationTranslation(rotation, position).PreTranslated(shape.GetCenterOfMass());
+}
+
+int PhysicalWorld::CollideShape(const JPH::Shape& shape, JPH::RVec3 position, JPH::Quat rotation,
+    PhysicsShapeHitWithUserData dataReceiver[], int maxHits, uint32_t layerMask, PhysicsBody* const* ignoredBodies,
+    int ignoreCount) const
+{
+    if (maxHits < 1 || dataReceiver == nullptr) [[unlikely]]
+    {
+        LOG_ERROR("Physics shape query given no storage space for results");
+        return 0;
+    }
+
+    ArrayShapeHitCollector<JPH::CollideShapeCollector> collector{dataReceiver, maxHits, GetQueryLockInterface()};
+
+    physicsSystem->GetNarrowPhaseQuery().CollideShape(&shape, JPH::Vec3::sReplicate(1.0f),
+        ShapeQueryTransform(shape, position, rotation), JPH::CollideShapeSettings(), position, collector,
+        BroadPhaseLayerMaskFilter(layerMask), ObjectLayerMaskFilter(layerMask),
+        IgnoredBodiesFilter(ignoredBodies, ignoreCount));
+
+    return collector.GetHitCount();
+}
+
+int PhysicalWorld::CastShape(const JPH::Shape& shape, JPH::RVec3 position, JPH::Quat rotation, JPH::Vec3 direction,
+    PhysicsShapeHitWithUserData dataReceiver[], int maxHits, uint32_t layerMask, PhysicsBody* const* ignoredBodies,
+    int ignoreCount) const
+{
+    if (maxHits < 1 || dataReceiver == nullptr) [[unlikely]]
+    {
+        LOG_ERROR("Physics shape query given no storage space for results");
+        return 0;
+    }
+
+    ArrayShapeHitCollector<JPH::CastShapeCollector> collector{dataReceiver, maxHits, GetQueryLockInterface()};
+
+    const auto shapeCast = JPH::RShapeCast::sFromWorldTransform(
+        &shape, JPH::Vec3::sReplicate(1.0f), ShapeQueryTransform(shape, position, rotation), direction);
+
+    physicsSystem->GetNarrowPhaseQuery().CastShape(shapeCast, JPH::ShapeCastSettings(), position, collector,
+        BroadPhaseLayerMaskFilter(layerMask), ObjectLayerMaskFilter(layerMask),
+        IgnoredBodiesFilter(ignoredBodies, ignoreCount));
+
+    return collector.GetHitCount();
+}
+
+/// \brief Runs a batch of shape queries in parallel, each query writes its hits to its own part of the results
+template<class BaseCollector, class QueryCallback>
+static int RunShapeQueryBatch(const PhysicsShapeQuery* queries, int count, PhysicsShapeHitWithUserData results[],
+    int32_t* hitCountsReceiver, int maxHitsPerQuery, const JPH::BodyLockInterface& lockInterface,
+    const QueryCallback& runQuery)
+{
+    if (count <= 0)
+        return 0;
+
+    if (maxHitsPerQuery < 1 || results == nullptr || hitCountsReceiver == nullptr) [[unlikely]]
+    {
+        LOG_ERROR("Physics batch shape query given no storage space for results");
+        return 0;
+    }
+
+    // Shape queries are heavier than rays so these are handed out in smaller batches
+    ParallelFor(0, count, 4,
+        [&](int64_t rangeStart, int64_t rangeEnd)
+        {
+            for (auto i = rangeStart; i < rangeEnd; ++i)
+            {
+                const auto& shapeQuery = queries[i];
+
+                ArrayShapeHitCollector<BaseCollector> collector{
+                    results + i * maxHitsPerQuery, maxHitsPerQuery, lockInterface};
+
+                if (shapeQuery.Shape != nullptr) [[likely]]
+                    runQuery(shapeQuery, collector);
+
+                hitCountsReceiver[i] = collector.GetHitCount();
+            }
+        });
+
+    int totalHits = 0;
+
+    for (int i = 0; i < count; ++i)
+        totalHits += hitCountsReceiver[i];
+
+    return totalHits;
+}
+
+int PhysicalWorld::CollideShapesBatch(const PhysicsShapeQuery* queries, int count,
+    PhysicsShapeHitWithUserData results[], int32_t* hitCountsReceiver, int maxHitsPerQuery, uint32_t layerMask,
+    PhysicsBody* const* ignoredBodies, int ignoreCount) const
+{
+    const auto& query = physicsSystem->GetNarrowPhaseQuery();
+
+    const BroadPhaseLayerMaskFilter broadPhaseFilter(layerMask);
+    const ObjectLayerMaskFilter objectLayerFilter(layerMask);
+    const IgnoredBodiesFilter bodyFilter(ignoredBodies, ignoreCount);
+    const JPH::CollideShapeSettings settings;
+
+    return RunShapeQueryBatch<JPH::CollideShapeCollector>(queries, count, results, hitCountsReceiver, maxHitsPerQuery,
+        GetQueryLockInterface(),
+        [&](const PhysicsShapeQuery& shapeQuery, JPH::CollideShapeCollector& collector)
+        {
+            query.CollideShape(shapeQuery.Shape, JPH::Vec3::sReplicate(1.0f),
+                ShapeQueryTransform(*shapeQuery.Shape, shapeQuery.Position, shapeQuery.Rotation), settings,
+                shapeQuery.Position, collector, broadPhaseFilter, objectLayerFilter, bodyFilter);
+        });
+}
+
+int PhysicalWorld::CastShapesBatch(const PhysicsShapeQuery* queries, int count, PhysicsShapeHitWithUserData results[],
+    int32_t* hitCountsReceiver, int maxHitsPerQuery, uint32_t layerMask, PhysicsBody* const* ignoredBodies,
+    int ignoreCount) const
+{
+    const auto& query = physicsSystem->GetNarrowPhaseQuery();
+
+    const BroadPhaseLayerMaskFilter broadPhaseFilter(layerMask);
+    const ObjectLayerMaskFilter objectLayerFilter(layerMask);
+    const IgnoredBodiesFilter bodyFilter(ignoredBodies, ignoreCount);
+    const JPH::ShapeCastSettings settings;
+
+    return RunShapeQueryBatch<JPH::CastShapeCollector>(queries, count, results, hitCountsReceiver, maxHitsPerQuery,
+        GetQueryLockInterface(),
+        [&](const PhysicsShapeQuery& shapeQuery, JPH::CastShapeCollector& collector)
+        {
+            const auto shapeCast = JPH::RShapeCast::sFromWorldTransform(shapeQuery.Shape, JPH::Vec3::sReplicate(1.0f),
+                ShapeQueryTransform(*shapeQuery.Shape, shapeQuery.Position, shapeQuery.Rotation),
+                shapeQuery.Direction);
+
+            query.CastShape(shapeCast, settings, shapeQuery.Position, collector, broadPhaseFilter, objectLayerFilter,
+                bodyFilter);
+        });
+}
+
+// ------------------------------------ //
+void PhysicalWorld::SetGravity(JPH::Vec3 newGravity)
+{
+    pimpl->gravity = newGravity;
+
+    physicsSystem->SetGravity(pimpl->gravity);
+}
+
+void PhysicalWorld::RemoveGravity()
+{
+    SetGravity(JPH::Vec3(0, 0, 0));
+}
+
+// ------------------------------------ //
+bool PhysicalWorld::DumpSystemState(std::string_view path)
+{
+    // Dump a Jolt snapshot to the path
+    JPH::Ref<JPH::PhysicsScene> scene = new JPH::PhysicsScene();
+    scene->FromPhysicsSystem(physicsSystem.get());
+
+    std::ofstream stream(path.data(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+    JPH::StreamOutWrapper wrapper(stream);
+
+    if (stream.is_open()) [[likely]]
+    {
+        scene->SaveBinaryState(wrapper, true, true);
+    }
+    else
+    {
+        LOG_ERROR(std::string("Can't dump physics state to non-writable file at: ") + path.data());
+        return false;
+    }
+
+    return true;
+}
+
+/// \brief Identifies which bodies a world has for checking that a snapshot is restored to a world with the same
+/// bodies. Jolt can only detect some mismatches and only after it has already partially restored the state.
+static uint64_t HashBodyIDs(const JPH::PhysicsSystem& physicsSystem)
+{
+    // Kept per thread to not allocate memory each time
+    thread_local JPH::BodyIDVector bodyIds;
+    physicsSystem.GetBodies(bodyIds);
+
+    const auto bodyIdCount = static_cast<uint32_t>(bodyIds.size());
+    uint64_t hash = JPH::HashBytes(&bodyIdCount, sizeof(bodyIdCount));
+
+    for (const auto bodyId : bodyIds)
+    {
+        const auto idValue = bodyId.GetIndexAndSequenceNumber();
+        hash = JPH::HashBytes(&idValue, sizeof(idValue), hash);
+    }
+
+    return hash;
+}
+
+int PhysicalWorld::SaveSimulationSnapshot(uint8_t* buffer, int bufferLength, bool delta)
+{
+    if (runningBackgroundSimulation)
+    {
+        LOG_ERROR("Physics snapshot can't be saved while background simulation is running");
+        return SNAPSHOT_ERROR;
+    }
+
+    JPH::StateRecorderImpl recorder;
+    recorder.Write(HashBodyIDs(*physicsSystem));
+    physicsSystem->SaveState(recorder);
+
+    auto rawState = recorder.GetData();
+
+    auto& encoded = pimpl->encodedState;
+    pimpl->stateEncoder.Encode(rawState, delta, encoded);
+
+    const auto size = static_cast<int>(encoded.size());
+
+    if (buffer == nullptr || bufferLength < size)
+        return -size;
+
+    std::memcpy(buffer, encoded.data(), encoded.size());
+
+    pimpl->stateEncoder.SetBase(std::move(rawState));
+    return size;
+}
+
+bool PhysicalWorld::RestoreSimulationSnapshot(const uint8_t* data, int length)
+{
+    if (runningBackgroundSimulation)
+    {
+        LOG_ERROR("Physics snapshot can't be restored while background simulation is running");
+        return false;
+    }
+
+    std::string rawState;
+
+    if (length <= 0 || !pimpl->stateEncoder.Decode(data, static_cast<size_t>(length), rawState))
+    {
+        LOG_ERROR("Physics snapshot to restore is invalid or a delta against a different snapshot");
+        return false;
+    }
+
+    JPH::StateRecorderImpl recorder;
+    recorder.WriteBytes(rawState.data(), rawState.size());
+
+    uint64_t savedBodiesHash = 0;
+    recorder.Read(savedBodiesHash);
+
+    // Checked before restoring anything so that a mismatch doesn't leave the world partially restored
+    if (recorder.IsFailed() || savedBodiesHash != HashBodyIDs(*physicsSystem))
+    {
+        LOG_ERROR("Physics snapshot can't be restored as it was saved with different bodies than this world has");
+        return false;
+    }
+
+    if (!physicsSystem->RestoreState(recorder))
+    {
+        LOG_ERROR("Restoring physics snapshot failed even though the world has the same bodies as the snapshot");
+        return false;
+    }
+
+    pimpl->stateEncoder.SetBase(std::move(rawState));
+    changesToBodies = true;
+    return true;
+}
+
+// ------------------------------------ //
+void PhysicalWorld::SetDeterministicMode(bool enabled)
+{
+    if (runningBackgroundSimulation)
+    {
+        LOG_ERROR("Deterministic mode can't be changed while background simulation is running");
+        return;
+    }
+
+    // Jolt itself is always deterministic (mDeterministicSimulation is never turned off), this mode only makes the
+    // multithreaded parts of this class run in a fixed order
+    deterministicMode = enabled;
+}
+
+void PhysicalWorld::SetStepStateHashing(bool enabled)
+{
+    if (runningBackgroundSimulation)
+    {
+        LOG_ERROR("Step state hashing can't be changed while background simulation is running");
+        return;
+    }
+
+    stepStateHashing = enabled;
+    stepStateHashChain = 0;
+}
+
+uint64_t PhysicalWorld::ComputeStateHash() const
+{
+    // Kept per thread to not allocate memory each time
+    thread_local JPH::BodyIDVector bodyIds;
+
+    // The bodies are returned in the order of their indexes, which only depends on the operations done on the world,
+    // so this doesn't need sorting
+    physicsSystem->GetBodies(bodyIds);
+
+    const auto& lockInterface = physicsSystem->GetBodyLockInterfaceNoLock();
+
+    const auto bodyIdCount = static_cast<uint32_t>(bodyIds.size());
+    uint64_t hash = JPH::HashBytes(&bodyIdCount, sizeof(bodyIdCount));
+
+    for (const auto bodyId : bodyIds)
+    {
+        const auto* body = lockInterface.TryGetBody(bodyId);
+
+        if (body == nullptr) [[unlikely]]
+            continue;
+
+        const auto position = body->GetPosition();
+        const auto rotation = body->GetRotation();
+        const auto velocity = body->GetLinearVelocity();
+        const auto angularVelocity = body->GetAngularVelocity();
+
+        // Individual components are hashed as the vector types have unused padding components
+        const std::array<double, 3> positionData{position.GetX(), position.GetY(), position.GetZ()};
+        const std::array<float, 10> otherData{rotation.GetX(), rotation.GetY(), rotation.GetZ(), rotation.GetW(),
+            velocity.GetX(), velocity.GetY(), velocity.GetZ(), angularVelocity.GetX(), angularVelocity.GetY(),
+            angularVelocity.GetZ()};
 
-void PhysicalWorld::AddCollisionFilter(PhysicsBody& body, CollisionFilterCallback callback)
-{
-    body.SetCollisionFilter(callback);
+        const auto idValue = bodyId.GetIndexAndSequenceNumber();
 
-    if (body.MarkCollisionFilterCallbackUsed())
-    {
-        UpdateBodyUserPointer(body);
+        hash = JPH::HashBytes(&idValue, sizeof(idValue), hash);
+        hash = JPH::HashBytes(positionData.data(), sizeof(positionData), hash);
+        hash = JPH::HashBytes(otherData.data(), sizeof(otherData), hash);
     }
+
+    return hash;
 }
 
-void PhysicalWorld::DisableCollisionFilter(PhysicsBody& body)
+// ------------------------------------ //
+bool PhysicalWorld::ResizeCapacity(
+    unsigned int newMaxBodies, unsigned int newMaxBodyPairs, unsigned int newMaxContactConstraints)
 {
-    if (body.MarkCollisionFilterCallbackDisabled())
+    if (runningBackgroundSimulation)
     {
-        UpdateBodyUserPointer(body);
+        LOG_ERROR("Physics world capacity can't be changed while background simulation is running");
+        return false;
     }
 
-    body.RemoveCollisionFilter();
-}
+    JPH::BodyIDVector bodyIds;
+    physicsSystem->GetBodies(bodyIds);
 
-// ------------------------------------ //
-Ref<TrackedConstraint> PhysicalWorld::CreateAxisLockConstraint(PhysicsBody& body, JPH::Vec3 axis, bool lockRotation)
-{
-    JPH::BodyLockWrite lock(physicsSystem->GetBodyLockInterface(), body.GetId());
-    if (!lock.Succeeded()) [[unlikely]]
+    // Bodies keep their IDs so all of the used body indexes need to fit in the new system
+    for (const auto bodyId : bodyIds)
     {
-        LOG_ERROR("Locking body for adding a constraint failed");
-        return nullptr;
+        if (bodyId.GetIndex() >= newMaxBodies)
+        {
+            LOG_ERROR("Physics world body capacity can't be made smaller than the highest used body index");
+            return false;
+        }
     }
 
-    JPH::SixDOFConstraintSettings constraintSettings;
+    const auto oldMaxBodies = maxBodies;
+    const auto oldMaxBodyPairs = maxBodyPairs;
+    const auto oldMaxContactConstraints = maxContactConstraints;
 
-    // This was in an example at https://github.com/jrouwe/JoltPhysics/issues/359 but would require some extra
-    // space calculation so this is left out
-    // constraintSettings.mSpace = JPH::EConstraintSpace::LocalToBodyCOM;
+    maxBodies = std::max(newMaxBodies, 1U);
+    maxBodyPairs = std::max(newMaxBodyPairs, 1U);
+    maxContactConstraints = std::max(newMaxContactConstraints, 1U);
 
-    if (axis.GetX() != 0)
-        constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::TranslationX);
+    auto newSystem = CreatePhysicsSystem();
 
-    if (axis.GetY() != 0)
-        constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::TranslationY);
+    // Nothing else may use the world while this runs so locking is not needed
+    const auto& oldLockInterface = physicsSystem->GetBodyLockInterfaceNoLock();
+    auto& newBodyInterface = newSystem->GetBodyInterfaceNoLock();
+    const auto& newLockInterface = newSystem->GetBodyLockInterfaceNoLock();
 
-    if (axis.GetZ() != 0)
-        constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::TranslationZ);
+    JPH::BodyIDVector bodiesToAdd;
+    JPH::BodyIDVector bodiesToActivate;
+    std::vector<TrackedConstraint*> constraints;
 
-    if (lockRotation)
+    bool failed = false;
+
+    for (const auto bodyId : bodyIds)
     {
-        if (axis.GetX() != 0)
+        const auto* oldBody = oldLockInterface.TryGetBody(bodyId);
+
+        if (oldBody == nullptr) [[unlikely]]
+            continue;
+
+        // The creation settings include the user data so the body stays linked to its PhysicsBody
+        if (newBodyInterface.CreateBodyWithID(bodyId, oldBody->GetBodyCreationSettings()) == nullptr) [[unlikely]]
         {
-            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationY);
-            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationZ);
+            failed = true;
+            break;
         }
 
-        if (axis.GetY() != 0)
+        if (oldBody->IsInBroadPhase())
         {
-            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationX);
-            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationZ);
+            bodiesToAdd.push_back(bodyId);
+
+            if (oldBody->IsActive())
+                bodiesToActivate.push_back(bodyId);
         }
 
-        if (axis.GetZ() != 0)
+        if (const auto* wrapper = PhysicsBody::FromJoltBody(oldBody); wrapper != nullptr) [[likely]]
         {
-            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationY);
-            constraintSettings.MakeFixedAxis(JPH::SixDOFConstraintSettings::RotationZ);
+            for (const auto& constraint : wrapper->constraintsThisIsPartOf)
+                constraints.push_back(constraint.get());
         }
     }
 
-    // Needed for precision on the axis lock to actually stay relatively close to the target value
-    constraintSettings.mPosition1 = constraintSettings.mPosition2 = lock.GetBody().GetCenterOfMassPosition();
+    // Constraints point directly to the bodies so they need to be recreated for the new bodies
+    std::sort(constraints.begin(), constraints.end());
+    constraints.erase(std::unique(constraints.begin(), constraints.end()), constraints.end());
 
-    auto constraintPtr = (JPH::SixDOFConstraint*)constraintSettings.Create(JPH::Body::sFixedToWorld, lock.GetBody());
+    std::vector<JPH::Ref<JPH::Constraint>> newConstraints;
+    newConstraints.reserve(constraints.size());
 
-#ifdef USE_OBJECT_POOLS
-    auto trackedConstraint =
-        ConstructFromGlobalPool<TrackedConstraint>(JPH::Ref<JPH::Constraint>(constraintPtr), Ref<PhysicsBody>(&body));
-#else
-    auto trackedConstraint = Ref<TrackedConstraint>(
-        new TrackedConstraint(JPH::Ref<JPH::Constraint>(constraintPtr), Ref<PhysicsBody>(&body)));
-#endif
+    const auto mapBody = [&newLockInterface](JPH::Body* oldBody) -> JPH::Body*
+    {
+        if (oldBody == &JPH::Body::sFixedToWorld)
+            return oldBody;
 
-    if (body.IsInWorld() && !body.IsDetached())
+        return newLockInterface.TryGetBody(oldBody->GetID());
+    };
+
+    for (const auto* constraint : constraints)
     {
-        // Immediately register the constraint if the body is in the world currently
+        if (failed)
+            break;
 
-        // TODO: multithreaded adding?
-        physicsSystem->AddConstraint(trackedConstraint->GetConstraint().GetPtr());
-        trackedConstraint->OnRegisteredToWorld(*this);
+        const auto& oldConstraint = constraint->GetConstraint();
+
+        // All of our constraint types are two body constraints (single body ones are attached to the world)
+        if (oldConstraint->GetType() != JPH::EConstraintType::TwoBodyConstraint) [[unlikely]]
+        {
+            failed = true;
+            break;
+        }
+
+        const auto* oldTwoBodyConstraint = static_cast<const JPH::TwoBodyConstraint*>(oldConstraint.GetPtr());
+
+        auto* body1 = mapBody(oldTwoBodyConstraint->GetBody1());
+        auto* body2 = mapBody(oldTwoBodyConstraint->GetBody2());
+
+        if (body1 == nullptr || body2 == nullptr) [[unlikely]]
+        {
+            failed = true;
+            break;
+        }
+
+        const auto settings = oldConstraint->GetConstraintSettings();
+
+        newConstraints.emplace_back(static_cast<JPH::TwoBodyConstraintSettings&>(*settings).Create(*body1, *body2));
     }
 
-    return trackedConstraint;
-}
+    if (failed) [[unlikely]]
+    {
+        // The old system is still intact, so just keep using it
+        LOG_ERROR("Failed to move bodies and constraints to a resized physics system");
 
-void PhysicalWorld::DestroyConstraint(TrackedConstraint& constraint)
-{
-    // TODO: allow multithreading
-    physicsSystem->RemoveConstraint(constraint.GetConstraint().GetPtr());
-    constraint.OnDestroyByWorld(*this);
-}
+        maxBodies = oldMaxBodies;
+        maxBodyPairs = oldMaxBodyPairs;
+        maxContactConstraints = oldMaxContactConstraints;
+        return false;
+    }
 
-// ------------------------------------ //
-std::optional<std::tuple<float, JPH::Vec3, JPH::BodyID>> PhysicalWorld::CastRay(JPH::RVec3 start, JPH::Vec3 endOffset)
-{
-    // The Jolt samples app has some really nice alternative cast modes that could be added in the future
+    // Adding reorders the list but that doesn't matter here
+    if (!bodiesToAdd.empty())
+    {
+        const auto addCount = static_cast<int>(bodiesToAdd.size());
 
-    JPH::RRayCast ray{start, endOffset};
+        const auto addState = newBodyInterface.AddBodiesPrepare(bodiesToAdd.data(), addCount);
+        newBodyInterface.AddBodiesFinalize(bodiesToAdd.data(), addCount, addState, JPH::EActivation::DontActivate);
+    }
 
-    // Cast ray
-    JPH::RayCastResult hit;
+    if (!bodiesToActivate.empty())
+        newBodyInterface.ActivateBodies(bodiesToActivate.data(), static_cast<int>(bodiesToActivate.size()));
 
-    // TODO: could ignore certain groups
-    bool hitSomething = physicsSystem->GetNarrowPhaseQuery().CastRay(ray, hit);
+    for (size_t i = 0; i < constraints.size(); ++i)
+    {
+        auto* constraint = constraints[i];
 
-    if (!hitSomething)
-        return {};
+        if (constraint->IsCreatedInWorld())
+        {
+            physicsSystem->RemoveConstraint(constraint->GetConstraint().GetPtr());
+            newSystem->AddConstraint(newConstraints[i].GetPtr());
+        }
 
-    const auto resultPosition = ray.GetPointOnRay(hit.mFraction);
-    const auto resultFraction = hit.mFraction;
-    const auto resultID = hit.mBodyID;
+        constraint->ReplaceConstraint(newConstraints[i]);
+    }
 
-    // Could do something with the hit sub-shape
-    // hit.mSubShapeID2
+    newSystem->OptimizeBroadPhase();
 
-    // Or material
-    // JPH::BodyLockRead lock(physicsSystem->GetBodyLockInterface(), hit.mBodyID);
-    // if (lock.Succeeded())
-    // {
-    //     const JPH::Body& resultBody = lock.GetBody();
-    //     const JPH::PhysicsMaterial* material = resultBody.GetShape()->GetMaterial(hit.mSubShapeID2);
-    // }
-    // else
-    // {
-    //     LOG_ERROR("Failed to get body read lock for ray cast");
-    // }
+    // Destroying the old system frees the old bodies, our body wrappers are not touched
+    physicsSystem = std::move(newSystem);
 
-    return std::tuple<float, JPH::Vec3, JPH::BodyID>(resultFraction, resultPosition, resultID);
+    growBodiesPending = false;
+    growBodyPairsPending = false;
+    growContactConstraintsPending = false;
+
+    LOG_INFO("Rebuilt physics system with new capacity, bodies: " + std::to_string(maxBodies) +
+        ", body pairs: " + std::to_string(maxBodyPairs) +
+        ", contact constraints: " + std::to_string(maxContactConstraints));
+
+    return true;
 }
 
-int PhysicalWorld::CastRayGetAllUserData(
-    JPH::RVec3 start, JPH::Vec3 endOffset, PhysicsRayWithUserData* dataReceiver, int maxHits)
+void PhysicalWorld::CheckBodyCapacity()
 {
-    if (maxHits < 1 || dataReceiver == nullptr)
+    if (!autoCapacityGrowth) [[likely]]
+        return;
+
+    // Growing is requested well before the limit as it only happens on the next update, and body creation fails
+    // entirely when the limit is reached
+    if (physicsSystem->GetNumBodies() <= maxBodies - maxBodies / 4) [[likely]]
+        return;
+
+    growBodiesPending.store(true, std::memory_order_relaxed);
+}
+
+void PhysicalWorld::ApplyPendingCapacityGrowth()
+{
+    const auto grow = [](bool pending, unsigned int current, unsigned int limit)
     {
-        LOG_ERROR("Physics ray collection given no storage space for results");
-        return 0;
-    }
+        if (!pending || current >= limit)
+            return current;
 
-    JPH::RRayCast ray{start, endOffset};
+        return std::min(current * 2, limit);
+    };
 
-    ArrayRayCollector rayCollector{dataReceiver, maxHits, physicsSystem->GetBodyLockInterface()};
+    auto newMaxBodies = maxBodies;
 
-    JPH::RayCastSettings settings;
+    if (growBodiesPending.load(std::memory_order_relaxed))
+    {
+        const auto bodyCount = physicsSystem->GetNumBodies();
 
-    // TODO: should the option to treat convex as solid be set to false?
-    // settings.mTreatConvexAsSolid = false;
+        do
+        {
+            newMaxBodies = grow(true, newMaxBodies, MAX_AUTO_GROWTH_BODIES);
+        } while (bodyCount > newMaxBodies - newMaxBodies / 4 && newMaxBodies < MAX_AUTO_GROWTH_BODIES);
+    }
 
-    // TODO: could ignore certain groups
-    physicsSystem->GetNarrowPhaseQuery().CastRay(ray, settings, rayCollector);
+    const auto newMaxBodyPairs = grow(growBodyPairsPending, maxBodyPairs, MAX_AUTO_GROWTH_BODY_PAIRS);
+    const auto newMaxContactConstraints =
+        grow(growContactConstraintsPending, maxContactConstraints, MAX_AUTO_GROWTH_CONTACT_CONSTRAINTS);
 
-    return rayCollector.GetHitCount();
+    growBodiesPending = false;
+    growBodyPairsPending = false;
+    growContactConstraintsPending = false;
+
+    if (newMaxBodies == maxBodies && newMaxBodyPairs == maxBodyPairs &&
+        newMaxContactConstraints == maxContactConstraints) [[unlikely]]
+    {
+        LOG_WARNING("Physics world ran out of space but it is already at the maximum automatic growth capacity");
+        return;
+    }
+
+    ResizeCapacity(newMaxBodies, newMaxBodyPairs, newMaxContactConstraints);
 }
 
 // ------------------------------------ //
-void PhysicalWorld::SetGravity(JPH::Vec3 newGravity)
+void PhysicalWorld::StepAllPhysicsStepsInBackground()
 {
-    pimpl->gravity = newGravity;
+    backgroundSimulatedTime += StepElapsedTime();
 
-    physicsSystem->SetGravity(pimpl->gravity);
+    // This notifies while holding the lock as the main thread may destroy this world as soon as it sees the flag
+    Lock lock(pimpl->backgroundSimulationMutex);
+    runningBackgroundSimulation = false;
+    pimpl->backgroundSimulationDone.notify_all();
 }
 
-void PhysicalWorld::RemoveGravity()
+void PhysicalWorld::WaitForBackgroundSimulationEnd()
 {
-    SetGravity(JPH::Vec3(0, 0, 0));
-}
+    // Usually the physics should be done by the time the main thread gets here or very close to done, so this first
+    // spins for a bit before falling back to sleeping
+    auto& backoff = pimpl->backgroundWaitBackoff;
+    bool parked = false;
 
-// ------------------------------------ //
-bool PhysicalWorld::DumpSystemState(std::string_view path)
-{
-    // Dump a Jolt snapshot to the path
-    JPH::Ref<JPH::PhysicsScene> scene = new JPH::PhysicsScene();
-    scene->FromPhysicsSystem(physicsSystem.get());
+    while (runningBackgroundSimulation)
+    {
+        if (!backoff.Wait())
+            continue;
 
-    std::ofstream stream(path.data(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
-    JPH::StreamOutWrapper wrapper(stream);
+        std::unique_lock<Mutex> lock(pimpl->backgroundSimulationMutex);
+        pimpl->backgroundSimulationDone.wait(lock, [this]() { return !runningBackgroundSimulation; });
+        parked = true;
+        break;
+    }
 
-    if (stream.is_open()) [[likely]]
+    if (parked)
     {
-        scene->SaveBinaryState(wrapper, true, true);
+        backoff.OnParked();
     }
     else
     {
-        LOG_ERROR(std::string("Can't dump physics state to non-writable file at: ") + path.data());
-        return false;
-    }
+        backoff.OnSuccess();
 
-    return true;
+        // The background thread sets the flag while holding the lock, so this makes sure it is not touching this
+        // object anymore
+        Lock lock(pimpl->backgroundSimulationMutex);
+    }
 }
 
-// ------------------------------------ //
-void PhysicalWorld::StepAllPhysicsStepsInBackground()
+float PhysicalWorld::StepElapsedTime()
 {
     const auto singlePhysicsFrame = 1 / physicsFrameRate;
 
-    while (elapsedSinceUpdate > singlePhysicsFrame)
+    if (elapsedSinceUpdate <= singlePhysicsFrame)
+        return 0;
+
+    auto pendingSteps = static_cast<int>(elapsedSinceUpdate / singlePhysicsFrame);
+
+    // Keep the remainder strictly positive like stepping one frame at a time would
+    if (static_cast<float>(pendingSteps) * singlePhysicsFrame >= elapsedSinceUpdate)
+        --pendingSteps;
+
+    int stepCount = pendingSteps;
+    int framesPerStep = 1;
+
+    if (maxStepsPerUpdate > 0 && pendingSteps > maxStepsPerUpdate) [[unlikely]]
     {
-        elapsedSinceUpdate -= singlePhysicsFrame;
-        backgroundSimulatedTime += singlePhysicsFrame;
-        StepPhysics(singlePhysicsFrame);
+        // Merge steps to catch up (but only as much as allowed) to keep the number of expensive updates bounded
+        framesPerStep =
+            std::min(maxCatchUpStepMultiplier, (pendingSteps + maxStepsPerUpdate - 1) / maxStepsPerUpdate);
+
+        stepCount = std::min(maxStepsPerUpdate, pendingSteps / framesPerStep);
+
+        // If the backlog doesn't fit even with merging, it is dropped to not get further and further behind
+        const auto remainingSteps = pendingSteps - stepCount * framesPerStep;
+
+        if (remainingSteps >= framesPerStep)
+            elapsedSinceUpdate -= static_cast<float>(remainingSteps) * singlePhysicsFrame;
     }
 
-    runningBackgroundSimulation = false;
+    const auto stepTime = singlePhysicsFrame * static_cast<float>(framesPerStep);
+
+    // More collision steps keep the longer steps as stable as the normal length ones
+    const auto collisionSteps = collisionStepsPerUpdate * framesPerStep;
+
+    float simulatedTime = 0;
+
+    for (int i = 0; i < stepCount; ++i)
+    {
+        elapsedSinceUpdate -= stepTime;
+        simulatedTime += stepTime;
+        StepPhysics(stepTime, collisionSteps);
+    }
+
+    // Only the state after the last step is interesting to read
+    if (pimpl->bodySnapshot && stepCount > 0)
+        pimpl->bodySnapshot->Write(*physicsSystem);
+
+    return simulatedTime;
 }
 
 // ------------------------------------ //
-void PhysicalWorld::StepPhysics(float time)
+void PhysicalWorld::StepPhysics(float time, int collisionSteps)
 {
     if (changesToBodies) [[unlikely]]
     {
@@ -1251,7 +2578,7 @@ void PhysicalWorld::StepPhysics(float time)
     // TODO: ensure that our custom task system is not (much) slower than the Jolt inbuilt one
     auto& jobExecutor = TaskSystem::Get();
 
-    const auto result = physicsSystem->Update(time, collisionStepsPerUpdate, tempAllocator.get(), &jobExecutor);
+    const auto result = physicsSystem->Update(time, collisionSteps, tempAllocator.get(), &jobExecutor);
 
     nextStepIsFresh = false;
 
@@ -1274,6 +2601,26 @@ void PhysicalWorld::StepPhysics(float time)
             LOG_ERROR("Physics update error: unknown");
     }
 
+    // The result is a bit field so multiple of the errors can happen at once. The manifold cache is sized based on
+    // both of the limits.
+    if (autoCapacityGrowth && result != JPH::EPhysicsUpdateError::None) [[unlikely]]
+    {
+        const auto errors = static_cast<uint32_t>(result);
+        const bool manifoldsFull = errors & static_cast<uint32_t>(JPH::EPhysicsUpdateError::ManifoldCacheFull);
+
+        if (manifoldsFull || errors & static_cast<uint32_t>(JPH::EPhysicsUpdateError::BodyPairCacheFull))
+            growBodyPairsPending = true;
+
+        if (manifoldsFull || errors & static_cast<uint32_t>(JPH::EPhysicsUpdateError::ContactConstraintsFull))
+            growContactConstraintsPending = true;
+    }
+
+    if (stepStateHashing) [[unlikely]]
+    {
+        const auto stateHash = ComputeStateHash();
+        stepStateHashChain = JPH::HashBytes(&stateHash, sizeof(stateHash), stepStateHashChain);
+    }
+
     latestPhysicsTime = elapsed;
 
     averagePhysicsTime = pimpl->AddAndCalculateAverageTime(elapsed);
@@ -1299,20 +2646,62 @@ void PhysicalWorld::PerformPhysicsStepOperations(float delta)
     // Apply per-step physics body state
 
     // This is locked just for safety, but it should be the case that no physics modify operations should be allowed
-    // once physics runs have started
+    // once physics runs have started. The list is copied so that the lock isn't held during the parallel section.
+    auto& snapshot = pimpl->stepControlSnapshot;
+
     pimpl->bodiesStepControlLock.Lock();
 
-    // TODO: multithreading if there's a ton of bodies using this
-    for (const auto& bodyPtr : pimpl->bodiesWithPerStepControl)
-    {
-        auto& body = *bodyPtr;
+    snapshot.resize(pimpl->bodiesWithPerStepControl.size());
 
-        if (body.GetBodyControlState() != nullptr) [[likely]]
-            ApplyBodyControl(body, delta);
-    }
+    for (size_t i = 0; i < snapshot.size(); ++i)
+        snapshot[i] = pimpl->bodiesWithPerStepControl[i].get();
 
     pimpl->bodiesStepControlLock.Unlock();
 
+    const auto& controlledBodies = snapshot;
+    auto& activations = pimpl->bodyControlActivations;
+    activations.clear();
+
+    // Each body is quite little work, so small numbers of bodies end up being processed on just this thread. Waiting
+    // for the parallel work only helps with the chunks of this loop so this doesn't block the physics step on
+    // unrelated tasks.
+    ParallelFor(0, static_cast<int64_t>(controlledBodies.size()), 32,
+        [&](int64_t rangeStart, int64_t rangeEnd)
+        {
+            static thread_local std::vector<JPH::BodyID> chunkActivations;
+            chunkActivations.clear();
+
+            for (auto i = rangeStart; i < rangeEnd; ++i)
+            {
+                auto& body = *controlledBodies[i];
+
+                if (body.GetBodyControlState() != nullptr) [[likely]]
+                {
+                    if (ApplyBodyControl(body, delta))
+                        chunkActivations.emplace_back(body.GetId());
+                }
+            }
+
+            if (chunkActivations.empty())
+                return;
+
+            pimpl->bodyControlActivationsLock.Lock();
+            activations.insert(activations.end(), chunkActivations.begin(), chunkActivations.end());
+            pimpl->bodyControlActivationsLock.Unlock();
+        });
+
+    snapshot.clear();
+
+    if (!activations.empty())
+    {
+        // The order chunks finish in varies, so that is not allowed to affect the simulation
+        if (deterministicMode)
+            std::sort(activations.begin(), activations.end());
+
+        physicsSystem->GetBodyInterfaceNoLock().ActivateBodies(
+            activations.data(), static_cast<int>(activations.size()));
+    }
+
     // Enable for some extreme checking of collision write data indices
     // pimpl->DebugCheckActiveCollisions();
 }
@@ -1341,6 +2730,8 @@ Ref<PhysicsBody> PhysicalWorld::CreateBody(const JPH::Shape& shape, JPH::EMotion
 
     const auto body = physicsSystem->GetBodyInterface().CreateBody(creationSettings);
 
+    CheckBodyCapacity();
+
     if (body == nullptr) [[unlikely]]
     {
         LOG_ERROR("Ran out of physics bodies");
@@ -1349,10 +2740,15 @@ Ref<PhysicsBody> PhysicalWorld::CreateBody(const JPH::Shape& shape, JPH::EMotion
 
     changesToBodies = true;
 
+    return WrapCreatedBody(*body);
+}
+
+Ref<PhysicsBody> PhysicalWorld::WrapCreatedBody(JPH::Body& body)
+{
 #ifdef USE_OBJECT_POOLS
-    return ConstructFromGlobalPool<PhysicsBody>(body, body->GetID());
+    return ConstructFromGlobalPool<PhysicsBody>(&body, body.GetID());
 #else
-    return {new PhysicsBody(body, body->GetID())};
+    return {new PhysicsBody(&body, body.GetID())};
 #endif
 }
 
@@ -1410,6 +2806,28 @@ void PhysicalWorld::OnPostBodyAdded(PhysicsBody& body)
 #endif
 }
 
+void PhysicalWorld::CreatePendingConstraints(PhysicsBody& body)
+{
+    for (auto& constraint : body.GetConstraints())
+    {
+        if (!constraint->IsCreatedInWorld())
+        {
+            // TODO: constraint creation has to be skipped if the other body the constraint is on is currently
+            // detached and created later
+            if ((constraint->optionalSecondBody != nullptr && constraint->optionalSecondBody.get() != &body &&
+                    constraint->optionalSecondBody->IsDetached()) ||
+                (constraint->firstBody.get() != &body && constraint->firstBody->IsDetached()))
+            {
+                LOG_ERROR("Not implemented handling for deferring constraint creation for detached body");
+                continue;
+            }
+
+            physicsSystem->AddConstraint(constraint->GetConstraint().GetPtr());
+            constraint->OnRegisteredToWorld(*this);
+        }
+    }
+}
+
 void PhysicalWorld::OnBodyPreLeaveWorld(PhysicsBody& body)
 {
     // TODO: allow detaching bodies to keep the constraint data intact for re-creating constraints when adding them
@@ -1448,7 +2866,7 @@ void PhysicalWorld::UpdateBodyUserPointer(const PhysicsBody& body)
 }
 
 // ------------------------------------ //
-void PhysicalWorld::ApplyBodyControl(PhysicsBody& bodyWrapper, float delta)
+bool PhysicalWorld::ApplyBodyControl(PhysicsBody& bodyWrapper, float delta)
 {
     // Normalize delta to 60Hz update rate to make gameplay logic not depend on the physics framerate
     float normalizedDelta = delta / (1 / 60.0f);
@@ -1457,13 +2875,12 @@ void PhysicalWorld::ApplyBodyControl(PhysicsBody& bodyWrapper, float delta)
     const auto bodyId = bodyWrapper.GetId();
 
     // This method is called by the step listener meaning that all bodies are already locked so this needs to be used
-    // like this. The call to activate probably needs to be protected with a lock if body control is applied in the
-    // future by multiple threads.
+    // like this. Activating is not safe from multiple threads so that is left to the caller.
     JPH::BodyLockWrite lock(physicsSystem->GetBodyLockInterfaceNoLock(), bodyId);
     if (!lock.Succeeded()) [[unlikely]]
     {
         LOG_ERROR("Couldn't lock body for applying body control");
-        return;
+        return false;
     }
 
     JPH::Body& body = lock.GetBody();
@@ -1472,9 +2889,11 @@ void PhysicalWorld::ApplyBodyControl(PhysicsBody& bodyWrapper, float delta)
     if (!body.IsInBroadPhase())
     {
         LOG_ERROR("Body not in broadphase used in body control");
-        return;
+        return false;
     }
 
+    bool needsActivation = false;
+
     if (controlState->movement.LengthSq() > 0.000001f)
     {
         body.AddImpulse(controlState->movement * normalizedDelta);
@@ -1482,9 +2901,7 @@ void PhysicalWorld::ApplyBodyControl(PhysicsBody& bodyWrapper, float delta)
         // Activate inactive bodies when controlled to ensure they cannot accumulate a lot of impulse and eventually
         // shoot off at high velocity when touched
         if (!body.IsActive())
-        {
-            physicsSystem->GetBodyInterfaceNoLock().ActivateBody(bodyId);
-        }
+            needsActivation = true;
     }
 
     // A really simple rotation matching based on JPH::Body::MoveKinematic approach. Now this doesn't seem to need
@@ -1501,7 +2918,7 @@ void PhysicalWorld::ApplyBodyControl(PhysicsBody& bodyWrapper, float delta)
 
         physicsSystem->GetBodyInterfaceNoLock().SetRotation(
             bodyId, JPH::Quat::sIdentity(), JPH::EActivation::DontActivate);
-        return;
+        return needsActivation;
     }
 #endif
 
@@ -1539,7 +2956,9 @@ void PhysicalWorld::ApplyBodyControl(PhysicsBody& bodyWrapper, float delta)
 
     // Jolt requires bodies with velocity to wake up
     if (!body.IsActive() && !angularVelocity.IsNearZero()) [[unlikely]]
-        physicsSystem->GetBodyInterfaceNoLock().ActivateBody(bodyId);
+        needsActivation = true;
+
+    return needsActivation;
 }
 
 #pragma clang diagnostic push
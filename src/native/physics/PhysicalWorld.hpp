@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <optional>
 
@@ -10,15 +12,22 @@
 #include "core/ForwardDefinitions.hpp"
 
 #include "Layers.hpp"
+#include "PhysicsBodyCommand.hpp"
+#include "PhysicsBodyCreationInfo.hpp"
 #include "PhysicsCollision.hpp"
 #include "PhysicsRayWithUserData.hpp"
+#include "PhysicsShapeHitWithUserData.hpp"
+#include "PhysicsShapeQuery.hpp"
 
 namespace JPH
 {
 class PhysicsSystem;
 class TempAllocator;
+class Body;
 class BodyID;
+class BodyLockInterface;
 class Shape;
+struct RRayCast;
 
 constexpr EAllowedDOFs AllRotationAllowed = EAllowedDOFs::RotationX | EAllowedDOFs::RotationY | EAllowedDOFs::RotationZ;
 } // namespace JPH
@@ -26,6 +35,7 @@ constexpr EAllowedDOFs AllRotationAllowed = EAllowedDOFs::RotationX | EAllowedDO
 namespace Thrive::Physics
 {
 
+class CollisionEventStream;
 class PhysicsBody;
 class StepListener;
 
@@ -41,7 +51,29 @@ class PhysicalWorld
     class Pimpl;
 
 public:
+    static constexpr unsigned int DEFAULT_MAX_BODIES = 10240;
+    static constexpr unsigned int DEFAULT_MAX_BODY_PAIRS = 65536;
+    static constexpr unsigned int DEFAULT_MAX_CONTACT_CONSTRAINTS = 20480;
+
+    /// Default limit on physics steps per Process call. At the default 60 steps per second this allows a 10 FPS game
+    /// to still simulate in real time.
+    static constexpr int DEFAULT_MAX_STEPS_PER_UPDATE = 6;
+
+    /// Automatic capacity growth doesn't go past these. Rebuilding gets slower the bigger the world is and running
+    /// into these means something is likely creating bodies without bound.
+    static constexpr unsigned int MAX_AUTO_GROWTH_BODIES = 262144;
+    static constexpr unsigned int MAX_AUTO_GROWTH_BODY_PAIRS = 1048576;
+    static constexpr unsigned int MAX_AUTO_GROWTH_CONTACT_CONSTRAINTS = 524288;
+
+    /// Returned by SaveSimulationSnapshot when a snapshot can't be saved at all
+    static constexpr int SNAPSHOT_ERROR = std::numeric_limits<int32_t>::min();
+
     PhysicalWorld();
+
+    /// \brief Creates a world with specific capacities. Small worlds (like editor previews) should use this to not
+    /// reserve memory for the full game sized capacities.
+    PhysicalWorld(unsigned int maxBodies, unsigned int maxBodyPairs, unsigned int maxContactConstraints);
+
     ~PhysicalWorld();
 
     /// \brief Process physics
@@ -89,11 +121,51 @@ public:
 
     void DestroyBody(const Ref<PhysicsBody>& body);
 
+    /// \brief Creates multiple moving or static bodies at once
+    ///
+    /// The body creation is spread over the task threads and the bodies are added to the broadphase as a single
+    /// batch, which is much faster than creating the bodies one by one.
+    /// \param bodiesReceiver Needs to have space for count bodies, bodies that failed to be created are set to null
+    /// \returns The number of successfully created bodies
+    int CreateBodiesBulk(
+        const PhysicsBodyCreationInfo* infos, int count, Ref<PhysicsBody>* bodiesReceiver, bool addToWorld);
+
+    /// \brief Variant of AddBody that adds multiple bodies as a single broadphase batch
+    void AddBodiesBulk(PhysicsBody* const* bodies, int count, bool activate);
+
+    /// \brief Variant of DestroyBody that removes all of the bodies from the broadphase at once
+    void DestroyBodiesBulk(PhysicsBody* const* bodies, int count);
+
     void SetDamping(JPH::BodyID bodyId, float damping, const float* angularDamping = nullptr);
 
     void ReadBodyTransform(JPH::BodyID bodyId, JPH::RVec3& positionReceiver, JPH::Quat& rotationReceiver) const;
     void ReadBodyVelocity(JPH::BodyID bodyId, JPH::Vec3& velocityReceiver, JPH::Vec3& angularVelocityReceiver) const;
 
+    /// \brief Reads the transforms (and velocities if the receivers are not null) of multiple bodies at once into
+    /// separate arrays of count length
+    ///
+    /// When physics is not running the bodies are not locked, so in that case no other thread may be modifying the
+    /// bodies at the same time.
+    void ReadBodiesBulk(PhysicsBody* const* bodies, int count, JPH::RVec3* positionsReceiver,
+        JPH::Quat* rotationsReceiver, JPH::Vec3* velocitiesReceiver, JPH::Vec3* angularVelocitiesReceiver) const;
+
+    /// \brief Variant of ReadBodiesBulk writing packed plain values (3 doubles per position, 4 floats per xyzw
+    /// rotation and 3 floats per velocity) so that results go directly into arrays of plain vector structs
+    void ReadBodiesBulk(PhysicsBody* const* bodies, int count, double* positionsReceiver, float* rotationsReceiver,
+        float* velocitiesReceiver, float* angularVelocitiesReceiver) const;
+
+    /// \brief Enables keeping a copy of all body transforms and velocities from the end of the latest physics update.
+    /// The copy can be read with ReadBodySnapshot even while the next update is running in the background.
+    ///
+    /// May not be called while background physics is running.
+    void SetBodySnapshotsEnabled(bool enabled);
+
+    /// \brief Reads body state from the latest snapshot without locking the body. Note that changes made to a body
+    /// directly (like setting its position) are only visible here after the next physics update.
+    /// \returns False if snapshots are not enabled or the body was not in the world when the snapshot was taken
+    bool ReadBodySnapshot(JPH::BodyID bodyId, JPH::RVec3& positionReceiver, JPH::Quat& rotationReceiver,
+        JPH::Vec3& velocityReceiver, JPH::Vec3& angularVelocityReceiver) const;
+
     // Note: there used to be activation parameters for bodies on impulse and velocity set, however activation is now
     // mandatory in Jolt, so the parameter is now always true and thus removed from the API
     void GiveImpulse(JPH::BodyID bodyId, JPH::Vec3Arg impulse);
@@ -119,6 +191,13 @@ public:
 
     void SetBodyAllowSleep(JPH::BodyID bodyId, bool allowSleeping);
 
+    /// \brief Applies many body modifications at once. This is a lot faster than calling the individual methods.
+    ///
+    /// Consecutive commands for the same body are applied while holding a single lock, so commands should be grouped
+    /// by body. Bodies needing activation are activated with a single call at the end. Body locks are always taken so
+    /// this is safe to call from any thread (and from multiple threads at once) like the individual methods.
+    void ApplyBodyCommands(const PhysicsBodyCommand* commands, int count);
+
     /// \brief Ensures body's Y coordinate is 0, if not moves it so that it is 0
     /// \returns True if the body's position changed, false if no fix was needed
     bool FixBodyYCoordinateToZero(JPH::BodyID bodyId);
@@ -130,11 +209,24 @@ public:
 
     /// \brief Starts collision recording. collisionRecordingTarget must have at least space for maxRecordedCollisions
     /// elements, otherwise this will overwrite random memory
-    const int32_t* EnableCollisionRecording(
-        PhysicsBody& body, CollisionRecordListType collisionRecordingTarget, int maxRecordedCollisions);
+    ///
+    /// When recordEndedCollisions is true, contacts ending are also recorded (with the Ended flag set) as long as the
+    /// other body still exists.
+    const int32_t* EnableCollisionRecording(PhysicsBody& body, CollisionRecordListType collisionRecordingTarget,
+        int maxRecordedCollisions, bool recordEndedCollisions = false);
 
     void DisableCollisionRecording(PhysicsBody& body);
 
+    /// \brief Enables a world-level stream of compact records of all contacts (see CollisionEventStream), 0 capacity
+    /// disables it. When many bodies need collision info this is cheaper than per-body collision recording.
+    ///
+    /// May not be called while background physics is running.
+    void SetCollisionEventStreamCapacity(uint32_t capacity);
+
+    /// \brief Gets the collision events of the latest physics update, only valid until the next update starts
+    /// \returns Null if the event stream is not enabled
+    [[nodiscard]] const CollisionEventStream* GetCollisionEvents() const;
+
     /// \brief Makes body ignore collisions with ignoredBody
     void AddCollisionIgnore(PhysicsBody& body, const PhysicsBody& ignoredBody, bool skipDuplicates);
 
@@ -161,6 +253,11 @@ public:
     /// method again with false parameter)
     void SetCollisionDisabledState(PhysicsBody& body, bool disableAllCollisions);
 
+    /// \brief Sets native group based collision filtering for a body (see PhysicsBody::SetCollisionGroup). This is
+    /// much cheaper than ignore lists or filter callbacks for things like colony members. Setting the default values
+    /// turns this off for the body.
+    void SetCollisionGroup(PhysicsBody& body, uint32_t group, uint32_t category, uint32_t mask);
+
     void AddCollisionFilter(PhysicsBody& body, CollisionFilterCallback callback);
 
     void DisableCollisionFilter(PhysicsBody& body);
@@ -181,17 +278,80 @@ public:
     // Misc
 
     /// \brief Cast a ray from start point to endOffset (i.e. end = start + endOffset)
+    /// \param layerMask Which object layers the ray can hit (see Layers::ALL_LAYERS_MASK)
     /// \returns When hit something a tuple of the fraction from start to end, the hit position, and the ID of the hit
     // body
     [[nodiscard]] std::optional<std::tuple<float, JPH::Vec3, JPH::BodyID>> CastRay(
-        JPH::RVec3 start, JPH::Vec3 endOffset);
+        JPH::RVec3 start, JPH::Vec3 endOffset, uint32_t layerMask = Layers::ALL_LAYERS_MASK);
 
     /// \brief Cast a ray from start point to start + endOffset like CastRay but find all hits (up to a limit) and
     /// return the bodies' user data with the collision info
     /// \returns The number of hits or 0 if nothing is hit. This only writes to dataReceiver up to the number of hits
     /// received everything else is untouched
-    int CastRayGetAllUserData(
-        JPH::RVec3 start, JPH::Vec3 endOffset, PhysicsRayWithUserData dataReceiver[], int maxHits);
+    /// \param ignoredBodies Optional list of bodies the ray passes through (for example the body casting the ray).
+    /// Filtered bodies are skipped before their shapes are tested, which is much cheaper than ignoring the hits.
+    int CastRayGetAllUserData(JPH::RVec3 start, JPH::Vec3 endOffset, PhysicsRayWithUserData dataReceiver[],
+        int maxHits, uint32_t layerMask = Layers::ALL_LAYERS_MASK, PhysicsBody* const* ignoredBodies = nullptr,
+        int ignoreCount = 0);
+
+    /// \brief Casts many rays at once spreading the work over the task threads. Works like CastRayGetAllUserData for
+    /// each ray.
+    /// \param results Needs to have space for count * maxHitsPerRay hits, hits of ray i start at i * maxHitsPerRay
+    /// \param hitCountsReceiver Receives the number of hits for each ray
+    /// \param layerMask Which object layers the rays can hit (see Layers::ALL_LAYERS_MASK)
+    /// \param ignoredBodies Optional list of bodies none of the rays can hit
+    /// \returns Total number of hits
+    int CastRaysBatch(const JPH::RRayCast* rays, int count, PhysicsRayWithUserData results[],
+        int32_t* hitCountsReceiver, int maxHitsPerRay, uint32_t layerMask, PhysicsBody* const* ignoredBodies = nullptr,
+        int ignoreCount = 0) const;
+
+    /// \brief Finds bodies whose bounding boxes overlap a sphere. This only uses the broadphase so this is fast but
+    /// bodies near the sphere with their bounds overlapping it are also found.
+    ///
+    /// Results are written like ray hits, but HitFraction is the distance from the center to the body position and
+    /// the sub shape is unknown.
+    /// \param layerMask Which object layers to find (see Layers::ALL_LAYERS_MASK)
+    /// \returns The number of found bodies (at most maxResults)
+    int OverlapSphere(JPH::RVec3 center, float radius, PhysicsRayWithUserData dataReceiver[], int maxResults,
+        uint32_t layerMask) const;
+
+    /// \brief Variant of OverlapSphere for an axis aligned box, the distances are from the center of the box
+    int OverlapAABB(JPH::RVec3 min, JPH::RVec3 max, PhysicsRayWithUserData dataReceiver[], int maxResults,
+        uint32_t layerMask) const;
+
+    /// \brief Finds the up to count closest bodies (by position) within maxDistance from center, sorted by distance.
+    /// Bodies are only found if their position is within maxDistance, not just their bounds.
+    int FindNearestK(JPH::RVec3 center, float maxDistance, PhysicsRayWithUserData dataReceiver[], int count,
+        uint32_t layerMask) const;
+
+    /// \brief Finds the bodies a shape placed at the given position overlaps with (exact shape vs. shape test)
+    ///
+    /// Only the deepest hit for each body is reported
+    /// \returns The number of hit bodies (at most maxHits)
+    int CollideShape(const JPH::Shape& shape, JPH::RVec3 position, JPH::Quat rotation,
+        PhysicsShapeHitWithUserData dataReceiver[], int maxHits, uint32_t layerMask,
+        PhysicsBody* const* ignoredBodies = nullptr, int ignoreCount = 0) const;
+
+    /// \brief Sweeps a shape from position to position + direction and finds the bodies it hits on the way
+    ///
+    /// Only the earliest hit for each body is reported, HitFraction tells how far along the cast the hit is
+    /// \returns The number of hit bodies (at most maxHits)
+    int CastShape(const JPH::Shape& shape, JPH::RVec3 position, JPH::Quat rotation, JPH::Vec3 direction,
+        PhysicsShapeHitWithUserData dataReceiver[], int maxHits, uint32_t layerMask,
+        PhysicsBody* const* ignoredBodies = nullptr, int ignoreCount = 0) const;
+
+    /// \brief Runs many CollideShape queries at once on the task threads. The direction of the queries is ignored.
+    /// \param results Needs to have space for count * maxHitsPerQuery hits, hits of query i start at
+    /// i * maxHitsPerQuery
+    /// \returns Total number of hits
+    int CollideShapesBatch(const PhysicsShapeQuery* queries, int count, PhysicsShapeHitWithUserData results[],
+        int32_t* hitCountsReceiver, int maxHitsPerQuery, uint32_t layerMask,
+        PhysicsBody* const* ignoredBodies = nullptr, int ignoreCount = 0) const;
+
+    /// \brief Batch variant of CastShape, works like CollideShapesBatch
+    int CastShapesBatch(const PhysicsShapeQuery* queries, int count, PhysicsShapeHitWithUserData results[],
+        int32_t* hitCountsReceiver, int maxHitsPerQuery, uint32_t layerMask,
+        PhysicsBody* const* ignoredBodies = nullptr, int ignoreCount = 0) const;
 
     [[nodiscard]] inline float GetLatestPhysicsTime() const
     {
@@ -205,6 +365,111 @@ public:
 
     bool DumpSystemState(std::string_view path);
 
+    /// \brief Saves a snapshot of the simulation state (body states, contact caches and constraint states) in a
+    /// compact binary format that can be restored with RestoreSimulationSnapshot
+    ///
+    /// This is only a snapshot of the state of the existing bodies for rolling back or replaying the simulation, not
+    /// a way to save and load a world. Which bodies and constraints exist or their shapes is not saved, and restoring
+    /// requires the world to have exactly the same bodies (with the same IDs) as when saving.
+    /// \param delta When true only the changes since the previously saved or restored snapshot are stored, restoring
+    /// that requires this world to still have the same previous snapshot as the base
+    /// \returns The number of bytes written, or if the buffer is too small then the negative of the needed size (and
+    /// nothing is written). SNAPSHOT_ERROR if saving is not possible right now (background simulation is running).
+    int SaveSimulationSnapshot(uint8_t* buffer, int bufferLength, bool delta);
+
+    /// \brief Restores a snapshot saved with SaveSimulationSnapshot. May not be called while physics is running.
+    /// \returns False if the data is invalid or this world doesn't have the same bodies as when the snapshot was saved
+    bool RestoreSimulationSnapshot(const uint8_t* data, int length);
+
+    // ------------------------------------ //
+    // Determinism
+
+    /// \brief Enables a mode where running the same operations with the same update deltas results in exactly the
+    /// same simulation regardless of the number of threads
+    ///
+    /// Jolt's own simulation is always deterministic, this makes the parts of this class that are spread over
+    /// multiple threads (bulk body creation and body control activation) happen in a fixed order, which is a bit
+    /// slower. Jolt simulation is only identical across different platforms when Jolt is built with
+    /// THRIVE_CROSS_PLATFORM_DETERMINISTIC. May not be called while physics is running.
+    void SetDeterministicMode(bool enabled);
+
+    [[nodiscard]] inline bool IsDeterministicMode() const noexcept
+    {
+        return deterministicMode;
+    }
+
+    /// \brief Calculates a hash of the transforms and velocities of all bodies. May not be called while physics is
+    /// running.
+    [[nodiscard]] uint64_t ComputeStateHash() const;
+
+    /// \brief Enables hashing the world state with ComputeStateHash after every physics step into the step state hash
+    /// chain. This is costly with many bodies so this is meant for checking determinism. Resets the chain. May not be
+    /// called while physics is running.
+    void SetStepStateHashing(bool enabled);
+
+    /// \brief Hash combined from the state hashes after each physics step since step state hashing was enabled. Two
+    /// runs with the same chain hash went through the same states.
+    [[nodiscard]] inline uint64_t GetStepStateHashChain() const noexcept
+    {
+        return stepStateHashChain;
+    }
+
+    // ------------------------------------ //
+    // Capacity
+
+    /// \brief Rebuilds the physics system with new capacities. All bodies and constraints are moved to the new
+    /// system keeping their IDs, so existing references to them stay valid.
+    ///
+    /// State that is not kept:
+    /// - Contact caches. Touching contacts are reported as just started again on the next update (without end events
+    ///   for the old contacts) and the lost contact impulses can cause a small jitter.
+    /// - Forces and impulses added since the last update and body sleep timers.
+    /// - The broadphase layout, which is optimized again after the rebuild.
+    ///
+    /// May not be called while physics is running or while anything else is accessing this world (for example body
+    /// creation on other threads).
+    /// \returns False if the new body capacity is too small for the existing bodies
+    bool ResizeCapacity(unsigned int newMaxBodies, unsigned int newMaxBodyPairs, unsigned int newMaxContactConstraints);
+
+    /// \brief When enabled the capacities are automatically doubled (by rebuilding the physics system) when the body
+    /// count gets close to the limit or a physics update runs out of contact space
+    ///
+    /// Growing is always done at the start of the next Process call (up to the MAX_AUTO_GROWTH_* limits) so body
+    /// creation never rebuilds the system. Body growth is requested once 3/4 of the bodies are used, so creating
+    /// more than the remaining quarter of bodies between two updates still fails.
+    inline void SetAutoCapacityGrowth(bool enabled) noexcept
+    {
+        autoCapacityGrowth = enabled;
+    }
+
+    [[nodiscard]] inline unsigned int GetMaxBodies() const noexcept
+    {
+        return maxBodies;
+    }
+
+    [[nodiscard]] inline unsigned int GetMaxBodyPairs() const noexcept
+    {
+        return maxBodyPairs;
+    }
+
+    [[nodiscard]] inline unsigned int GetMaxContactConstraints() const noexcept
+    {
+        return maxContactConstraints;
+    }
+
+    /// \brief Limits how many physics steps a single Process call can run (0 for no limit, default is
+    /// DEFAULT_MAX_STEPS_PER_UPDATE). This stops the time taken by lots of physics steps from causing even more
+    /// physics steps to be needed after a lag spike.
+    ///
+    /// When there is more pending time than fits in the step limit, up to maxCatchUpMultiplier pending steps are
+    /// merged into one longer step (with proportionally more collision steps). Any time that still doesn't fit is
+    /// discarded which makes the simulation run slower than real time. A multiplier of 1 disables merging steps.
+    inline void SetMaxStepsPerUpdate(int maxSteps, int maxCatchUpMultiplier) noexcept
+    {
+        maxStepsPerUpdate = std::max(maxSteps, 0);
+        maxCatchUpStepMultiplier = std::max(maxCatchUpMultiplier, 1);
+    }
+
     inline void SetDebugLevel(int level) noexcept
     {
         debugDrawLevel = level;
@@ -226,18 +491,47 @@ private:
     /// \brief Creates the physics system
     void InitPhysicsWorld();
 
+    /// \brief Creates a new physics system with the current capacities and settings that uses our listeners
+    std::unique_ptr<JPH::PhysicsSystem> CreatePhysicsSystem();
+
     /// \brief Steps away all pending time. Needs to be ran in a background thread
     void StepAllPhysicsStepsInBackground();
 
-    void StepPhysics(float time);
+    /// \brief Runs the physics steps for the elapsed time (taking into account the max steps limit)
+    /// \returns The amount of time simulated
+    float StepElapsedTime();
+
+    /// \brief Blocks until runningBackgroundSimulation is false (first spinning, then sleeping)
+    void WaitForBackgroundSimulationEnd();
+
+    void StepPhysics(float time, int collisionSteps);
+
+    /// \brief Requests body capacity growth for the next update if automatic growth is on and the body count is
+    /// getting close to the limit. This is thread safe.
+    void CheckBodyCapacity();
+
+    [[nodiscard]] inline bool IsCapacityGrowthPending() const noexcept
+    {
+        return growBodiesPending.load(std::memory_order_relaxed) || growBodyPairsPending ||
+            growContactConstraintsPending;
+    }
+
+    /// \brief Handles growth requested by body creation or by a physics update that ran out of space
+    void ApplyPendingCapacityGrowth();
 
     Ref<PhysicsBody> CreateBody(const JPH::Shape& shape, JPH::EMotionType motionType, JPH::ObjectLayer layer,
         JPH::RVec3Arg position, JPH::Quat rotation = JPH::Quat::sIdentity(),
         JPH::EAllowedDOFs allowedDegreesOfFreedom = JPH::EAllowedDOFs::All, bool isSensor = false);
 
+    /// \brief Creates our wrapper object for a newly created Jolt body. This is thread safe.
+    static Ref<PhysicsBody> WrapCreatedBody(JPH::Body& body);
+
     /// \brief Called after body has been created
     Ref<PhysicsBody> OnBodyCreated(Ref<PhysicsBody>&& body, bool addToWorld);
 
+    /// \brief Adds the constraints of a body (that is being added to the world) that are not in the world yet
+    void CreatePendingConstraints(PhysicsBody& body);
+
     /// \brief Called when body is added to the world (can happen multiple times for each body)
     void OnPostBodyAdded(PhysicsBody& body);
 
@@ -248,9 +542,23 @@ private:
     /// various features
     void UpdateBodyUserPointer(const PhysicsBody& body);
 
-    /// \brief Applies physics body control operations
+    /// \brief Applies physics body control operations. This can be called for different bodies from multiple
+    /// threads at once.
     /// \param delta Is the physics step delta
-    void ApplyBodyControl(PhysicsBody& bodyWrapper, float delta);
+    /// \returns True if the body needs to be activated. Activation is left to the caller so that it can be done for
+    /// all bodies at once.
+    bool ApplyBodyControl(PhysicsBody& bodyWrapper, float delta);
+
+    /// \brief Lock interface for reading bodies in queries and bulk reads. Only locks when the background simulation
+    /// is running as otherwise nothing can be modifying the bodies at the same time.
+    [[nodiscard]] const JPH::BodyLockInterface& GetQueryLockInterface() const;
+
+    /// \brief Writes the found bodies of a query to dataReceiver along with their distances to center
+    /// \param sortByDistance If true only the closest maxResults bodies are written in order of distance
+    /// \param maxDistance Bodies with their position further away than this from center are skipped
+    int WriteBodyQueryResults(const JPH::BodyID* bodies, size_t bodyCount, JPH::RVec3Arg center,
+        PhysicsRayWithUserData dataReceiver[], int maxResults, bool sortByDistance,
+        float maxDistance = std::numeric_limits<float>::infinity()) const;
 
     void DrawPhysics(float delta);
 
@@ -289,6 +597,12 @@ private:
     float physicsFrameRate = 60;
     int collisionStepsPerUpdate = 1;
 
+    /// Max physics steps to run per update, 0 means unlimited
+    int maxStepsPerUpdate = DEFAULT_MAX_STEPS_PER_UPDATE;
+
+    /// How many pending steps can be merged into one when catching up with the step limit
+    int maxCatchUpStepMultiplier = 1;
+
     int simulationsBetweenBroadPhaseOptimization = 67;
 
     /// When running multiple physics steps with a single call to the simulation update methods this is used to not
@@ -297,15 +611,27 @@ private:
 
     std::atomic<bool> runningBackgroundSimulation{false};
 
-    // Settings that only apply when creating a new physics system
+    // Settings that only apply when creating a new physics system (changing these requires a rebuild)
 
-    const unsigned int maxBodies = 10240;
+    unsigned int maxBodies = DEFAULT_MAX_BODIES;
 
     /// \details Jolt documentation says that 0 means automatic
     const unsigned int maxBodyMutexes = 0;
 
-    const unsigned int maxBodyPairs = 65536;
-    const unsigned int maxContactConstraints = 20480;
+    unsigned int maxBodyPairs = DEFAULT_MAX_BODY_PAIRS;
+    unsigned int maxContactConstraints = DEFAULT_MAX_CONTACT_CONSTRAINTS;
+
+    bool autoCapacityGrowth = false;
+
+    bool deterministicMode = false;
+
+    bool stepStateHashing = false;
+    uint64_t stepStateHashChain = 0;
+
+    /// Set when bodies are running out or a physics update ran out of space, handled before the next update
+    std::atomic<bool> growBodiesPending{false};
+    bool growBodyPairsPending = false;
+    bool growContactConstraintsPending = false;
 
     // This is last to make sure resources held by this are deleted last
     std::unique_ptr<Pimpl> pimpl;
@@ -32,12 +32,17 @@ PhysicsBody::~PhysicsBody() noexcept
 }
 
 // ------------------------------------ //
-void PhysicsBody::SetCollisionRecordingTarget(CollisionRecordListType target, int maxCount) noexcept
+void PhysicsBody::SetCollisionRecordingTarget(
+    CollisionRecordListType target, int maxCount, bool recordEndedCollisions /*= false*/) noexcept
 {
     collisionRecordingTarget = target;
     maxCollisionsToRecord = maxCount;
+    recordEnded = recordEndedCollisions;
     activeRecordedCollisionCount = 0;
 
+    // Resizing always leaves the lookup empty so that no old record indexes remain
+    collisionRecordLookup.Resize(collisionRecordingTarget != nullptr ? maxCollisionsToRecord : 0);
+
     if (collisionRecordingTarget == nullptr && maxCollisionsToRecord > 0)
         LOG_ERROR("Collision recording will record into null pointer");
 
@@ -49,8 +54,11 @@ void PhysicsBody::ClearCollisionRecordingTarget() noexcept
 {
     collisionRecordingTarget = nullptr;
     maxCollisionsToRecord = 0;
+    recordEnded = false;
     activeRecordedCollisionCount = 0;
 
+    collisionRecordLookup.Release();
+
     if (activeUserPointerFlags & PHYSICS_BODY_RECORDING_FLAG)
         LOG_ERROR("Collision recording was cleared while flag is still active");
 }
@@ -58,60 +66,28 @@ void PhysicsBody::ClearCollisionRecordingTarget() noexcept
 // ------------------------------------ //
 bool PhysicsBody::AddCollisionIgnore(const PhysicsBody& ignoredBody, bool skipDuplicates) noexcept
 {
-    const auto idToAdd = ignoredBody.GetId();
-
-    if (skipDuplicates)
-    {
-        const auto end = ignoredCollisions.end();
-        for (auto iter = ignoredCollisions.begin(); iter != end; ++iter)
-        {
-            if (*iter == idToAdd)
-            {
-                return false;
-            }
-        }
-    }
-
-    ignoredCollisions.emplace_back(idToAdd);
-    return true;
+    return ignoredCollisions.Add(ignoredBody.GetId(), skipDuplicates);
 }
 
 bool PhysicsBody::RemoveCollisionIgnore(const PhysicsBody& noLongerIgnored) noexcept
 {
-    const auto idToRemove = noLongerIgnored.GetId();
-
-    const auto end = ignoredCollisions.end();
-    for (auto iter = ignoredCollisions.begin(); iter != end; ++iter)
-    {
-        if (*iter == idToRemove)
-        {
-            ignoredCollisions.erase(iter);
-            return true;
-        }
-    }
-
-    return false;
+    return ignoredCollisions.Remove(noLongerIgnored.GetId());
 }
 
 void PhysicsBody::SetCollisionIgnores(PhysicsBody* const* ignoredBodies, int ignoreCount) noexcept
 {
-    ignoredCollisions.clear();
-
-    for (int i = 0; i < ignoreCount; ++i)
-    {
-        ignoredCollisions.emplace_back(ignoredBodies[i]->GetId());
-    }
+    // Bulk set to only need to sort once for big lists
+    ignoredCollisions.Set(ignoredBodies, ignoreCount);
 }
 
 void PhysicsBody::SetSingleCollisionIgnore(const PhysicsBody& ignoredBody) noexcept
 {
-    ignoredCollisions.clear();
-    ignoredCollisions.emplace_back(ignoredBody.GetId());
+    ignoredCollisions.SetSingle(ignoredBody.GetId());
 }
 
 void PhysicsBody::ClearCollisionIgnores() noexcept
 {
-    ignoredCollisions.clear();
+    ignoredCollisions.Clear();
 }
 
 // ------------------------------------ //
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <cstring>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -14,6 +16,8 @@
 
 #include "core/RefCounted.hpp"
 
+#include "CollisionIgnoreList.hpp"
+#include "CollisionRecordLookup.hpp"
 #include "PhysicsCollision.hpp"
 
 // This needs to be included to allow one collision recording method to be inline
@@ -23,10 +27,6 @@
 #include "core/Mutex.hpp"
 #endif
 
-#ifdef USE_SMALL_VECTOR_POOLS
-#include "boost/pool/pool_alloc.hpp"
-#endif
-
 namespace JPH
 {
 class Shape;
@@ -50,11 +50,10 @@ constexpr uint64_t PHYSICS_BODY_SPECIAL_COLLISION_FLAG =
 static_assert(STUFFED_POINTER_DATA_MASK ==
     (PHYSICS_BODY_COLLISION_FILTER_FLAG | PHYSICS_BODY_RECORDING_FLAG | PHYSICS_BODY_DISABLE_COLLISION_FLAG));
 
-#ifdef USE_SMALL_VECTOR_POOLS
-using IgnoredCollisionList = std::vector<JPH::BodyID, boost::pool_allocator<JPH::BodyID>>;
-#else
-using IgnoredCollisionList = std::vector<JPH::BodyID>;
-#endif
+// Default values for native collision group filtering, bodies with these values don't use group filtering
+constexpr uint32_t PHYSICS_COLLISION_GROUP_NONE = 0;
+constexpr uint32_t PHYSICS_COLLISION_CATEGORY_DEFAULT = 1;
+constexpr uint32_t PHYSICS_COLLISION_MASK_ALL = std::numeric_limits<uint32_t>::max();
 
 /// \brief Our physics body wrapper that has extra data
 class alignas(STUFFED_POINTER_ALIGNMENT) PhysicsBody : public RefCounted<PhysicsBody>
@@ -67,10 +66,16 @@ class alignas(STUFFED_POINTER_ALIGNMENT) PhysicsBody : public RefCounted<Physics
     // Flags used only internally to track some extra state (these are not passed to the user pointer value)
     static constexpr uint64_t EXTRA_FLAG_FILTER_LIST = 32;
     static constexpr uint64_t EXTRA_FLAG_FILTER_CALLBACK = 64;
+    static constexpr uint64_t EXTRA_FLAG_FILTER_GROUP = 128;
 
     // Ensure these extra flags don't leak into the other flag area
     static_assert((EXTRA_FLAG_FILTER_LIST & STUFFED_POINTER_DATA_MASK) == 0);
     static_assert((EXTRA_FLAG_FILTER_CALLBACK & STUFFED_POINTER_DATA_MASK) == 0);
+    static_assert((EXTRA_FLAG_FILTER_GROUP & STUFFED_POINTER_DATA_MASK) == 0);
+
+    /// Any of these being set requires the main collision filter flag to be on
+    static constexpr uint64_t EXTRA_FLAGS_NEEDING_FILTER =
+        EXTRA_FLAG_FILTER_LIST | EXTRA_FLAG_FILTER_CALLBACK | EXTRA_FLAG_FILTER_GROUP;
 
 protected:
 #ifndef USE_OBJECT_POOLS
@@ -112,9 +117,16 @@ public:
 
     // ------------------------------------ //
     // Recording
-    void SetCollisionRecordingTarget(CollisionRecordListType target, int maxCount) noexcept;
+    void SetCollisionRecordingTarget(
+        CollisionRecordListType target, int maxCount, bool recordEndedCollisions = false) noexcept;
     void ClearCollisionRecordingTarget() noexcept;
 
+    /// \returns True if collisions ending should also be written into the recorded collisions
+    [[nodiscard]] inline bool RecordsEndedCollisions() const noexcept
+    {
+        return recordEnded;
+    }
+
 #ifdef LOCK_FREE_COLLISION_RECORDING
     inline const int32_t* GetRecordedCollisionTargetAddress() const noexcept
     {
@@ -143,13 +155,7 @@ public:
 
     inline bool IsBodyIgnored(JPH::BodyID bodyId) const noexcept
     {
-        for (const auto& ignored : ignoredCollisions)
-        {
-            if (ignored == bodyId)
-                return true;
-        }
-
-        return false;
+        return ignoredCollisions.Contains(bodyId);
     }
 
     inline void SetCollisionFilter(CollisionFilterCallback callback) noexcept
@@ -173,6 +179,40 @@ public:
         return callbackBasedFilter;
     }
 
+    // ------------------------------------ //
+    // Collision groups
+
+    /// \brief Sets the native collision group filtering values. Bodies with the same non-zero group don't collide
+    /// (for example cells in the same colony), and two bodies only collide when each one's category has a common bit
+    /// with the other body's mask.
+    /// \returns True if this body now needs group filtering (the values are not the defaults)
+    inline bool SetCollisionGroup(uint32_t group, uint32_t category, uint32_t mask) noexcept
+    {
+        collisionGroup = group;
+        collisionCategory = category;
+        collisionMask = mask;
+
+        return group != PHYSICS_COLLISION_GROUP_NONE || category != PHYSICS_COLLISION_CATEGORY_DEFAULT ||
+            mask != PHYSICS_COLLISION_MASK_ALL;
+    }
+
+    [[nodiscard]] inline uint32_t GetCollisionGroup() const noexcept
+    {
+        return collisionGroup;
+    }
+
+    /// \brief Checks the group filtering values of two bodies. This is symmetric so only needs to be called once per
+    /// body pair.
+    [[nodiscard]] FORCE_INLINE static bool CollisionGroupsAllowCollision(
+        const PhysicsBody& first, const PhysicsBody& second) noexcept
+    {
+        if (first.collisionGroup != PHYSICS_COLLISION_GROUP_NONE && first.collisionGroup == second.collisionGroup)
+            return false;
+
+        return (first.collisionCategory & second.collisionMask) != 0 &&
+            (second.collisionCategory & first.collisionMask) != 0;
+    }
+
     // ------------------------------------ //
     // State flags
 
@@ -228,8 +268,8 @@ public:
         if (old == activeUserPointerFlags)
             return false;
 
-        // Keep the main flag on if the other flag controlling this is still on
-        if (activeUserPointerFlags & EXTRA_FLAG_FILTER_CALLBACK)
+        // Keep the main flag on if another flag controlling this is still on
+        if (activeUserPointerFlags & EXTRA_FLAGS_NEEDING_FILTER)
             return true;
 
         activeUserPointerFlags &= ~PHYSICS_BODY_COLLISION_FILTER_FLAG;
@@ -264,8 +304,8 @@ public:
         if (old == activeUserPointerFlags)
             return false;
 
-        // Keep the main flag on if the other flag controlling this is still on
-        if (activeUserPointerFlags & EXTRA_FLAG_FILTER_LIST)
+        // Keep the main flag on if another flag controlling this is still on
+        if (activeUserPointerFlags & EXTRA_FLAGS_NEEDING_FILTER)
             return true;
 
         activeUserPointerFlags &= ~PHYSICS_BODY_COLLISION_FILTER_FLAG;
@@ -273,6 +313,35 @@ public:
         return true;
     }
 
+    inline bool MarkCollisionGroupFilterEnabled() noexcept
+    {
+        const auto old = activeUserPointerFlags;
+
+        activeUserPointerFlags |= EXTRA_FLAG_FILTER_GROUP;
+
+        if (old == activeUserPointerFlags)
+            return false;
+
+        activeUserPointerFlags |= PHYSICS_BODY_COLLISION_FILTER_FLAG;
+        return true;
+    }
+
+    inline bool MarkCollisionGroupFilterDisabled() noexcept
+    {
+        const auto old = activeUserPointerFlags;
+
+        activeUserPointerFlags &= ~EXTRA_FLAG_FILTER_GROUP;
+
+        if (old == activeUserPointerFlags)
+            return false;
+
+        if (activeUserPointerFlags & EXTRA_FLAGS_NEEDING_FILTER)
+            return true;
+
+        activeUserPointerFlags &= ~PHYSICS_BODY_COLLISION_FILTER_FLAG;
+        return true;
+    }
+
     inline bool MarkCollisionRecordingEnabled() noexcept
     {
         if (collisionRecordingTarget == nullptr || maxCollisionsToRecord < 1)
@@ -392,8 +461,10 @@ protected:
     {
         detached = true;
 
-        // Clear out any currently active collisions if any were recorded
+        // Clear out any currently active collisions if any were recorded. The lookup must be cleared as well as the
+        // world won't call ClearRecordedData for detached bodies
         activeRecordedCollisionCount = 0;
+        collisionRecordLookup.Clear();
     }
 
     inline bool IsInSpecificWorld(const PhysicalWorld* world) const noexcept
@@ -427,50 +498,7 @@ protected:
         // TODO: could maybe trigger this only on the first recording of a collision
         HandleStepIdentifier(stepIdentifier);
 
-        auto compareCount = activeRecordedCollisionCount.load(std::memory_order::acquire);
-
-        if (compareCount > 0)
-        {
-            // Is this enough for the above TODO?
-            std::atomic_thread_fence(std::memory_order::acq_rel);
-
-            // Briefly the write may be out of range, so to guard against that we need this adjustment to what this
-            // method may read
-            if (compareCount > maxCollisionsToRecord) [[unlikely]]
-                compareCount = maxCollisionsToRecord;
-
-            for (int i = 0; i < compareCount; ++i)
-            {
-                auto* candidate = &collisionRecordingTarget[i];
-
-                // Don't need to check first body as it is always us
-
-                // This intends to compare the pointer data
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "bugprone-sizeof-expression"
-
-#ifdef USE_ATOMIC_COLLISION_WRITE
-                const std::atomic_ref<const PhysicsBody*> compareAtomic{candidate->SecondBody};
-                if (compareAtomic.load(std::memory_order::acquire) == otherBody)
-#else
-                // Might be better to use a memory compare here as this might be better regarding the atomics
-                // if (candidate->SecondBody == otherBody)
-                if (std::memcmp(&candidate->SecondBody, &otherBody, sizeof(otherBody)) == 0)
-#endif
-                {
-                    // Found a match
-                    // TODO: is this needed (or does this not help either?)
-                    // std::atomic_thread_fence(std::memory_order::acquire);
-                    usedExisting = true;
-                    return candidate;
-                }
-
-#pragma clang diagnostic pop
-            }
-        }
-
-        usedExisting = false;
-        return GetNextRecordLocation();
+        return FindOrAddRecordLocation(otherBody, usedExisting);
     }
 
 private:
@@ -538,39 +566,7 @@ private:
         // TODO: could maybe trigger this only on the first recording of a collision
         HandleStepIdentifier(stepIdentifier);
 
-        const auto compareCount = activeRecordedCollisionCount;
-
-        for (int i = 0; i < compareCount; ++i)
-        {
-            auto* candidate = &collisionRecordingTarget[i];
-
-            // Don't need to check first body as it is always us
-
-            // Atomics can be used here as well becase even though there is a lock above, the lock is not held while
-            // writing
-            // This intends to compare the pointer data
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "bugprone-sizeof-expression"
-
-#ifdef USE_ATOMIC_COLLISION_WRITE
-            const std::atomic_ref<const PhysicsBody*> compareAtomic{candidate->SecondBody};
-            if (compareAtomic.load(std::memory_order::acquire) == otherBody)
-#else
-            // Might be better to use a memory compare here as this might be better regarding the atomics
-            // if (candidate->SecondBody == otherBody)
-            if (std::memcmp(&candidate->SecondBody, &otherBody, sizeof(otherBody)) == 0)
-#endif
-            {
-                // Found a match
-                // TODO: is this needed (or does this not help either?)
-                // std::atomic_thread_fence(std::memory_order::acquire);
-                usedExisting = true;
-                return candidate;
-            }
-        }
-
-        usedExisting = false;
-        return GetNextRecordLocation();
+        return FindOrAddRecordLocation(otherBody, usedExisting);
     }
 
 private:
@@ -596,6 +592,34 @@ private:
     }
 #endif
 
+    /// \brief Finds the existing record for a collision with the other body or reserves a new one
+    ///
+    /// Uses the lookup table to avoid scanning all recorded collisions. In lock-free mode this relies on Jolt
+    /// processing each body pair on a single thread, so the record found here is not concurrently written.
+    inline PhysicsCollision* FindOrAddRecordLocation(const PhysicsBody* otherBody, bool& usedExisting) noexcept
+    {
+        int32_t claimedSlot;
+        const auto existingIndex = collisionRecordLookup.FindOrClaim(otherBody, claimedSlot);
+
+        if (existingIndex >= 0)
+        {
+            usedExisting = true;
+            return &collisionRecordingTarget[existingIndex];
+        }
+
+        usedExisting = false;
+        auto* target = GetNextRecordLocation();
+
+        if (claimedSlot >= 0)
+        {
+            collisionRecordLookup.SetRecordIndex(claimedSlot,
+                target != nullptr ? static_cast<int32_t>(target - collisionRecordingTarget) :
+                                    CollisionRecordLookup::NO_RECORD);
+        }
+
+        return target;
+    }
+
 protected:
     /// \brief Clears recorded collision data
     ///
@@ -603,6 +627,7 @@ protected:
     FORCE_INLINE void ClearRecordedData()
     {
         activeRecordedCollisionCount = 0;
+        collisionRecordLookup.Clear();
 
         // TODO: could maybe switch the last step number to a simple bool flag to determine if we have registered our
         // selves already or not to be cleared of collisions on next update
@@ -611,11 +636,14 @@ protected:
 private:
     std::array<char, PHYSICS_USER_DATA_SIZE> userData;
 
-    IgnoredCollisionList ignoredCollisions;
+    CollisionIgnoreList ignoredCollisions;
 
     /// This is memory not owned by us where recorded collisions are written to
     CollisionRecordListType collisionRecordingTarget = nullptr;
 
+    /// Allows finding existing records for a body quickly when collisions are persisted
+    CollisionRecordLookup collisionRecordLookup;
+
     std::vector<Ref<TrackedConstraint>> constraintsThisIsPartOf;
 
 #ifndef LOCK_FREE_COLLISION_RECORDING
@@ -637,6 +665,12 @@ private:
 
     int maxCollisionsToRecord = 0;
 
+    bool recordEnded = false;
+
+    uint32_t collisionGroup = PHYSICS_COLLISION_GROUP_NONE;
+    uint32_t collisionCategory = PHYSICS_COLLISION_CATEGORY_DEFAULT;
+    uint32_t collisionMask = PHYSICS_COLLISION_MASK_ALL;
+
 #ifdef LOCK_FREE_COLLISION_RECORDING
     /// A pointer to this is passed out for users of the collision recording array
     std::atomic<int32_t> activeRecordedCollisionCount{0};
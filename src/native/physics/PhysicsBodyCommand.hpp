@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Jolt/Jolt.h"
+#include "Jolt/Math/Quat.h"
+
+namespace Thrive::Physics
+{
+
+class PhysicsBody;
+
+/// \brief Type of PhysicsBodyCommand, this tells which of the fields of the command are used. Values match the C side
+/// PHYSICS_BODY_COMMAND_TYPE.
+enum class BodyCommandType : int32_t
+{
+    /// Uses Vector
+    GiveImpulse = 0,
+    /// Uses AngularVector
+    GiveAngularImpulse = 1,
+    /// Uses Vector
+    SetVelocity = 2,
+    /// Uses AngularVector
+    SetAngularVelocity = 3,
+    /// Uses Vector and AngularVector
+    SetVelocityAndAngularVelocity = 4,
+    /// Uses Position and Activate
+    SetPosition = 5,
+    /// Uses Position, Rotation and Activate
+    SetPositionAndRotation = 6,
+    /// Uses Damping
+    SetDamping = 7,
+    /// Uses Damping and AngularDamping
+    SetDampingAndAngularDamping = 8,
+};
+
+/// \brief A single body modification for PhysicalWorld::ApplyBodyCommands. The C interface converts the C side
+/// PhysicsBodyCommand structs to these.
+struct PhysicsBodyCommand
+{
+public:
+    PhysicsBody* Body;
+    JPH::RVec3 Position;
+    JPH::Quat Rotation;
+    JPH::Vec3 Vector;
+    JPH::Vec3 AngularVector;
+    float Damping;
+    float AngularDamping;
+    BodyCommandType Type;
+
+    /// Activates the body on position change
+    bool Activate;
+};
+
+} // namespace Thrive::Physics
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Jolt/Jolt.h"
+#include "Jolt/Math/Quat.h"
+
+namespace JPH
+{
+class Shape;
+} // namespace JPH
+
+namespace Thrive::Physics
+{
+
+/// \brief Parameters for creating one body with PhysicalWorld::CreateBodiesBulk. The C interface converts the C side
+/// PhysicsBodyCreationInfo structs to these.
+///
+/// Only the basic body properties are supported. Sensors, axis locked bodies and bodies with limited degrees of
+/// freedom need to be created one by one with the specific PhysicalWorld create methods. Axis locked bodies can still
+/// be created without adding them to the world and then be added as a batch with PhysicalWorld::AddBodiesBulk.
+struct PhysicsBodyCreationInfo
+{
+public:
+    /// Bodies without a shape fail to be created
+    const JPH::Shape* Shape;
+
+    JPH::RVec3 Position;
+    JPH::Quat Rotation;
+
+    /// Creates a static body instead of a moving one
+    bool Static;
+
+    /// Activates the body when it is added to the world
+    bool Activate;
+};
+
+} // namespace Thrive::Physics
@@ -39,16 +39,27 @@ public:
     /// How big the object overlap is (this is directly correlated to how hard the collision is)
     float PenetrationAmount;
 
+    /// How fast the bodies were moving towards each other along the contact normal (positive when approaching). This
+    /// is the impact speed when JustStarted is true. Not calculated in the collision filter.
+    float RelativeNormalVelocity;
+
+    /// World space contact normal pointing from the first body towards the second body. Zero in the collision filter.
+    std::array<float, 3> ContactNormal;
+
     /// True in collision filter and on the first physics update this collision appeared
     bool JustStarted;
 
-    // Without packed attribute there are 3 bytes of extra padding here
+    /// True when this record is about a contact that ended. Only written for bodies that record ended collisions.
+    /// Penetration, velocity and normal are zero in these.
+    bool Ended;
+
+    // Without packed attribute there are 2 bytes of extra padding here
 };
 
 static_assert(sizeof(PhysicsCollision) == PHYSICS_COLLISION_DATA_SIZE);
 
 // The C# side definition
-static_assert(sizeof(PhysicsCollision) == 56);
+static_assert(sizeof(PhysicsCollision) == 72);
 
 using CollisionRecordListType = PhysicsCollision*;
 
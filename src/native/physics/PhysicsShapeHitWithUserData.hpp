@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "Include.h"
+
+namespace Thrive::Physics
+{
+class PhysicsBody;
+
+/// \brief Result of a shape cast or collide shape query. Contains user data from the hit body. Must match the memory
+/// layout of the C# side PhysicsShapeHitWithUserData struct.
+///
+/// If the size in bytes is changed, PhysicsShapeHitWithUserData in CStructures.h must also be updated (size defined
+/// in Include.h.in)
+struct PhysicsShapeHitWithUserData
+{
+public:
+    std::array<char, PHYSICS_USER_DATA_SIZE> BodyUserData;
+
+    /// The hit sub shape of the hit body
+    uint32_t SubShapeData;
+
+    /// For shape casts how far along the cast this hit was as a fraction of the total cast length. For collide shape
+    /// queries this is always 0.
+    float HitFraction;
+
+    /// How deep the query shape is inside the hit body
+    float PenetrationDepth;
+
+    /// Normalized world space direction the query shape would need to move to get out of the hit body
+    std::array<float, 3> PenetrationAxis;
+
+    // There are 4 bytes of extra padding here
+
+    /// Pointer to the hit body's extra data object
+    const PhysicsBody* Body;
+};
+
+static_assert(sizeof(PhysicsShapeHitWithUserData) == PHYSICS_SHAPE_HIT_DATA_SIZE);
+
+// This is the C# side definition
+static_assert(sizeof(PhysicsShapeHitWithUserData) == 48);
+
+} // namespace Thrive::Physics
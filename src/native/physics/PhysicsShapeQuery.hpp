@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Jolt/Jolt.h"
+#include "Jolt/Math/Quat.h"
+
+namespace JPH
+{
+class Shape;
+} // namespace JPH
+
+namespace Thrive::Physics
+{
+
+/// \brief One query for the batch shape query methods of PhysicalWorld. The C interface converts the C side
+/// PhysicsShapeQuery structs to these.
+struct PhysicsShapeQuery
+{
+public:
+    /// Queries without a shape are skipped and report no hits
+    const JPH::Shape* Shape;
+
+    JPH::RVec3 Position;
+    JPH::Quat Rotation;
+
+    /// Direction and length of the cast for shape casts, not used by collide shape queries
+    JPH::Vec3 Direction;
+};
+
+} // namespace Thrive::Physics
@@ -56,6 +56,11 @@ TrackedConstraint::~TrackedConstraint()
         LOG_ERROR("Constraint on destruction still exists in a world, this will likely crash the physics system");
 }
 
+void TrackedConstraint::ReplaceConstraint(const JPH::Ref<JPH::Constraint>& newConstraint) noexcept
+{
+    constraintInstance = newConstraint;
+}
+
 void TrackedConstraint::DetachFromBodies()
 {
     firstBody->NotifyConstraintRemoved(*this);
@@ -59,6 +59,9 @@ protected:
         createdInWorld = &world;
     }
 
+    /// \brief Used when the physics system is rebuilt and the constraint needs to be recreated for the new bodies
+    void ReplaceConstraint(const JPH::Ref<JPH::Constraint>& newConstraint) noexcept;
+
     inline void OnRemoveFromWorld(PhysicalWorld& world)
     {
         if (createdInWorld != &world)
@@ -99,7 +102,7 @@ private:
 private:
     const Ref<PhysicsBody> firstBody;
     const Ref<PhysicsBody> optionalSecondBody;
-    const JPH::Ref<JPH::Constraint> constraintInstance;
+    JPH::Ref<JPH::Constraint> constraintInstance;
 
     PhysicalWorld* createdInWorld = nullptr;
 
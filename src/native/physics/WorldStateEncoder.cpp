@@ -0,0 +1,194 @@
+// ------------------------------------ //
+#include "WorldStateEncoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Jolt/Core/HashCombine.h"
+
+// ------------------------------------ //
+namespace Thrive::Physics
+{
+
+template<typename T>
+static void WriteValue(std::vector<uint8_t>& output, T value)
+{
+    const auto start = output.size();
+    output.resize(start + sizeof(T));
+    std::memcpy(output.data() + start, &value, sizeof(T));
+}
+
+template<typename T>
+static bool ReadValue(const uint8_t* data, size_t length, size_t& position, T& receiver)
+{
+    if (length - position < sizeof(T))
+        return false;
+
+    std::memcpy(&receiver, data + position, sizeof(T));
+    position += sizeof(T);
+    return true;
+}
+
+static void WriteVarInt(std::vector<uint8_t>& output, size_t value)
+{
+    while (value >= 0x80)
+    {
+        output.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+
+    output.push_back(static_cast<uint8_t>(value));
+}
+
+static bool ReadVarInt(const uint8_t* data, size_t length, size_t& position, size_t& receiver)
+{
+    receiver = 0;
+
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (position >= length)
+            return false;
+
+        const auto byte = data[position++];
+        receiver |= static_cast<size_t>(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+static uint64_t HashState(const std::string& state)
+{
+    return JPH::HashBytes(state.data(), static_cast<uint32_t>(state.size()));
+}
+
+// ------------------------------------ //
+void WorldStateEncoder::Encode(const std::string& rawState, bool delta, std::vector<uint8_t>& output) const
+{
+    delta = delta && hasBase;
+
+    output.clear();
+    output.reserve(HEADER_SIZE + (delta ? rawState.size() / 4 : rawState.size()));
+
+    WriteValue(output, FORMAT_MAGIC);
+    WriteValue(output, FORMAT_VERSION);
+    WriteValue(output, static_cast<uint8_t>(delta ? FLAG_DELTA : 0));
+    WriteValue(output, static_cast<uint32_t>(rawState.size()));
+    WriteValue(output, delta ? baseHash : uint64_t{0});
+
+    if (!delta)
+    {
+        output.insert(output.end(), rawState.begin(), rawState.end());
+        return;
+    }
+
+    const auto size = rawState.size();
+    const auto commonSize = std::min(size, base.size());
+
+    const auto isUnchangedRun = [&](size_t start)
+    {
+        const auto end = std::min(start + MIN_UNCHANGED_RUN, size);
+
+        if (end > commonSize)
+            return false;
+
+        return std::memcmp(rawState.data() + start, base.data() + start, end - start) == 0;
+    };
+
+    // Stored as pairs of an unchanged byte count followed by a changed byte count and the changed bytes
+    size_t position = 0;
+
+    while (position < size)
+    {
+        const auto unchangedStart = position;
+
+        while (position < commonSize && rawState[position] == base[position])
+            ++position;
+
+        const auto changedStart = position;
+
+        while (position < size && !isUnchangedRun(position))
+            ++position;
+
+        WriteVarInt(output, changedStart - unchangedStart);
+        WriteVarInt(output, position - changedStart);
+
+        output.insert(output.end(), rawState.begin() + static_cast<std::ptrdiff_t>(changedStart),
+            rawState.begin() + static_cast<std::ptrdiff_t>(position));
+    }
+}
+
+bool WorldStateEncoder::Decode(const uint8_t* data, size_t length, std::string& rawStateReceiver) const
+{
+    if (data == nullptr)
+        return false;
+
+    size_t position = 0;
+
+    uint32_t magic;
+    uint8_t version;
+    uint8_t flags;
+    uint32_t size;
+    uint64_t stateBaseHash;
+
+    if (!ReadValue(data, length, position, magic) || !ReadValue(data, length, position, version) ||
+        !ReadValue(data, length, position, flags) || !ReadValue(data, length, position, size) ||
+        !ReadValue(data, length, position, stateBaseHash))
+    {
+        return false;
+    }
+
+    if (magic != FORMAT_MAGIC || version != FORMAT_VERSION)
+        return false;
+
+    if ((flags & FLAG_DELTA) == 0)
+    {
+        if (length - position != size)
+            return false;
+
+        rawStateReceiver.assign(reinterpret_cast<const char*>(data + position), size);
+        return true;
+    }
+
+    if (!hasBase || stateBaseHash != baseHash)
+        return false;
+
+    rawStateReceiver.resize(size);
+
+    size_t written = 0;
+
+    while (written < size)
+    {
+        size_t unchanged;
+        size_t changed;
+
+        if (!ReadVarInt(data, length, position, unchanged) || !ReadVarInt(data, length, position, changed))
+            return false;
+
+        if (unchanged > size - written || written + unchanged > base.size())
+            return false;
+
+        std::memcpy(rawStateReceiver.data() + written, base.data() + written, unchanged);
+        written += unchanged;
+
+        if (changed > size - written || changed > length - position)
+            return false;
+
+        std::memcpy(rawStateReceiver.data() + written, data + position, changed);
+        written += changed;
+        position += changed;
+    }
+
+    return position == length;
+}
+
+void WorldStateEncoder::SetBase(std::string rawState)
+{
+    base = std::move(rawState);
+    baseHash = HashState(base);
+    hasBase = true;
+}
+
+} // namespace Thrive::Physics
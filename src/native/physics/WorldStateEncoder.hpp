@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/NonCopyable.hpp"
+
+namespace Thrive::Physics
+{
+
+/// \brief Encodes raw Jolt physics system states (from a StateRecorder) into a compact binary format for saving
+///
+/// States can be stored in full or as a delta against the latest saved (or restored) state, which only contains the
+/// changed byte ranges. As bodies are saved in a fixed order, a delta between two close together states is small.
+class WorldStateEncoder : public NonCopyable
+{
+public:
+    static constexpr uint32_t FORMAT_MAGIC = 0x53575054; // TPWS
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr uint8_t FLAG_DELTA = 1;
+
+    static constexpr size_t HEADER_SIZE = sizeof(uint32_t) + 2 * sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint64_t);
+
+    /// Changed ranges are only split by unchanged runs at least this long as each range has a small overhead
+    static constexpr size_t MIN_UNCHANGED_RUN = 4;
+
+public:
+    /// \brief Encodes rawState into output (replacing existing data). Delta encoding is used only when requested and
+    /// a base state exists.
+    void Encode(const std::string& rawState, bool delta, std::vector<uint8_t>& output) const;
+
+    /// \brief Decodes a previously encoded state. Delta states can only be decoded against the same base state they
+    /// were encoded with.
+    /// \returns False if the data is invalid or is a delta against some other base state
+    [[nodiscard]] bool Decode(const uint8_t* data, size_t length, std::string& rawStateReceiver) const;
+
+    /// \brief Sets the state future deltas are calculated against
+    void SetBase(std::string rawState);
+
+    [[nodiscard]] bool HasBase() const noexcept
+    {
+        return hasBase;
+    }
+
+private:
+    std::string base;
+    uint64_t baseHash = 0;
+    bool hasBase = false;
+};
+
+} // namespace Thrive::Physics
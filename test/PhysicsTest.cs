@@ -74,6 +74,11 @@ public partial class PhysicsTest : Node
 
     private const float YDriftThreshold = 0.05f;
 
+    /// <summary>
+    ///   Time passed to the separate worlds used by <see cref="TestType.WorldChecks"/> on each update
+    /// </summary>
+    private const float WorldCheckDelta = 1 / 30.0f;
+
     private readonly List<NativePhysicsBody> allCreatedBodies = new();
     private readonly List<NativePhysicsBody> sphereBodies = new();
 
@@ -123,6 +128,11 @@ public partial class PhysicsTest : Node
         SpheresGodotPhysics,
         MicrobePlaceholders,
         MicrobePlaceholdersGodotPhysics,
+
+        /// <summary>
+        ///   Runs checks on separate physics worlds and prints the results instead of showing anything
+        /// </summary>
+        WorldChecks,
     }
 
     public override void _Ready()
@@ -494,6 +504,12 @@ public partial class PhysicsTest : Node
     {
         physicalWorld.SetGravity();
 
+        if (Type == TestType.WorldChecks)
+        {
+            RunWorldChecks();
+            return;
+        }
+
         if (Type is TestType.MicrobePlaceholders or TestType.MicrobePlaceholdersGodotPhysics)
         {
             SetupMicrobeTest();
@@ -670,6 +686,410 @@ public partial class PhysicsTest : Node
         followedTestVisualIndex = (int)Math.Floor(testMicrobesToProcess.Count * 0.5f);
     }
 
+    private void RunWorldChecks()
+    {
+        int failed = 0;
+
+        if (!CheckCapacityResize())
+            ++failed;
+
+        if (!CheckDeterminism())
+            ++failed;
+
+        if (!CheckBodySnapshots())
+            ++failed;
+
+        if (!CheckCollisionEventStream())
+            ++failed;
+
+        if (!CheckCollisionGroups())
+            ++failed;
+
+        UpdateBodyCountGUI(0);
+
+        if (failed > 0)
+        {
+            GD.PrintErr("Physics world checks failed: ", failed);
+        }
+        else
+        {
+            GD.Print("All physics world checks passed");
+        }
+    }
+
+    /// <summary>
+    ///   Checks that resizing a world that has bodies with constraints keeps them working and that automatic growth
+    ///   allows creating more bodies than the initial capacity
+    /// </summary>
+    private bool CheckCapacityResize()
+    {
+        using var world = PhysicalWorld.Create(64, 256, 128);
+        world.RemoveGravity();
+
+        using var shape = PhysicsShape.CreateSphere(0.5f);
+
+        var bodies = new List<NativePhysicsBody>();
+
+        try
+        {
+            for (int i = 0; i < 40; ++i)
+            {
+                var body = world.CreateMovingBody(shape, new Vector3(i * 2, 0, 0), Quaternion.Identity);
+                world.AddAxisLockConstraint(body, Vector3.Up, false);
+                bodies.Add(body);
+            }
+
+            for (int i = 0; i < 10; ++i)
+                world.ProcessPhysics(WorldCheckDelta);
+
+            var positionsBefore = bodies.Select(b => world.ReadBodyPosition(b).Position).ToList();
+
+            if (!world.ResizeCapacity(256, 1024, 512))
+            {
+                GD.PrintErr("Resizing a world with bodies failed");
+                return false;
+            }
+
+            for (int i = 0; i < bodies.Count; ++i)
+            {
+                if (world.ReadBodyPosition(bodies[i]).Position.DistanceTo(positionsBefore[i]) > 0.001f)
+                {
+                    GD.PrintErr("Body position changed by resizing the world");
+                    return false;
+                }
+
+                // The axis lock should still prevent moving along the Y axis
+                world.GiveImpulse(bodies[i], new Vector3(1, 5, 0));
+            }
+
+            for (int i = 0; i < 30; ++i)
+                world.ProcessPhysics(WorldCheckDelta);
+
+            for (int i = 0; i < bodies.Count; ++i)
+            {
+                var position = world.ReadBodyPosition(bodies[i]).Position;
+
+                if (Math.Abs(position.Y) > 0.01f)
+                {
+                    GD.PrintErr("Axis lock constraint stopped working after resizing the world");
+                    return false;
+                }
+
+                if (position.X - positionsBefore[i].X < 0.01f)
+                {
+                    GD.PrintErr("Body didn't move after resizing the world");
+                    return false;
+                }
+            }
+
+            // Growing happens on the next update, so the bodies are created in batches like a game would
+            world.SetAutoCapacityGrowth(true);
+
+            for (int batch = 0; batch < 10; ++batch)
+            {
+                for (int i = 0; i < 40; ++i)
+                {
+                    var body = world.CreateMovingBody(shape, new Vector3(i * 2, 0, 10 + batch * 2),
+                        Quaternion.Identity);
+
+                    if (body.AccessBodyInternal() == IntPtr.Zero)
+                    {
+                        GD.PrintErr("Automatic capacity growth didn't keep up with body creation");
+                        return false;
+                    }
+
+                    world.AddAxisLockConstraint(body, Vector3.Up, false);
+                    bodies.Add(body);
+                }
+
+                world.ProcessPhysics(WorldCheckDelta);
+            }
+
+            GD.Print("Capacity resize check passed with bodies: ", bodies.Count);
+            return true;
+        }
+        finally
+        {
+            foreach (var body in bodies)
+                world.DestroyBody(body);
+        }
+    }
+
+    /// <summary>
+    ///   Runs the same colliding bodies twice in deterministic mode and checks that the state after each step matches
+    /// </summary>
+    private bool CheckDeterminism()
+    {
+        var (firstChain, firstHash) = RunDeterminismScenario();
+        var (secondChain, secondHash) = RunDeterminismScenario();
+
+        if (firstChain == 0)
+        {
+            GD.PrintErr("Step state hashing didn't hash any steps");
+            return false;
+        }
+
+        if (firstChain != secondChain || firstHash != secondHash)
+        {
+            GD.PrintErr("Deterministic physics runs ended up in different states");
+            return false;
+        }
+
+        GD.Print("Determinism check passed");
+        return true;
+    }
+
+    private (ulong StepHashChain, ulong StateHash) RunDeterminismScenario()
+    {
+        using var world = PhysicalWorld.Create();
+        world.RemoveGravity();
+        world.SetDeterministicMode(true);
+        world.SetStepStateHashing(true);
+
+        using var shape = PhysicsShape.CreateSphere(0.5f);
+
+        const int count = 100;
+
+        // Bulk creation is the one that is spread over multiple threads
+        var infos = new PhysicsBodyCreationInfo[count];
+        var bodies = new NativePhysicsBody?[count];
+
+        for (int i = 0; i < count; ++i)
+        {
+            infos[i] = new PhysicsBodyCreationInfo(shape, new Vector3(i % 10 * 1.5f, i / 10 * 1.5f, 0),
+                Quaternion.Identity);
+        }
+
+        world.CreateBodiesBulk(infos, count, bodies);
+
+        try
+        {
+            for (int step = 0; step < 60; ++step)
+            {
+                // Push the bodies towards the center so that they collide with each other
+                if (step % 10 == 0)
+                {
+                    for (int i = 0; i < count; ++i)
+                    {
+                        var position = world.ReadBodyPosition(bodies[i]!).Position;
+                        world.GiveImpulse(bodies[i]!, (new Vector3(7, 7, 0) - position) * 0.5f);
+                    }
+                }
+
+                world.ProcessPhysics(WorldCheckDelta);
+            }
+
+            return (world.StepStateHashChain, world.ComputeStateHash());
+        }
+        finally
+        {
+            foreach (var body in bodies)
+            {
+                if (body != null)
+                    world.DestroyBody(body);
+            }
+        }
+    }
+
+    /// <summary>
+    ///   Checks that body snapshots can be read while the physics runs in the background and that they match the body
+    ///   state once the update is complete
+    /// </summary>
+    private bool CheckBodySnapshots()
+    {
+        using var world = PhysicalWorld.Create();
+        world.RemoveGravity();
+        world.SetBodySnapshotsEnabled(true);
+
+        using var shape = PhysicsShape.CreateSphere(0.5f);
+
+        var body = world.CreateMovingBody(shape, Vector3.Zero, Quaternion.Identity);
+
+        try
+        {
+            var velocity = new Vector3(5, 0, 0);
+            world.SetBodyVelocity(body, velocity, Vector3.Zero);
+
+            world.ProcessPhysics(WorldCheckDelta);
+
+            var completedPosition = world.ReadBodyPosition(body).Position;
+
+            world.ProcessPhysicsOnBackgroundThread(WorldCheckDelta);
+
+            // The background update may finish at any point so this can only check that the snapshot is not older
+            // than the last completed update
+            if (!world.TryReadBodySnapshot(body, out var position, out _, out var snapshotVelocity, out _))
+            {
+                world.WaitUntilPhysicsRunEnds();
+                GD.PrintErr("Body snapshot couldn't be read while physics was running");
+                return false;
+            }
+
+            world.WaitUntilPhysicsRunEnds();
+
+            if (position.X < completedPosition.X - 0.001f || snapshotVelocity.DistanceTo(velocity) > 0.01f)
+            {
+                GD.PrintErr("Body snapshot read during physics has wrong data");
+                return false;
+            }
+
+            world.TryReadBodySnapshot(body, out position, out _, out _, out _);
+
+            if (position.DistanceTo(world.ReadBodyPosition(body).Position) > 0.001f)
+            {
+                GD.PrintErr("Body snapshot doesn't match the body state after the physics update");
+                return false;
+            }
+
+            GD.Print("Body snapshot check passed");
+            return true;
+        }
+        finally
+        {
+            world.DestroyBody(body);
+        }
+    }
+
+    /// <summary>
+    ///   Checks that the world collision event stream reports a collision starting and then ending
+    /// </summary>
+    private bool CheckCollisionEventStream()
+    {
+        using var world = PhysicalWorld.Create();
+        world.RemoveGravity();
+        world.SetCollisionEventStreamCapacity(64);
+
+        using var shape = PhysicsShape.CreateSphere(0.5f);
+
+        var first = world.CreateMovingBody(shape, Vector3.Zero, Quaternion.Identity);
+        var second = world.CreateMovingBody(shape, new Vector3(0.8f, 0, 0), Quaternion.Identity);
+
+        try
+        {
+            world.ProcessPhysics(WorldCheckDelta);
+
+            if (!world.GetCollisionEvents(out var events))
+            {
+                GD.PrintErr("Collision event stream is not enabled");
+                return false;
+            }
+
+            if (events.DroppedCount != 0 || FindCollisionEvent(events, first, second) is not { } started ||
+                !events.IsJustStarted(started) || events.GetPenetration(started) <= 0)
+            {
+                GD.PrintErr("Collision event stream didn't report overlapping bodies starting to collide");
+                return false;
+            }
+
+            // Moving the bodies far apart should end the collision
+            world.SetBodyPosition(second, new Vector3(10, 0, 0));
+            world.ProcessPhysics(WorldCheckDelta);
+
+            world.GetCollisionEvents(out events);
+
+            if (FindCollisionEvent(events, first, second) is not { } ended || !events.IsEnded(ended))
+            {
+                GD.PrintErr("Collision event stream didn't report a collision ending");
+                return false;
+            }
+
+            GD.Print("Collision event stream check passed");
+            return true;
+        }
+        finally
+        {
+            world.DestroyBody(first);
+            world.DestroyBody(second);
+        }
+    }
+
+    /// <summary>
+    ///   Checks that native collision groups and category masks prevent collisions without affecting other bodies
+    /// </summary>
+    private bool CheckCollisionGroups()
+    {
+        using var world = PhysicalWorld.Create();
+        world.RemoveGravity();
+        world.SetCollisionEventStreamCapacity(64);
+
+        using var shape = PhysicsShape.CreateSphere(0.5f);
+
+        var bodies = new List<NativePhysicsBody>();
+
+        // Each pair of bodies overlaps, the pairs are far enough apart to not touch each other
+        for (int i = 0; i < 3; ++i)
+        {
+            bodies.Add(world.CreateMovingBody(shape, new Vector3(0, 0, i * 10), Quaternion.Identity));
+            bodies.Add(world.CreateMovingBody(shape, new Vector3(0.8f, 0, i * 10), Quaternion.Identity));
+        }
+
+        try
+        {
+            // Same group, like members of a colony
+            world.BodySetCollisionGroup(bodies[0], 5);
+            world.BodySetCollisionGroup(bodies[1], 5);
+
+            // The second body doesn't accept the category of the first one
+            world.BodySetCollisionGroup(bodies[2], 0, 2);
+            world.BodySetCollisionGroup(bodies[3], 0, 1, ~2u);
+
+            // Different groups with default categories should still collide
+            world.BodySetCollisionGroup(bodies[4], 1);
+            world.BodySetCollisionGroup(bodies[5], 2);
+
+            world.ProcessPhysics(WorldCheckDelta);
+
+            world.GetCollisionEvents(out var events);
+
+            if (FindCollisionEvent(events, bodies[0], bodies[1]) != null)
+            {
+                GD.PrintErr("Bodies in the same collision group collided");
+                return false;
+            }
+
+            if (FindCollisionEvent(events, bodies[2], bodies[3]) != null)
+            {
+                GD.PrintErr("Bodies collided even though one's category is not in the other's mask");
+                return false;
+            }
+
+            if (FindCollisionEvent(events, bodies[4], bodies[5]) == null)
+            {
+                GD.PrintErr("Bodies in different collision groups didn't collide");
+                return false;
+            }
+
+            GD.Print("Collision group check passed");
+            return true;
+        }
+        finally
+        {
+            foreach (var body in bodies)
+                world.DestroyBody(body);
+        }
+    }
+
+    private static int? FindCollisionEvent(in CollisionEventStreamData events, NativePhysicsBody first,
+        NativePhysicsBody second)
+    {
+        var firstId = first.BodyId;
+        var secondId = second.BodyId;
+
+        for (int i = 0; i < events.Count; ++i)
+        {
+            var eventFirst = events.GetFirstBody(i);
+            var eventSecond = events.GetSecondBody(i);
+
+            if ((eventFirst == firstId && eventSecond == secondId) ||
+                (eventFirst == secondId && eventSecond == firstId))
+            {
+                return i;
+            }
+        }
+
+        return null;
+    }
+
     private void SpawnMicrobe(Vector3 location, Random random)
     {
         if (Type == TestType.MicrobePlaceholdersGodotPhysics)